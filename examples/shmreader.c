@@ -0,0 +1,53 @@
+/*
+ * Prints, every second, the block on air as published by 'dcfcode -P'.
+ *
+ *   % dcfcode -P /dcf77 &
+ *   % examples/shmreader /dcf77 [<seconds>]
+ */
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sysexits.h>
+#include <time.h>
+#include "DCF77Block.h"
+#include "DCF77Shm.h"
+
+int
+main(int argc, char * argv[])
+{
+	char text[DCF77BLOCK_TEXT_LEN + 1];
+	struct timespec tick = { 0, 0 };
+	DCF77Block_t block;
+	DCF77Shm_t shm;
+	long seconds = -1;
+
+	if (argc < 2) {
+		errx(EX_USAGE, "usage: shmreader /<shm_name> [<seconds>]");
+		/* NOTREACHED */
+	}
+	if (argc > 2) {
+		seconds = strtol(argv[2], NULL, 10);
+	}
+
+	DCF77Shm_Attach(&shm, argv[1]);
+
+	tick.tv_sec = time(NULL);
+	while (0 != seconds--) {
+		tick.tv_sec += 1;
+		(void)clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &tick,
+		    NULL);
+
+		/* the block on air encodes the minute to come */
+		if (DCF77Shm_BlockAt(&shm, tick.tv_sec + 60, &block)) {
+			DCF77Block_ToText(&block, text, sizeof(text));
+			printf("%ld %s\n", (long)tick.tv_sec, text);
+		} else {
+			printf("%ld -\n", (long)tick.tv_sec);
+		}
+		fflush(stdout);
+	}
+
+	DCF77Shm_Close(&shm);
+
+	return 0;
+}
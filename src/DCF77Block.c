@@ -3,41 +3,61 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sysexits.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "DCF77Block.h"
 
-#define LOCBUF_SZ 4
+static int decodeHexText(const char * textSrc, uint8_t binDst[]);
 
 void
 DCF77Block_FromText(const char * textSrc,
 	DCF77Block_t * pBinDst)
 {
-	char locBuf[LOCBUF_SZ];
-	int i;
-
-	if (NULL == textSrc || NULL == pBinDst)
-		return;
-
-	if (strlen(textSrc) < DCF77BLOCK_TEXT_LEN) {
+	switch (DCF77Block_ParseText(textSrc, pBinDst)) {
+	case DCF77BLOCK_TEXT_OK:
+		break;
+	case DCF77BLOCK_TEXT_TOO_SHORT:
 		errx(EX_DATAERR, "invalid text length");
 		/* NOTREACHED */
+		break;
+	case DCF77BLOCK_TEXT_BAD_DIGIT:
+		errx(EX_DATAERR, "invalid hex digit in '%.*s'",
+		    DCF77BLOCK_TEXT_LEN, textSrc);
+		/* NOTREACHED */
+		break;
 	}
+}
 
-	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
-		int j = 2 * i;
+/*
+ * Same as DCF77Block_FromText() while it reports malformed text back
+ * instead of terminating.  Characters past the 16th one are ignored.
+ */
+int
+DCF77Block_ParseText(const char * textSrc,
+	DCF77Block_t * pBinDst)
+{
+	uint8_t data[DCF77BLOCK_SIZE];
 
-		locBuf[0] = textSrc[j];
-		locBuf[1] = textSrc[j + 1];
-		locBuf[2] = '\0';
+	if (NULL == textSrc || NULL == pBinDst)
+		return DCF77BLOCK_TEXT_OK;
 
-		pBinDst->data[i] = (uint8_t)strtol(locBuf, NULL, 16);
-	}
+	if (strnlen(textSrc, DCF77BLOCK_TEXT_LEN) < DCF77BLOCK_TEXT_LEN)
+		return DCF77BLOCK_TEXT_TOO_SHORT;
+
+	if (0 != decodeHexText(textSrc, data))
+		return DCF77BLOCK_TEXT_BAD_DIGIT;
+
+	memcpy(pBinDst->data, data, DCF77BLOCK_SIZE);
+
+	return DCF77BLOCK_TEXT_OK;
 }
 
 void
 DCF77Block_ToText(const DCF77Block_t * pBinSrc,
 	char * textDst, size_t textDstSz)
 {
-	char locBuf[LOCBUF_SZ];
+	static const char hexDigits[16] = "0123456789ABCDEF";
 	int i;
 
 	if (NULL == pBinSrc || NULL == textDst)
@@ -51,11 +71,144 @@ DCF77Block_ToText(const DCF77Block_t * pBinSrc,
 	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
 		uint8_t byte = pBinSrc->data[i];
 
-		snprintf(locBuf, LOCBUF_SZ, "%02hhX", byte);
-		*textDst = locBuf[0];
-		++textDst;
-		*textDst = locBuf[1];
-		++textDst;
+		textDst[2 * i]     = hexDigits[byte >> 4];
+		textDst[2 * i + 1] = hexDigits[byte & 0x0Fu];
+	}
+	textDst[DCF77BLOCK_TEXT_LEN] = '\0';
+}
+
+#if defined(__SSE2__)
+
+/*
+ * Sixteen characters of a block fit a single SSE2 register.
+ */
+static int
+decodeHexText(const char * textSrc, uint8_t binDst[])
+{
+	const __m128i text  = _mm_loadu_si128((const __m128i *)textSrc);
+	const __m128i lower = _mm_or_si128(text, _mm_set1_epi8(0x20));
+	__m128i isDigit, isAlpha, nibbles, bytes;
+
+	isDigit = _mm_and_si128(_mm_cmpgt_epi8(text, _mm_set1_epi8('0' - 1)),
+	    _mm_cmplt_epi8(text, _mm_set1_epi8('9' + 1)));
+	isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+	    _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+	if (0xFFFF != _mm_movemask_epi8(_mm_or_si128(isDigit, isAlpha)))
+		return -1;
+
+	nibbles = _mm_or_si128(
+	    _mm_and_si128(isDigit, _mm_sub_epi8(text, _mm_set1_epi8('0'))),
+	    _mm_and_si128(isAlpha,
+		_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+
+	/* 16-bit lanes hold (low nibble << 8 | high nibble) */
+	bytes = _mm_or_si128(
+	    _mm_and_si128(_mm_slli_epi16(nibbles, 4), _mm_set1_epi16(0x00F0)),
+	    _mm_srli_epi16(nibbles, 8));
+
+	_mm_storel_epi64((__m128i *)binDst,
+	    _mm_packus_epi16(bytes, _mm_setzero_si128()));
+
+	return 0;
+}
+
+#elif UINTPTR_MAX == UINT64_MAX
+
+#define ONES64		0x0101010101010101ull
+#define HIGHBITS64	0x8080808080808080ull
+/* sets high bit of bytes not less than n; bytes must be below 0x80 */
+#define BYTES_GE(x, n)	(((x) + (0x80u - (n)) * ONES64) & HIGHBITS64)
+
+static int decodeHexWord(uint64_t word, uint32_t * pBytes);
+
+/*
+ * SWAR: eight characters are handled at once within a 64-bit word.
+ */
+static int
+decodeHexText(const char * textSrc, uint8_t binDst[])
+{
+	uint32_t bytes[2];
+	int i, rc = 0;
+
+	for (i = 0; i < 2; ++i) {
+		uint64_t word = 0u;
+		int j;
+
+		for (j = 7; j >= 0; --j) {
+			word = (word << 8) | (uint8_t)textSrc[8 * i + j];
+		}
+		rc |= decodeHexWord(word, &bytes[i]);
+	}
+
+	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
+		binDst[i] = (uint8_t)(bytes[i / 4] >> (8 * (i % 4)));
 	}
-	*textDst = '\0';
+
+	return rc;
 }
+
+static int
+decodeHexWord(uint64_t word, uint32_t * pBytes)
+{
+	uint64_t lower, digit, alpha, nibbles, pairs;
+
+	if (word & HIGHBITS64)
+		return -1;
+
+	lower = word | (0x20u * ONES64);
+	digit = BYTES_GE(word, '0') & ~BYTES_GE(word, '9' + 1);
+	alpha = BYTES_GE(lower, 'a') & ~BYTES_GE(lower, 'f' + 1);
+
+	if (HIGHBITS64 != (digit | alpha))
+		return -1;
+
+	/* letters have bit 6 set: add 9 to their low nibble */
+	nibbles = (word & (0x0Fu * ONES64)) + ((alpha >> 7) * 9u);
+
+	/* pair the characters: (high << 4 | low) in each 16-bit lane */
+	pairs = ((nibbles << 4) & 0x00F000F000F000F0ull) |
+	    ((nibbles >> 8) & 0x000F000F000F000Full);
+	pairs = (pairs | (pairs >> 8)) & 0x0000FFFF0000FFFFull;
+	pairs = (pairs | (pairs >> 16)) & 0x00000000FFFFFFFFull;
+
+	*pBytes = (uint32_t)pairs;
+
+	return 0;
+}
+
+#else
+
+static int
+hexDigitValue(char c)
+{
+	/* zero marks characters which are not hex digits */
+	static const uint8_t digitValue[256] = {
+		['0'] =  1, ['1'] =  2, ['2'] =  3, ['3'] =  4, ['4'] =  5,
+		['5'] =  6, ['6'] =  7, ['7'] =  8, ['8'] =  9, ['9'] = 10,
+		['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15,
+		['F'] = 16,
+		['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15,
+		['f'] = 16,
+	};
+
+	return digitValue[(uint8_t)c] - 1;
+}
+
+static int
+decodeHexText(const char * textSrc, uint8_t binDst[])
+{
+	int i, bad = 0;
+
+	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
+		int hi = hexDigitValue(textSrc[2 * i]);
+		int lo = hexDigitValue(textSrc[2 * i + 1]);
+
+		bad |= (hi | lo);
+		binDst[i] = (uint8_t)((hi << 4) | lo);
+	}
+
+	return (bad < 0) ? -1 : 0;
+}
+
+#endif /* #if defined(__SSE2__) */
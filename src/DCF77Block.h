@@ -1,6 +1,7 @@
 #ifndef D_DCF77Block_h
 #define D_DCF77Block_h
 
+#include <stddef.h>
 #include <stdint.h>
 
 enum {
@@ -8,11 +9,18 @@ enum {
 	DCF77BLOCK_TEXT_LEN = 16
 };
 
+enum {
+	DCF77BLOCK_TEXT_OK = 0,
+	DCF77BLOCK_TEXT_TOO_SHORT,
+	DCF77BLOCK_TEXT_BAD_DIGIT
+};
+
 typedef struct {
 	uint8_t data[DCF77BLOCK_SIZE];
 } DCF77Block_t;
 
 void DCF77Block_FromText(const char * textSrc, DCF77Block_t * pBinDst);
+int DCF77Block_ParseText(const char * textSrc, DCF77Block_t * pBinDst);
 void DCF77Block_ToText(const DCF77Block_t * pBinSrc,
 	char * textDst, size_t textDstSz);
 
@@ -0,0 +1,201 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <err.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include "DCF77BlockFile.h"
+
+static const char blockFileMagic[DCF77BLOCKFILE_MAGIC_SZ] = "DCF77BLK";
+
+static uint64_t
+getLE(const uint8_t * src, unsigned sz)
+{
+	uint64_t v = 0u;
+
+	while (sz--) {
+		v = (v << 8) | src[sz];
+	}
+
+	return v;
+}
+
+static void
+putLE(uint8_t * dst, uint64_t v, unsigned sz)
+{
+	unsigned i;
+
+	for (i = 0; i < sz; ++i) {
+		dst[i] = (uint8_t)(v >> (8 * i));
+	}
+}
+
+int
+DCF77BlockFile_HasMagic(const char * path)
+{
+	char magic[DCF77BLOCKFILE_MAGIC_SZ];
+	int fd, rc = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	if (read(fd, magic, sizeof(magic)) == (ssize_t)sizeof(magic)) {
+		rc = (0 == memcmp(magic, blockFileMagic, sizeof(magic)));
+	}
+	close(fd);
+
+	return rc;
+}
+
+/*
+ * Maps the whole file read-only: blocks are used right from the page
+ * cache, no parsing involved.
+ */
+void
+DCF77BlockFile_Open(DCF77BlockFile_t * pFile, const char * path)
+{
+	const uint8_t * pHeader;
+	struct stat st;
+	int fd;
+
+	memset(pFile, 0, sizeof(*pFile));
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		err(EX_NOINPUT, "%s", path);
+		/* NOTREACHED */
+	}
+
+	if (st.st_size < DCF77BLOCKFILE_HEADER_SZ) {
+		errx(EX_DATAERR, "%s: not a block file", path);
+		/* NOTREACHED */
+	}
+
+	pFile->mapSz = (size_t)st.st_size;
+	pFile->pMap = mmap(NULL, pFile->mapSz, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == pFile->pMap) {
+		err(EX_IOERR, "%s: mmap", path);
+		/* NOTREACHED */
+	}
+
+	pHeader = pFile->pMap;
+	if (0 != memcmp(pHeader, blockFileMagic, DCF77BLOCKFILE_MAGIC_SZ) ||
+	    DCF77BLOCKFILE_VERSION != getLE(&pHeader[8], 4) ||
+	    DCF77BLOCK_SIZE != getLE(&pHeader[12], 4)) {
+		errx(EX_DATAERR, "%s: not a block file", path);
+		/* NOTREACHED */
+	}
+
+	pFile->startTime = (int64_t)getLE(&pHeader[16], 8);
+	pFile->qty       = getLE(&pHeader[24], 8);
+	pFile->blocks    = (const DCF77Block_t *)
+	    (pHeader + DCF77BLOCKFILE_HEADER_SZ);
+
+	if (pFile->qty > (pFile->mapSz - DCF77BLOCKFILE_HEADER_SZ) /
+	    DCF77BLOCK_SIZE) {
+		errx(EX_DATAERR, "%s: truncated block file", path);
+		/* NOTREACHED */
+	}
+
+	(void)madvise(pFile->pMap, pFile->mapSz, MADV_WILLNEED);
+}
+
+void
+DCF77BlockFile_Close(DCF77BlockFile_t * pFile)
+{
+	if (NULL == pFile || NULL == pFile->pMap)
+		return;
+
+	(void)munmap(pFile->pMap, pFile->mapSz);
+	memset(pFile, 0, sizeof(*pFile));
+}
+
+/*
+ * Returns the block of the minute 't' belongs to, NULL when the file has
+ * none.
+ */
+const DCF77Block_t *
+DCF77BlockFile_BlockAt(const DCF77BlockFile_t * pFile, time_t t)
+{
+	int64_t idx;
+
+	if (NULL == pFile || NULL == pFile->blocks)
+		return NULL;
+
+	if ((int64_t)t < pFile->startTime)
+		return NULL;
+
+	idx = ((int64_t)t - pFile->startTime) / 60;
+	if ((uint64_t)idx >= pFile->qty)
+		return NULL;
+
+	return &pFile->blocks[idx];
+}
+
+static void writeHeader(DCF77BlockFileWriter_t * pWriter);
+
+void
+DCF77BlockFile_Create(DCF77BlockFileWriter_t * pWriter,
+	const char * path, time_t startTime)
+{
+	pWriter->path = path;
+	pWriter->startTime = (int64_t)startTime;
+	pWriter->qty = 0u;
+
+	pWriter->out = fopen(path, "wb");
+	if (NULL == pWriter->out) {
+		err(EX_CANTCREAT, "%s", path);
+		/* NOTREACHED */
+	}
+
+	/* the quantity gets filled in by DCF77BlockFile_Finish() */
+	writeHeader(pWriter);
+}
+
+void
+DCF77BlockFile_Append(DCF77BlockFileWriter_t * pWriter,
+	const DCF77Block_t blocks[], size_t qty)
+{
+	if (fwrite(blocks, DCF77BLOCK_SIZE, qty, pWriter->out) != qty) {
+		err(EX_IOERR, "%s", pWriter->path);
+		/* NOTREACHED */
+	}
+	pWriter->qty += qty;
+}
+
+void
+DCF77BlockFile_Finish(DCF77BlockFileWriter_t * pWriter)
+{
+	if (0 != fseek(pWriter->out, 0L, SEEK_SET)) {
+		err(EX_IOERR, "%s", pWriter->path);
+		/* NOTREACHED */
+	}
+	writeHeader(pWriter);
+
+	if (0 != fclose(pWriter->out)) {
+		err(EX_IOERR, "%s", pWriter->path);
+		/* NOTREACHED */
+	}
+	pWriter->out = NULL;
+}
+
+static void
+writeHeader(DCF77BlockFileWriter_t * pWriter)
+{
+	uint8_t header[DCF77BLOCKFILE_HEADER_SZ];
+
+	memcpy(&header[0], blockFileMagic, DCF77BLOCKFILE_MAGIC_SZ);
+	putLE(&header[8],  DCF77BLOCKFILE_VERSION, 4);
+	putLE(&header[12], DCF77BLOCK_SIZE, 4);
+	putLE(&header[16], (uint64_t)pWriter->startTime, 8);
+	putLE(&header[24], pWriter->qty, 8);
+
+	if (fwrite(header, sizeof(header), 1, pWriter->out) != 1) {
+		err(EX_IOERR, "%s", pWriter->path);
+		/* NOTREACHED */
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef D_DCF77BlockFile_h
+#define D_DCF77BlockFile_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "DCF77Block.h"
+
+/*
+ * Block file layout, all numbers little-endian:
+ *   0: magic "DCF77BLK"
+ *   8: uint32 format version
+ *  12: uint32 block size (8)
+ *  16: int64  start time: seconds since the Epoch of the first minute
+ *  24: uint64 quantity of blocks
+ *  32: blocks of consecutive minutes, 8 bytes each
+ */
+enum {
+	DCF77BLOCKFILE_HEADER_SZ = 32,
+	DCF77BLOCKFILE_MAGIC_SZ = 8,
+	DCF77BLOCKFILE_VERSION = 1
+};
+
+typedef struct {
+	int64_t			 startTime;
+	uint64_t		 qty;
+	const DCF77Block_t	*blocks;
+	void			*pMap;
+	size_t			 mapSz;
+} DCF77BlockFile_t;
+
+typedef struct {
+	FILE			*out;
+	const char		*path;
+	int64_t			 startTime;
+	uint64_t		 qty;
+} DCF77BlockFileWriter_t;
+
+int DCF77BlockFile_HasMagic(const char * path);
+void DCF77BlockFile_Open(DCF77BlockFile_t * pFile, const char * path);
+void DCF77BlockFile_Close(DCF77BlockFile_t * pFile);
+const DCF77Block_t * DCF77BlockFile_BlockAt(const DCF77BlockFile_t * pFile,
+	time_t t);
+
+void DCF77BlockFile_Create(DCF77BlockFileWriter_t * pWriter,
+	const char * path, time_t startTime);
+void DCF77BlockFile_Append(DCF77BlockFileWriter_t * pWriter,
+	const DCF77Block_t blocks[], size_t qty);
+void DCF77BlockFile_Finish(DCF77BlockFileWriter_t * pWriter);
+
+#endif /* #ifndef D_DCF77BlockFile_h */
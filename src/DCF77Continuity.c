@@ -0,0 +1,168 @@
+#include <string.h>
+#include "DCF77Continuity.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+
+#define CONTINUITY_LANES	8	/* pairs checked at once, for SIMD */
+
+#define TIME_MASK	(DCF77TC_MASK(MIN) | DCF77TC_MASK(HOUR) |	\
+			 DCF77TC_MASK(DOM) | DCF77TC_MASK(DOW) |	\
+			 DCF77TC_MASK(MONTH) | DCF77TC_MASK(YEAR))
+#define ZONE_MASK	(DCF77TC_MASK(Z1) | DCF77TC_MASK(Z2))
+#define CHECK_MASK	(TIME_MASK | ZONE_MASK | DCF77TC_MASK(A1))
+
+/* a pair left to DCF77TimeCode_AdvanceByMinute(), above CHECK_MASK */
+#define HOUR_ENDS	(UINT64_C(1) << 63)
+
+void
+DCF77Continuity_Init(DCF77Continuity_t * pCheck,
+	DCF77ContinuityFn_t onRange, void * ctx)
+{
+	memset(pCheck, 0, sizeof(*pCheck));
+	pCheck->onRange = onRange;
+	pCheck->ctx = ctx;
+}
+
+/*
+ * Within an hour only the minute moves: its low digit goes up by one, a
+ * 9 turning into the next ten (the +6 skipping 0xA-0xF), so the word
+ * after 'prev' is a single addition away.  Minute 59 is flagged instead,
+ * an hour, day, DST change or A1 coming up with the next minute.
+ * Branch free, so that the lanes below vectorize.
+ */
+static inline uint64_t
+pairDiff(uint64_t prev, uint64_t w)
+{
+	uint64_t low = (prev >> DCF77TC_MIN_SHIFT) & 0xFu;
+	uint64_t nines = (low + 7u) >> 4;
+	uint64_t next = prev + ((1u + 6u * nines) << DCF77TC_MIN_SHIFT);
+	uint64_t hourEnds = (uint64_t)(0x59u == DCF77TC_GET(prev, MIN)) << 63;
+
+	return ((next ^ w) & CHECK_MASK) | hourEnds;
+}
+
+static uint64_t
+hourEndDiff(uint64_t prev, uint64_t w)
+{
+	DCF77Block_t next;
+
+	DCF77TimeCode_StoreWord(prev, &next);
+	DCF77TimeCode_AdvanceByMinute(&next);
+
+	return (DCF77TimeCode_LoadWord(&next) ^ w) & CHECK_MASK;
+}
+
+static void
+closeRange(DCF77Continuity_t * pCheck)
+{
+	pCheck->onRange(pCheck->ctx, &pCheck->range);
+	++pCheck->rangesQty;
+	memset(&pCheck->range, 0, sizeof(pCheck->range));
+}
+
+/*
+ * Settles the pair ending at stream position 'at' whose pairDiff() is
+ * 'diff'.
+ */
+static void
+settlePair(DCF77Continuity_t * pCheck, uint64_t at, uint64_t prev,
+	uint64_t w, uint64_t diff)
+{
+	if (0u != (diff & HOUR_ENDS)) {
+		diff = hourEndDiff(prev, w);
+	}
+
+	if (0u == diff) {
+		if (0u != pCheck->range.qty) {
+			closeRange(pCheck);
+		}
+		return;
+	}
+
+	if (0u == pCheck->range.qty) {
+		pCheck->range.first = at;
+	}
+	++pCheck->range.qty;
+	pCheck->range.reasons |=
+	    ((0u != (diff & TIME_MASK)) ? DCF77CONTINUITY_TIME : 0u) |
+	    ((0u != (diff & ZONE_MASK)) ? DCF77CONTINUITY_ZONE : 0u) |
+	    ((0u != (diff & DCF77TC_MASK(A1))) ? DCF77CONTINUITY_A1 : 0u);
+}
+
+/*
+ * Blocks are checked in groups of CONTINUITY_LANES pairs; a group with
+ * nothing but minutes within hours that follow each other is done with
+ * in a few vector instructions, the others are gone through pair by
+ * pair.  Blocks may come in pushes of any size, a range may span them.
+ */
+void
+DCF77Continuity_Push(DCF77Continuity_t * pCheck,
+	const DCF77Block_t * blocks, size_t qty)
+{
+	uint64_t diffs[CONTINUITY_LANES];
+	uint64_t prev, w, any;
+	size_t i, k;
+
+	if (0u == qty)
+		return;
+
+	/* the first block pushed ever has nothing to follow */
+	w = DCF77TimeCode_LoadWord(&blocks[0]);
+	if (0u != pCheck->seen) {
+		prev = pCheck->last;
+		settlePair(pCheck, pCheck->seen, prev, w, pairDiff(prev, w));
+	}
+
+	for (i = 1; i + CONTINUITY_LANES <= qty; i += CONTINUITY_LANES) {
+		any = 0u;
+		for (k = 0; k < CONTINUITY_LANES; ++k) {
+			diffs[k] = pairDiff(
+			    DCF77TimeCode_LoadWord(&blocks[i + k - 1]),
+			    DCF77TimeCode_LoadWord(&blocks[i + k]));
+			any |= diffs[k];
+		}
+
+		if (0u == any) {
+			if (0u != pCheck->range.qty) {
+				closeRange(pCheck);
+			}
+			continue;
+		}
+
+		for (k = 0; k < CONTINUITY_LANES; ++k) {
+			if (0u == diffs[k]) {
+				if (0u != pCheck->range.qty) {
+					closeRange(pCheck);
+				}
+				continue;
+			}
+			settlePair(pCheck, pCheck->seen + i + k,
+			    DCF77TimeCode_LoadWord(&blocks[i + k - 1]),
+			    DCF77TimeCode_LoadWord(&blocks[i + k]), diffs[k]);
+		}
+	}
+
+	for (; i < qty; ++i) {
+		prev = DCF77TimeCode_LoadWord(&blocks[i - 1]);
+		w = DCF77TimeCode_LoadWord(&blocks[i]);
+		settlePair(pCheck, pCheck->seen + i, prev, w,
+		    pairDiff(prev, w));
+	}
+
+	pCheck->last = DCF77TimeCode_LoadWord(&blocks[qty - 1]);
+	pCheck->seen += qty;
+}
+
+/*
+ * Reports the range still open at the end of the stream.  Returns the
+ * ranges reported all along.
+ */
+uint64_t
+DCF77Continuity_Finish(DCF77Continuity_t * pCheck)
+{
+	if (0u != pCheck->range.qty) {
+		closeRange(pCheck);
+	}
+
+	return pCheck->rangesQty;
+}
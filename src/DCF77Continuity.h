@@ -0,0 +1,47 @@
+#ifndef D_DCF77Continuity_h
+#define D_DCF77Continuity_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+/*
+ * Continuity check of a stream of blocks, such as a receiver log: every
+ * block has to encode the minute right after the one before it, with
+ * Z1/Z2 changing only where the clock does and A1 up throughout the
+ * hour before.  Weather, R, A2 and the parities are not looked at
+ * (DCF77TimeCode_Validate() checks the latter).  A block that does not
+ * follow the one before is a break; breaks in a row are reported as a
+ * range.
+ */
+enum {
+	DCF77CONTINUITY_TIME	= 0x01,	/* minute, hour or date off */
+	DCF77CONTINUITY_ZONE	= 0x02,	/* Z1/Z2 off */
+	DCF77CONTINUITY_A1	= 0x04	/* A1 off */
+};
+
+typedef struct {
+	uint64_t	first;		/* position of the first break */
+	uint64_t	qty;		/* breaks in a row */
+	unsigned	reasons;	/* DCF77CONTINUITY_..., of all */
+} DCF77ContinuityRange_t;
+
+typedef void (*DCF77ContinuityFn_t)(void * ctx,
+	const DCF77ContinuityRange_t * pRange);
+
+typedef struct {
+	DCF77ContinuityFn_t	 onRange;
+	void			*ctx;
+	uint64_t		 seen;		/* blocks pushed so far */
+	uint64_t		 last;		/* word of the last of them */
+	DCF77ContinuityRange_t	 range;		/* open when qty != 0 */
+	uint64_t		 rangesQty;	/* ranges reported */
+} DCF77Continuity_t;
+
+void DCF77Continuity_Init(DCF77Continuity_t * pCheck,
+	DCF77ContinuityFn_t onRange, void * ctx);
+void DCF77Continuity_Push(DCF77Continuity_t * pCheck,
+	const DCF77Block_t * blocks, size_t qty);
+uint64_t DCF77Continuity_Finish(DCF77Continuity_t * pCheck);
+
+#endif /* #ifndef D_DCF77Continuity_h */
@@ -0,0 +1,208 @@
+#include <err.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+#include "DCF77DSTTable.h"
+
+#define SECONDS_PER_DAY (24L * 60 * 60)
+
+static time_t startOfYear(int year);
+static void probeRange(DCF77DSTTable_t * pTable, time_t from, time_t to);
+static time_t findTransition(time_t before, time_t after);
+static void appendTransition(DCF77DSTTable_t * pTable, time_t at);
+
+/*
+ * Probes local timezone day by day over the years requested and pins
+ * every change of DST flag (or of UTC offset) down to a second.  This is
+ * the only place libc time conversions happen; lookups are read-only and
+ * thus may be shared by threads.
+ */
+void
+DCF77DSTTable_Build(DCF77DSTTable_t * pTable, int firstYear, int lastYear)
+{
+	if (NULL == pTable)
+		return;
+
+	memset(pTable, 0, sizeof(*pTable));
+	pTable->firstYear = firstYear;
+	pTable->lastYear  = lastYear;
+
+	if (lastYear < firstYear)
+		return;
+
+	probeRange(pTable, startOfYear(firstYear), startOfYear(lastYear + 1));
+}
+
+static time_t
+startOfYear(int year)
+{
+	struct tm stm;
+
+	memset(&stm, 0, sizeof(stm));
+	stm.tm_year  = year - 1900;
+	stm.tm_mday  = 1;
+	stm.tm_isdst = -1;
+
+	return mktime(&stm);
+}
+
+static int
+sameOffset(const struct tm * a, const struct tm * b)
+{
+	return (a->tm_isdst == b->tm_isdst && a->tm_gmtoff == b->tm_gmtoff);
+}
+
+static void
+probeRange(DCF77DSTTable_t * pTable, time_t from, time_t to)
+{
+	struct tm prevStm, currStm;
+	time_t t;
+
+	(void)localtime_r(&from, &prevStm);
+	pTable->gmtoff = prevStm.tm_gmtoff;
+
+	for (t = from + SECONDS_PER_DAY; t - SECONDS_PER_DAY < to;
+	    t += SECONDS_PER_DAY) {
+		(void)localtime_r(&t, &currStm);
+
+		if (!sameOffset(&prevStm, &currStm)) {
+			appendTransition(pTable,
+			    findTransition(t - SECONDS_PER_DAY, t));
+		}
+		prevStm = currStm;
+	}
+}
+
+/*
+ * Returns the first second showing the offset of 'after'.
+ */
+static time_t
+findTransition(time_t before, time_t after)
+{
+	struct tm beforeStm, midStm;
+
+	(void)localtime_r(&before, &beforeStm);
+
+	while (after - before > 1) {
+		time_t mid = before + (after - before) / 2;
+
+		(void)localtime_r(&mid, &midStm);
+
+		if (sameOffset(&beforeStm, &midStm)) {
+			before = mid;
+		} else {
+			after = mid;
+		}
+	}
+
+	return after;
+}
+
+static void
+appendTransition(DCF77DSTTable_t * pTable, time_t at)
+{
+	DCF77DSTTransition_t * pTr;
+	struct tm beforeStm, afterStm;
+	time_t justBefore = at - 1;
+
+	if (pTable->qty >= DCF77DSTTABLE_MAX_TRANSITIONS) {
+		errx(EX_SOFTWARE, "too many DST transitions");
+		/* NOTREACHED */
+	}
+
+	(void)localtime_r(&justBefore, &beforeStm);
+	(void)localtime_r(&at, &afterStm);
+
+	pTr = &pTable->transitions[pTable->qty];
+	pTr->wallMinute   = (long)((at + beforeStm.tm_gmtoff) / 60);
+	pTr->shiftMinutes = (int)((afterStm.tm_gmtoff - beforeStm.tm_gmtoff)
+	    / 60);
+	pTr->isdstBefore  = beforeStm.tm_isdst;
+	pTr->isdstAfter   = afterStm.tm_isdst;
+	pTr->gmtoffAfter  = afterStm.tm_gmtoff;
+
+	++pTable->qty;
+}
+
+int
+DCF77DSTTable_Covers(const DCF77DSTTable_t * pTable, int year)
+{
+	if (NULL == pTable)
+		return 0;
+
+	return (year >= pTable->firstYear && year <= pTable->lastYear);
+}
+
+/*
+ * Finds the earliest transition not yet happened at 'wallMinute' as shown
+ * by the clock with the given DST flag.  Wall clock minutes going back
+ * within a repeated hour are told apart by the DST flag.
+ */
+const DCF77DSTTransition_t *
+DCF77DSTTable_NextTransition(const DCF77DSTTable_t * pTable,
+	long wallMinute, int isdst)
+{
+	size_t lo = 0u, hi;
+
+	if (NULL == pTable)
+		return NULL;
+
+	hi = pTable->qty;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (pTable->transitions[mid].wallMinute <= wallMinute) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	/* within the repeated hour the clock may be past the transition */
+	if (lo < pTable->qty) {
+		const DCF77DSTTransition_t * pTr = &pTable->transitions[lo];
+
+		if (pTr->shiftMinutes < 0 && isdst != pTr->isdstBefore &&
+		    isdst == pTr->isdstAfter &&
+		    wallMinute >= pTr->wallMinute + pTr->shiftMinutes) {
+			++lo;
+		}
+	}
+
+	return (lo < pTable->qty) ? &pTable->transitions[lo] : NULL;
+}
+
+/*
+ * Mirrors the check of the DST flag in an hour from now: true when the
+ * clock gets to the transition within the next 60 minutes.
+ */
+int
+DCF77DSTTable_ChangeApproaching(const DCF77DSTTable_t * pTable,
+	long wallMinute, int isdst)
+{
+	const DCF77DSTTransition_t * pTr;
+
+	pTr = DCF77DSTTable_NextTransition(pTable, wallMinute, isdst);
+	if (NULL == pTr || pTr->isdstBefore == pTr->isdstAfter)
+		return 0;
+
+	return (pTr->wallMinute - wallMinute <= 60);
+}
+
+/*
+ * The offset of the clock showing 'wallMinute' with the given DST flag
+ * from UTC: the one set by the last transition before, if any.
+ */
+long
+DCF77DSTTable_UTCOffset(const DCF77DSTTable_t * pTable, long wallMinute,
+	int isdst)
+{
+	const DCF77DSTTransition_t * pTr;
+	size_t next;
+
+	pTr = DCF77DSTTable_NextTransition(pTable, wallMinute, isdst);
+	next = (NULL == pTr) ? pTable->qty : (size_t)(pTr - pTable->transitions);
+
+	return (0u == next) ? pTable->gmtoff :
+	    pTable->transitions[next - 1].gmtoffAfter;
+}
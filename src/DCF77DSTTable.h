@@ -0,0 +1,41 @@
+#ifndef D_DCF77DSTTable_h
+#define D_DCF77DSTTable_h
+
+#include <stddef.h>
+
+enum {
+	DCF77DSTTABLE_MAX_TRANSITIONS = 256
+};
+
+/*
+ * Wall clock minutes are counted since 1970-01-01 00:00 of local time,
+ * as shown by the clock in effect before the transition.
+ */
+typedef struct {
+	long	wallMinute;	/* first minute not shown anymore */
+	int	shiftMinutes;	/* the clock jumps by: +60 or -60 mostly */
+	int	isdstBefore;
+	int	isdstAfter;
+	long	gmtoffAfter;	/* UTC offset from then on, seconds */
+} DCF77DSTTransition_t;
+
+typedef struct {
+	int			firstYear;
+	int			lastYear;
+	long			gmtoff;		/* UTC offset as firstYear
+						 * starts, seconds */
+	size_t			qty;
+	DCF77DSTTransition_t	transitions[DCF77DSTTABLE_MAX_TRANSITIONS];
+} DCF77DSTTable_t;
+
+void DCF77DSTTable_Build(DCF77DSTTable_t * pTable,
+	int firstYear, int lastYear);
+int DCF77DSTTable_Covers(const DCF77DSTTable_t * pTable, int year);
+const DCF77DSTTransition_t * DCF77DSTTable_NextTransition(
+	const DCF77DSTTable_t * pTable, long wallMinute, int isdst);
+int DCF77DSTTable_ChangeApproaching(const DCF77DSTTable_t * pTable,
+	long wallMinute, int isdst);
+long DCF77DSTTable_UTCOffset(const DCF77DSTTable_t * pTable,
+	long wallMinute, int isdst);
+
+#endif /* #ifndef D_DCF77DSTTable_h */
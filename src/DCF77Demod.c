@@ -0,0 +1,417 @@
+#include <err.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77Demod.h"
+#include "DCF77Synth.h"
+#include "DCF77TimeCode.h"
+
+#define DEMOD_LANES		8	/* independent sums, for SIMD */
+#define DEMOD_CHUNK		4096	/* frames read at once */
+#define DEMOD_MIN_CONTRAST	0.2f	/* of the full level */
+
+/* pulse widths and spacing, ms */
+#define PULSE_MIN	40
+#define PULSE_SPLIT	150
+#define PULSE_MAX	260
+#define MARK_GAP_MIN	1800
+#define MARK_GAP_MAX	2200
+#define MINUTE_MS	60000
+#define SECOND_MS	1000
+#define LEVELS_MS	2000	/* has a pulse even around the mark */
+
+static void processMs(DCF77Demod_t * pDemod, float level);
+
+void
+DCF77Demod_Init(DCF77Demod_t * pDemod, unsigned sampleRate,
+	DCF77DemodMinuteFn_t onMinute, void * ctx)
+{
+	if (sampleRate < 1000) {
+		errx(EX_DATAERR, "sample rate below 1000 Hz");
+		/* NOTREACHED */
+	}
+
+	memset(pDemod, 0, sizeof(*pDemod));
+	pDemod->sampleRate = sampleRate;
+	pDemod->onMinute = onMinute;
+	pDemod->ctx = ctx;
+	pDemod->msEnd = sampleRate / 1000;
+	pDemod->winMin = INFINITY;
+}
+
+/*
+ * Lanes keep the additions independent, so the compiler may run them in
+ * vector registers without reassociating float math.
+ */
+static float
+absSum(const float * x, size_t qty)
+{
+	float lanes[DEMOD_LANES] = { 0.0f };
+	float sum = 0.0f;
+	size_t i, k;
+
+	for (i = 0; i + DEMOD_LANES <= qty; i += DEMOD_LANES) {
+		for (k = 0; k < DEMOD_LANES; ++k) {
+			lanes[k] += fabsf(x[i + k]);
+		}
+	}
+	for (; i < qty; ++i) {
+		sum += fabsf(x[i]);
+	}
+	for (k = 0; k < DEMOD_LANES; ++k) {
+		sum += lanes[k];
+	}
+
+	return sum;
+}
+
+/*
+ * Envelope is the mean of rectified samples over each millisecond;
+ * with rates not divisible by 1000 the milliseconds differ by a sample.
+ */
+void
+DCF77Demod_Push(DCF77Demod_t * pDemod, const float * samples, size_t qty)
+{
+	size_t i = 0;
+
+	while (i < qty) {
+		size_t take = (size_t)(pDemod->msEnd - pDemod->sampleQty);
+
+		if (take > qty - i) {
+			take = qty - i;
+		}
+		pDemod->acc += absSum(&samples[i], take);
+		pDemod->sampleQty += take;
+		i += take;
+
+		if (pDemod->sampleQty == pDemod->msEnd) {
+			processMs(pDemod, pDemod->acc /
+			    (float)(pDemod->msEnd - pDemod->msStart));
+			pDemod->acc = 0.0f;
+			pDemod->msStart = pDemod->msEnd;
+			pDemod->msEnd = (pDemod->msQty + 1) *
+			    pDemod->sampleRate / 1000;
+		}
+	}
+}
+
+static void updateLevels(DCF77Demod_t * pDemod, float level);
+static void onPulse(DCF77Demod_t * pDemod, uint64_t startMs, unsigned bit);
+
+static void
+processMs(DCF77Demod_t * pDemod, float level)
+{
+	uint64_t now = pDemod->msQty++;
+
+	updateLevels(pDemod, level);
+	if (!pDemod->haveLevels)
+		return;
+
+	if (!pDemod->isLow && level < pDemod->thrLow) {
+		pDemod->isLow = 1;
+		pDemod->fallMs = now;
+	} else if (pDemod->isLow && level > pDemod->thrHigh) {
+		uint64_t width = now - pDemod->fallMs;
+
+		pDemod->isLow = 0;
+		/* anything else is a glitch */
+		if (width >= PULSE_MIN && width <= PULSE_MAX) {
+			onPulse(pDemod, pDemod->fallMs,
+			    (width >= PULSE_SPLIT) ? 1u : 0u);
+		}
+	}
+}
+
+/*
+ * Thresholds follow the levels seen during the previous two seconds, with
+ * hysteresis of an eighth of the swing.  Too small a swing means no
+ * signal: detection stops until it comes back.
+ */
+static void
+updateLevels(DCF77Demod_t * pDemod, float level)
+{
+	if (level > pDemod->winMax) {
+		pDemod->winMax = level;
+	}
+	if (level < pDemod->winMin) {
+		pDemod->winMin = level;
+	}
+	if (++pDemod->winLen < LEVELS_MS)
+		return;
+
+	if (pDemod->winMax - pDemod->winMin >=
+	    pDemod->winMax * DEMOD_MIN_CONTRAST) {
+		float mid = (pDemod->winMax + pDemod->winMin) / 2.0f;
+		float hyst = (pDemod->winMax - pDemod->winMin) / 8.0f;
+
+		pDemod->thrLow = mid - hyst;
+		pDemod->thrHigh = mid + hyst;
+		pDemod->haveLevels = 1;
+	} else {
+		pDemod->haveLevels = 0;
+		pDemod->isLow = 0;
+		pDemod->inMinute = 0;
+	}
+
+	pDemod->winMax = 0.0f;
+	pDemod->winMin = INFINITY;
+	pDemod->winLen = 0;
+}
+
+/*
+ * A gap of two seconds is the minute mark, unless it comes in the middle
+ * of a minute: then just a pulse is lost.  Bits are placed by the pulse
+ * time, so lost pulses leave holes in 'present' rather than shift bits.
+ * A minute whose bits announce a leap second has a 0 pulse in second 59
+ * and its mark a second later.
+ */
+static void
+onPulse(DCF77Demod_t * pDemod, uint64_t startMs, unsigned bit)
+{
+	DCF77DemodMinute_t * pMinute = &pDemod->minute;
+	uint64_t second;
+
+	if (pDemod->havePulse) {
+		uint64_t gap = startMs - pDemod->pulseMs;
+		int isMarkGap = gap >= MARK_GAP_MIN && gap <= MARK_GAP_MAX;
+		uint64_t sinceMinute = startMs - pDemod->minuteMs;
+		uint64_t minuteLen = MINUTE_MS +
+		    (pMinute->hasLeapSecond ? SECOND_MS : 0);
+
+		if (isMarkGap && (!pDemod->inMinute ||
+		    (sinceMinute >= minuteLen - SECOND_MS / 2 &&
+		     sinceMinute <= minuteLen + SECOND_MS / 2))) {
+			if (pDemod->inMinute) {
+				pMinute->markMs = startMs;
+				pDemod->onMinute(pDemod->ctx, pMinute);
+			}
+			memset(pMinute, 0, sizeof(*pMinute));
+			pDemod->minuteMs = startMs;
+			pDemod->inMinute = 1;
+		} else if (gap > MARK_GAP_MAX) {
+			pDemod->inMinute = 0;
+		}
+	}
+	pDemod->pulseMs = startMs;
+	pDemod->havePulse = 1;
+
+	if (!pDemod->inMinute)
+		return;
+
+	second = (startMs - pDemod->minuteMs + SECOND_MS / 2) / SECOND_MS;
+	if (59 == second && 0u == bit && !pMinute->hasLeapSecond &&
+	    DCF77TimeCode_HasLeapSecond(&pMinute->block)) {
+		pMinute->hasLeapSecond = 1;
+		return;
+	}
+	if (second >= 59) {
+		/* the mark never came */
+		pDemod->inMinute = 0;
+		return;
+	}
+
+	pMinute->present |= UINT64_C(1) << second;
+	pMinute->block.data[second / 8] |= (uint8_t)(bit << (second % 8));
+}
+
+/*
+ * The last minute of a stream has no mark after it; it counts once the
+ * stream is past the time its 59th second would have a pulse.
+ */
+void
+DCF77Demod_Finish(DCF77Demod_t * pDemod)
+{
+	DCF77DemodMinute_t * pMinute = &pDemod->minute;
+
+	uint64_t minuteLen = MINUTE_MS +
+	    (pMinute->hasLeapSecond ? SECOND_MS : 0);
+
+	if (pDemod->inMinute &&
+	    pDemod->msQty >= pDemod->minuteMs + minuteLen - SECOND_MS +
+	    PULSE_MAX) {
+		pMinute->markMs = pDemod->minuteMs + minuteLen;
+		pDemod->onMinute(pDemod->ctx, pMinute);
+	}
+	pDemod->inMinute = 0;
+}
+
+int
+DCF77Demod_HasWAVMagic(const char * path)
+{
+	char magic[12];
+	FILE * f = fopen(path, "rb");
+	int has;
+
+	if (NULL == f)
+		return 0;
+
+	has = fread(magic, sizeof(magic), 1, f) == 1 &&
+	    0 == memcmp(magic, "RIFF", 4) && 0 == memcmp(&magic[8], "WAVE", 4);
+	fclose(f);
+
+	return has;
+}
+
+static uint32_t
+getLE(const uint8_t * src, unsigned sz)
+{
+	uint32_t v = 0;
+
+	while (sz-- > 0) {
+		v = (v << 8) | src[sz];
+	}
+
+	return v;
+}
+
+static void
+readExactly(FILE * in, const char * path, void * buf, size_t sz)
+{
+	if (fread(buf, 1, sz, in) != sz) {
+		errx(EX_DATAERR, "%s: truncated WAV header", path);
+		/* NOTREACHED */
+	}
+}
+
+/* reads past, rather than seeks, so that a pipe will do */
+static void
+skipBytes(FILE * in, const char * path, uint64_t sz)
+{
+	uint8_t scratch[256];
+	size_t n;
+
+	while (0u != sz) {
+		n = (sz < sizeof(scratch)) ? (size_t)sz : sizeof(scratch);
+		if (fread(scratch, 1, n, in) != n) {
+			errx(EX_DATAERR, "%s: truncated WAV file", path);
+			/* NOTREACHED */
+		}
+		sz -= n;
+	}
+}
+
+/*
+ * Leaves 'in' at the first sample.  PCM 16 bit and float 32 bit are
+ * understood, plain or as WAVE_FORMAT_EXTENSIBLE; channels past the
+ * first one are skipped.
+ */
+void
+DCF77Demod_ReadWAVHeader(FILE * in, const char * path,
+	DCF77DemodInput_t * pInput)
+{
+	uint8_t h[40];
+	int haveFmt = 0;
+
+	readExactly(in, path, h, 12);
+	if (0 != memcmp(h, "RIFF", 4) || 0 != memcmp(&h[8], "WAVE", 4)) {
+		errx(EX_DATAERR, "%s: not a WAV file", path);
+		/* NOTREACHED */
+	}
+
+	for (;;) {
+		uint32_t chunkSz;
+
+		readExactly(in, path, h, 8);
+		chunkSz = getLE(&h[4], 4);
+
+		if (0 == memcmp(h, "data", 4))
+			break;
+
+		if (0 == memcmp(h, "fmt ", 4) && chunkSz >= 16) {
+			unsigned tag, bits;
+			size_t fmtSz = (chunkSz < sizeof(h)) ?
+			    chunkSz : sizeof(h);
+
+			readExactly(in, path, h, fmtSz);
+			chunkSz -= (uint32_t)fmtSz;
+
+			tag = getLE(&h[0], 2);
+			if (0xFFFEu == tag && fmtSz >= 26) {
+				tag = getLE(&h[24], 2);
+			}
+			pInput->channels = getLE(&h[2], 2);
+			pInput->sampleRate = getLE(&h[4], 4);
+			bits = getLE(&h[14], 2);
+
+			if (1 == tag && 16 == bits) {
+				pInput->format = DCF77SYNTH_S16;
+			} else if (3 == tag && 32 == bits) {
+				pInput->format = DCF77SYNTH_F32;
+			} else {
+				errx(EX_DATAERR, "%s: only 16-bit PCM and "
+				    "32-bit float WAV supported", path);
+				/* NOTREACHED */
+			}
+			haveFmt = 1;
+		}
+
+		/* chunks are padded to even size */
+		skipBytes(in, path, (uint64_t)chunkSz + (chunkSz & 1u));
+	}
+
+	if (!haveFmt || 0 == pInput->channels) {
+		errx(EX_DATAERR, "%s: WAV format chunk missing", path);
+		/* NOTREACHED */
+	}
+}
+
+static void
+convertS16(const uint8_t * src, size_t frames, size_t stride,
+	float * dst)
+{
+	size_t i;
+
+	for (i = 0; i < frames; ++i) {
+		const uint8_t * p = &src[i * stride];
+
+		dst[i] = (float)(int16_t)(p[0] | (p[1] << 8)) * (1.0f / 32768);
+	}
+}
+
+static void
+convertF32(const uint8_t * src, size_t frames, size_t stride,
+	float * dst)
+{
+	size_t i;
+
+	for (i = 0; i < frames; ++i) {
+		memcpy(&dst[i], &src[i * stride], sizeof(float));
+	}
+}
+
+void
+DCF77Demod_ProcessStream(DCF77Demod_t * pDemod, FILE * in,
+	const char * path, const DCF77DemodInput_t * pInput)
+{
+	size_t sampleSz = (DCF77SYNTH_F32 == pInput->format) ?
+	    sizeof(float) : sizeof(int16_t);
+	size_t frameSz = sampleSz * pInput->channels;
+	uint8_t * raw = malloc(DEMOD_CHUNK * frameSz);
+	float * samples = malloc(DEMOD_CHUNK * sizeof(*samples));
+	size_t frames;
+
+	if (NULL == raw || NULL == samples) {
+		err(EX_OSERR, "no memory for samples");
+		/* NOTREACHED */
+	}
+
+	while ((frames = fread(raw, frameSz, DEMOD_CHUNK, in)) > 0) {
+		if (DCF77SYNTH_F32 == pInput->format) {
+			convertF32(raw, frames, frameSz, samples);
+		} else {
+			convertS16(raw, frames, frameSz, samples);
+		}
+		DCF77Demod_Push(pDemod, samples, frames);
+	}
+
+	if (ferror(in)) {
+		err(EX_IOERR, "%s", path);
+		/* NOTREACHED */
+	}
+	DCF77Demod_Finish(pDemod);
+
+	free(samples);
+	free(raw);
+}
@@ -0,0 +1,72 @@
+#ifndef D_DCF77Demod_h
+#define D_DCF77Demod_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+/*
+ * Demodulator of DCF77 amplitude modulation.  Samples of a carrier (or
+ * of its envelope) are reduced to a 1 ms envelope, pulses are found
+ * against a threshold derived from recent levels, their
+ * widths give bits, and the missing pulse of second 59 frames minutes.
+ */
+
+#define DCF77DEMOD_ALL_PULSES	((UINT64_C(1) << 59) - 1)
+
+typedef struct {
+	uint64_t	markMs;		/* minute mark the block's time
+					 * starts at, ms into the stream */
+	uint64_t	present;	/* bit N: pulse of second N seen */
+	int		hasLeapSecond;	/* 0 pulse in second 59 seen */
+	DCF77Block_t	block;
+} DCF77DemodMinute_t;
+
+typedef void (*DCF77DemodMinuteFn_t)(void * ctx,
+	const DCF77DemodMinute_t * pMinute);
+
+typedef struct {
+	unsigned		 sampleRate;
+	DCF77DemodMinuteFn_t	 onMinute;
+	void			*ctx;
+	/* envelope */
+	uint64_t		 sampleQty;
+	uint64_t		 msQty;
+	uint64_t		 msStart, msEnd;	/* in samples */
+	float			 acc;
+	/* levels over the last two seconds */
+	float			 winMax, winMin;
+	unsigned		 winLen;
+	float			 thrLow, thrHigh;
+	int			 haveLevels;
+	/* pulses */
+	int			 isLow;
+	uint64_t		 fallMs;
+	int			 havePulse;
+	uint64_t		 pulseMs;
+	/* minute being assembled */
+	int			 inMinute;
+	uint64_t		 minuteMs;
+	DCF77DemodMinute_t	 minute;
+} DCF77Demod_t;
+
+/* sample stream description, DCF77SYNTH_S16 or _F32 samples */
+typedef struct {
+	unsigned	sampleRate;
+	unsigned	channels;
+	int		format;
+} DCF77DemodInput_t;
+
+void DCF77Demod_Init(DCF77Demod_t * pDemod, unsigned sampleRate,
+	DCF77DemodMinuteFn_t onMinute, void * ctx);
+void DCF77Demod_Push(DCF77Demod_t * pDemod, const float * samples,
+	size_t qty);
+void DCF77Demod_Finish(DCF77Demod_t * pDemod);
+
+int DCF77Demod_HasWAVMagic(const char * path);
+void DCF77Demod_ReadWAVHeader(FILE * in, const char * path,
+	DCF77DemodInput_t * pInput);
+void DCF77Demod_ProcessStream(DCF77Demod_t * pDemod, FILE * in,
+	const char * path, const DCF77DemodInput_t * pInput);
+
+#endif /* #ifndef D_DCF77Demod_h */
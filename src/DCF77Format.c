@@ -0,0 +1,359 @@
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DCF77Format.h"
+
+enum {
+	OP_TEXT,
+	OP_NUM2,	/* two digits of a field, 'arg' pads */
+	OP_NUM1,	/* a digit of a field */
+	OP_YDAY,	/* three digits */
+	OP_YEAR,
+	OP_WDAY_ABBR,
+	OP_WDAY_NAME,
+	OP_MON_ABBR,
+	OP_MON_NAME,
+	OP_AMPM,
+	OP_ZONE,
+	OP_GMTOFF
+};
+
+/* fields of OP_NUM2 and OP_NUM1 */
+enum {
+	F_MDAY,
+	F_MON,
+	F_HOUR,
+	F_HOUR12,
+	F_MIN,
+	F_SEC,
+	F_YEAR2,
+	F_CENTURY,
+	F_WDAY,
+	F_WDAY1,	/* Monday is 1, Sunday 7 */
+	F_QTY
+};
+
+/* the longest conversion rendered in place: %Y of a long year */
+#define OP_LEN_MAX	24
+
+#define PAD_ZERO	0
+#define PAD_SPACE	1
+
+static const char twoDigits[200] =
+	"00010203040506070809" "10111213141516171819"
+	"20212223242526272829" "30313233343536373839"
+	"40414243444546474849" "50515253545556575859"
+	"60616263646566676869" "70717273747576777879"
+	"80818283848586878889" "90919293949596979899";
+
+static const char * const wdayNames[7] = {
+	"Sunday", "Monday", "Tuesday", "Wednesday",
+	"Thursday", "Friday", "Saturday"
+};
+
+static const char * const monNames[12] = {
+	"January", "February", "March", "April", "May", "June",
+	"July", "August", "September", "October", "November", "December"
+};
+
+/*
+ * Returns 0 when the format does not fit in.
+ */
+static int
+addOp(DCF77Format_t * pFormat, unsigned code, unsigned arg)
+{
+	DCF77FormatOp_t * pOp;
+
+	if (pFormat->opsQty >= DCF77FORMAT_OPS_MAX)
+		return 0;
+
+	pOp = &pFormat->ops[pFormat->opsQty++];
+	pOp->code = (uint8_t)code;
+	pOp->arg = (uint8_t)arg;
+	pOp->pos = 0;
+	pOp->len = 0;
+
+	return 1;
+}
+
+static int
+addText(DCF77Format_t * pFormat, const char * text, size_t len)
+{
+	DCF77FormatOp_t * pLast = NULL;
+
+	if (pFormat->textLen + len > DCF77FORMAT_TEXT_MAX)
+		return 0;
+
+	/* consecutive text makes a single step */
+	if (0 != pFormat->opsQty) {
+		pLast = &pFormat->ops[pFormat->opsQty - 1];
+		if (OP_TEXT != pLast->code)
+			pLast = NULL;
+	}
+	if (NULL == pLast) {
+		if (!addOp(pFormat, OP_TEXT, 0))
+			return 0;
+		pLast = &pFormat->ops[pFormat->opsQty - 1];
+		pLast->pos = (uint16_t)pFormat->textLen;
+	}
+
+	memcpy(&pFormat->text[pFormat->textLen], text, len);
+	pFormat->textLen += len;
+	pLast->len = (uint16_t)(pLast->len + len);
+
+	return 1;
+}
+
+static int compileFormat(DCF77Format_t * pFormat, const char * fmt,
+	int isCLocale);
+
+/*
+ * Returns 0 for a conversion left to strftime(3).
+ */
+static int
+compileConversion(DCF77Format_t * pFormat, char conv, int isCLocale)
+{
+	switch (conv) {
+	case 'd': return addOp(pFormat, OP_NUM2, F_MDAY << 1 | PAD_ZERO);
+	case 'e': return addOp(pFormat, OP_NUM2, F_MDAY << 1 | PAD_SPACE);
+	case 'm': return addOp(pFormat, OP_NUM2, F_MON << 1 | PAD_ZERO);
+	case 'H': return addOp(pFormat, OP_NUM2, F_HOUR << 1 | PAD_ZERO);
+	case 'k': return addOp(pFormat, OP_NUM2, F_HOUR << 1 | PAD_SPACE);
+	case 'I': return addOp(pFormat, OP_NUM2, F_HOUR12 << 1 | PAD_ZERO);
+	case 'l': return addOp(pFormat, OP_NUM2, F_HOUR12 << 1 | PAD_SPACE);
+	case 'M': return addOp(pFormat, OP_NUM2, F_MIN << 1 | PAD_ZERO);
+	case 'S': return addOp(pFormat, OP_NUM2, F_SEC << 1 | PAD_ZERO);
+	case 'y': return addOp(pFormat, OP_NUM2, F_YEAR2 << 1 | PAD_ZERO);
+	case 'C': return addOp(pFormat, OP_NUM2, F_CENTURY << 1 | PAD_ZERO);
+	case 'w': return addOp(pFormat, OP_NUM1, F_WDAY);
+	case 'u': return addOp(pFormat, OP_NUM1, F_WDAY1);
+	case 'j': return addOp(pFormat, OP_YDAY, 0);
+	case 'Y': return addOp(pFormat, OP_YEAR, 0);
+	case 'Z': return addOp(pFormat, OP_ZONE, 0);
+	case 'z': return addOp(pFormat, OP_GMTOFF, 0);
+	case 'n': return addText(pFormat, "\n", 1);
+	case 't': return addText(pFormat, "\t", 1);
+	case '%': return addText(pFormat, "%", 1);
+	case 'D': return compileFormat(pFormat, "%m/%d/%y", isCLocale);
+	case 'F': return compileFormat(pFormat, "%Y-%m-%d", isCLocale);
+	case 'R': return compileFormat(pFormat, "%H:%M", isCLocale);
+	case 'T': return compileFormat(pFormat, "%H:%M:%S", isCLocale);
+	default: break;
+	}
+
+	/* the rest depends on LC_TIME */
+	if (!isCLocale)
+		return 0;
+
+	switch (conv) {
+	case 'a': return addOp(pFormat, OP_WDAY_ABBR, 0);
+	case 'A': return addOp(pFormat, OP_WDAY_NAME, 0);
+	case 'b': /* FALLTHROUGH */
+	case 'h': return addOp(pFormat, OP_MON_ABBR, 0);
+	case 'B': return addOp(pFormat, OP_MON_NAME, 0);
+	case 'p': return addOp(pFormat, OP_AMPM, 0);
+	case 'c': return compileFormat(pFormat, "%a %b %e %H:%M:%S %Y",
+		      isCLocale);
+	case 'r': return compileFormat(pFormat, "%I:%M:%S %p", isCLocale);
+	case 'x': return compileFormat(pFormat, "%m/%d/%y", isCLocale);
+	case 'X': return compileFormat(pFormat, "%H:%M:%S", isCLocale);
+	default: return 0;
+	}
+}
+
+static int
+compileFormat(DCF77Format_t * pFormat, const char * fmt, int isCLocale)
+{
+	const char * p;
+
+	while ('\0' != *fmt) {
+		for (p = fmt; '\0' != *p && '%' != *p; ++p) {
+			;
+		}
+		if (p != fmt && !addText(pFormat, fmt, (size_t)(p - fmt)))
+			return 0;
+		if ('\0' == *p)
+			break;
+
+		if ('\0' == p[1] || !compileConversion(pFormat, p[1], isCLocale))
+			return 0;
+		fmt = p + 2;
+	}
+
+	return 1;
+}
+
+void
+DCF77Format_Compile(DCF77Format_t * pFormat, const char * fmt)
+{
+	const char * locale = setlocale(LC_TIME, NULL);
+	int isCLocale = (NULL == locale || 0 == strcmp(locale, "C") ||
+	    0 == strcmp(locale, "POSIX"));
+
+	memset(pFormat, 0, sizeof(*pFormat));
+	pFormat->fmt = fmt;
+
+	/* strftime(3) does so for %Z */
+	tzset();
+
+	pFormat->isNative = compileFormat(pFormat, fmt, isCLocale);
+}
+
+static void
+getFields(const struct tm * pStm, unsigned fields[F_QTY])
+{
+	int year = pStm->tm_year + 1900;
+
+	fields[F_MDAY]    = (unsigned)pStm->tm_mday;
+	fields[F_MON]     = (unsigned)(pStm->tm_mon + 1);
+	fields[F_HOUR]    = (unsigned)pStm->tm_hour;
+	fields[F_HOUR12]  = (unsigned)((pStm->tm_hour + 11) % 12 + 1);
+	fields[F_MIN]     = (unsigned)pStm->tm_min;
+	fields[F_SEC]     = (unsigned)pStm->tm_sec;
+	fields[F_YEAR2]   = (unsigned)(year % 100);
+	fields[F_CENTURY] = (unsigned)(year / 100);
+	fields[F_WDAY]    = (unsigned)pStm->tm_wday;
+	fields[F_WDAY1]   = (0 == pStm->tm_wday) ? 7u : fields[F_WDAY];
+}
+
+static size_t
+putUnsigned(char * dst, unsigned long v)
+{
+	char digits[24];
+	size_t n = 0, i;
+
+	do {
+		digits[n++] = (char)('0' + v % 10);
+		v /= 10;
+	} while (0 != v);
+
+	for (i = 0; i < n; ++i) {
+		dst[i] = digits[n - 1 - i];
+	}
+
+	return n;
+}
+
+static const char *
+nameOf(const char * const names[], unsigned qty, int idx)
+{
+	return ((unsigned)idx < qty) ? names[idx] : "?";
+}
+
+/*
+ * Like strftime(3): returns the length rendered, or 0 if it does not
+ * fit into 'bufSz' along with the terminating NUL.  Short conversions
+ * go straight into 'buf' while there is room for the longest of them.
+ */
+size_t
+DCF77Format_Render(const DCF77Format_t * pFormat, const struct tm * pStm,
+	char * buf, size_t bufSz)
+{
+	unsigned fields[F_QTY];
+	char tmp[OP_LEN_MAX];
+	const char * src;
+	size_t i, len, at = 0;
+
+	if (!pFormat->isNative)
+		return strftime(buf, bufSz, pFormat->fmt, pStm);
+
+	getFields(pStm, fields);
+
+	for (i = 0; i < pFormat->opsQty; ++i) {
+		const DCF77FormatOp_t * pOp = &pFormat->ops[i];
+		char * dst = (bufSz - at > OP_LEN_MAX) ? &buf[at] : tmp;
+		unsigned v;
+		long off;
+
+		src = NULL;
+		switch (pOp->code) {
+		case OP_TEXT:
+			src = &pFormat->text[pOp->pos];
+			len = pOp->len;
+			break;
+		case OP_NUM2:
+			v = fields[pOp->arg >> 1] % 100;
+			dst[0] = ((pOp->arg & PAD_SPACE) && v < 10) ?
+			    ' ' : twoDigits[2 * v];
+			dst[1] = twoDigits[2 * v + 1];
+			len = 2;
+			break;
+		case OP_NUM1:
+			dst[0] = (char)('0' + fields[pOp->arg] % 10);
+			len = 1;
+			break;
+		case OP_YDAY:
+			v = (unsigned)(pStm->tm_yday + 1) % 1000;
+			dst[0] = (char)('0' + v / 100);
+			dst[1] = twoDigits[2 * (v % 100)];
+			dst[2] = twoDigits[2 * (v % 100) + 1];
+			len = 3;
+			break;
+		case OP_YEAR:
+			len = putUnsigned(dst,
+			    (unsigned long)(pStm->tm_year + 1900L));
+			break;
+		case OP_WDAY_ABBR:
+			src = nameOf(wdayNames, 7, pStm->tm_wday);
+			len = ('?' == *src) ? 1 : 3;
+			break;
+		case OP_WDAY_NAME:
+			src = nameOf(wdayNames, 7, pStm->tm_wday);
+			len = strlen(src);
+			break;
+		case OP_MON_ABBR:
+			src = nameOf(monNames, 12, pStm->tm_mon);
+			len = ('?' == *src) ? 1 : 3;
+			break;
+		case OP_MON_NAME:
+			src = nameOf(monNames, 12, pStm->tm_mon);
+			len = strlen(src);
+			break;
+		case OP_AMPM:
+			dst[0] = (pStm->tm_hour < 12) ? 'A' : 'P';
+			dst[1] = 'M';
+			len = 2;
+			break;
+		case OP_ZONE:
+			src = pStm->tm_zone;
+			if (NULL == src || '\0' == *src) {
+				src = tzname[0 != pStm->tm_isdst];
+			}
+			len = strlen(src);
+			break;
+		case OP_GMTOFF:
+			off = pStm->tm_gmtoff / 60;
+			dst[0] = (off < 0) ? '-' : '+';
+			off = labs(off);
+			v = (unsigned)(off / 60 % 100);
+			dst[1] = twoDigits[2 * v];
+			dst[2] = twoDigits[2 * v + 1];
+			v = (unsigned)(off % 60);
+			dst[3] = twoDigits[2 * v];
+			dst[4] = twoDigits[2 * v + 1];
+			len = 5;
+			break;
+		default:
+			len = 0;
+			break;
+		}
+
+		if (NULL == src && tmp != dst) {
+			at += len;
+			continue;
+		}
+		if (NULL == src) {
+			src = tmp;
+		}
+		if (at + len >= bufSz)
+			return 0;
+		memcpy(&buf[at], src, len);
+		at += len;
+	}
+
+	if (at >= bufSz)
+		return 0;
+	buf[at] = '\0';
+
+	return at;
+}
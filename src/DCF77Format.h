@@ -0,0 +1,39 @@
+#ifndef D_DCF77Format_h
+#define D_DCF77Format_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * A strftime(3) format parsed once into rendering steps.  Conversions of
+ * the C locale are rendered right from struct tm; a format with anything
+ * else (E/O modifiers, flags and widths, week numbers, %s, or names
+ * under another LC_TIME locale) is left to strftime(3) as a whole.
+ */
+enum {
+	DCF77FORMAT_OPS_MAX = 64,
+	DCF77FORMAT_TEXT_MAX = 128
+};
+
+typedef struct {
+	uint8_t		 code;
+	uint8_t		 arg;
+	uint16_t	 pos;		/* literal text: within 'text' */
+	uint16_t	 len;
+} DCF77FormatOp_t;
+
+typedef struct {
+	const char	*fmt;
+	int		 isNative;
+	size_t		 opsQty;
+	size_t		 textLen;
+	DCF77FormatOp_t	 ops[DCF77FORMAT_OPS_MAX];
+	char		 text[DCF77FORMAT_TEXT_MAX];
+} DCF77Format_t;
+
+void DCF77Format_Compile(DCF77Format_t * pFormat, const char * fmt);
+size_t DCF77Format_Render(const DCF77Format_t * pFormat,
+	const struct tm * pStm, char * buf, size_t bufSz);
+
+#endif /* #ifndef D_DCF77Format_h */
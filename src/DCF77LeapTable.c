@@ -0,0 +1,136 @@
+#include <err.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77LeapTable.h"
+
+/* seconds from 1900-01-01 (NTP era 0) to 1970-01-01 */
+#define NTP_TO_UNIX	2208988800LL
+
+static int
+compareLeaps(const void * a, const void * b)
+{
+	time_t l = ((const DCF77Leap_t *)a)->at;
+	time_t r = ((const DCF77Leap_t *)b)->at;
+
+	return (l > r) - (l < r);
+}
+
+/*
+ * Reads a leap-seconds.list as published by IERS/NIST (and shipped with
+ * tzdata): lines of NTP time and TAI - UTC in effect from then on, '#@'
+ * giving the expiry, other '#' lines being comments.  The first line
+ * only sets the offset, every following one must add a second to it.
+ */
+void
+DCF77LeapTable_Load(DCF77LeapTable_t * pTable, const char * path)
+{
+	FILE * in;
+	char line[256];
+	unsigned lineNo = 0;
+	size_t qty = 0, i;
+
+	memset(pTable, 0, sizeof(*pTable));
+
+	in = fopen(path, "r");
+	if (NULL == in) {
+		err(EX_NOINPUT, "%s", path);
+		/* NOTREACHED */
+	}
+
+	while (NULL != fgets(line, sizeof(line), in)) {
+		DCF77Leap_t * pLeap = &pTable->leaps[qty];
+		char * end;
+		long long ntp;
+
+		++lineNo;
+		if ('#' == line[0] && '@' == line[1]) {
+			ntp = strtoll(&line[2], &end, 10);
+			pTable->expires = (time_t)(ntp - NTP_TO_UNIX);
+			continue;
+		}
+		if ('#' == line[0] || '\0' == line[strspn(line, " \t\r\n")])
+			continue;
+
+		if (DCF77LEAPTABLE_MAX_LEAPS == qty) {
+			errx(EX_DATAERR, "%s: more than %d leap seconds", path,
+			    DCF77LEAPTABLE_MAX_LEAPS - 1);
+			/* NOTREACHED */
+		}
+		errno = 0;
+		ntp = strtoll(line, &end, 10);
+		pLeap->taiOffset = (int)strtol(end, &end, 10);
+		if (0 != errno || ntp <= NTP_TO_UNIX || pLeap->taiOffset <= 0 ||
+		    NULL == strchr(" \t\r\n#", *end)) {
+			errx(EX_DATAERR, "%s:%u: bad line", path, lineNo);
+			/* NOTREACHED */
+		}
+		pLeap->at = (time_t)(ntp - NTP_TO_UNIX);
+		++qty;
+	}
+	if (ferror(in)) {
+		err(EX_IOERR, "%s", path);
+		/* NOTREACHED */
+	}
+	fclose(in);
+
+	if (0u == qty) {
+		errx(EX_DATAERR, "%s: no leap seconds", path);
+		/* NOTREACHED */
+	}
+
+	/* the first entry is the offset the list starts with */
+	qsort(pTable->leaps, qty, sizeof(pTable->leaps[0]), compareLeaps);
+	for (i = 1; i < qty; ++i) {
+		if (pTable->leaps[i].taiOffset != pTable->leaps[i - 1].taiOffset
+		    + 1) {
+			errx(EX_DATAERR, "%s: only single positive leap "
+			    "seconds are supported", path);
+			/* NOTREACHED */
+		}
+	}
+	pTable->qty = qty - 1;
+	memmove(&pTable->leaps[0], &pTable->leaps[1],
+	    pTable->qty * sizeof(pTable->leaps[0]));
+}
+
+/*
+ * Finds the earliest leap second ending at 't' or later.
+ */
+const DCF77Leap_t *
+DCF77LeapTable_NextLeap(const DCF77LeapTable_t * pTable, time_t t)
+{
+	size_t lo = 0u, hi;
+
+	if (NULL == pTable)
+		return NULL;
+
+	hi = pTable->qty;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (pTable->leaps[mid].at < t) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return (lo < pTable->qty) ? &pTable->leaps[lo] : NULL;
+}
+
+/*
+ * True for the blocks (of the UTC minute starting at 'minute') sent
+ * during the hour before a leap second, the last of them being the one
+ * sent in the minute it is inserted into.
+ */
+int
+DCF77LeapTable_Announced(const DCF77LeapTable_t * pTable, time_t minute)
+{
+	const DCF77Leap_t * pLeap = DCF77LeapTable_NextLeap(pTable, minute);
+
+	return (NULL != pLeap &&
+	    pLeap->at - minute < DCF77LEAPTABLE_ANNOUNCE_SECONDS);
+}
@@ -0,0 +1,32 @@
+#ifndef D_DCF77LeapTable_h
+#define D_DCF77LeapTable_h
+
+#include <stddef.h>
+#include <time.h>
+
+enum {
+	DCF77LEAPTABLE_MAX_LEAPS = 128,
+	DCF77LEAPTABLE_ANNOUNCE_SECONDS = 60 * 60
+};
+
+/*
+ * A second inserted at the end of the UTC day before 'at'.
+ */
+typedef struct {
+	time_t	at;		/* the first second after it */
+	int	taiOffset;	/* TAI - UTC from then on, seconds */
+} DCF77Leap_t;
+
+typedef struct {
+	size_t		qty;
+	time_t		expires;	/* 0 when the file does not tell */
+	DCF77Leap_t	leaps[DCF77LEAPTABLE_MAX_LEAPS];
+} DCF77LeapTable_t;
+
+void DCF77LeapTable_Load(DCF77LeapTable_t * pTable, const char * path);
+const DCF77Leap_t * DCF77LeapTable_NextLeap(const DCF77LeapTable_t * pTable,
+	time_t t);
+int DCF77LeapTable_Announced(const DCF77LeapTable_t * pTable,
+	time_t minute);
+
+#endif /* #ifndef D_DCF77LeapTable_h */
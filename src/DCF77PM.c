@@ -0,0 +1,94 @@
+#include "DCF77PM.h"
+#include "DCF77TimeCodePrivate.h"
+
+/*
+ * 511 chips of the 9-stage shift register with feedback taps at stages
+ * 5 and 9 (x^9 + x^5 + 1), all stages set to 1 at the start, the output
+ * taken from stage 9; the 512th chip is a 0, balancing the sequence.
+ */
+static const uint64_t prnChips[DCF77PM_CHIP_WORDS] = {
+	UINT64_C(0x8B72904CE8FBC1FF), UINT64_C(0x2323AB638951B3E7),
+	UINT64_C(0x3B2F61AA72188402), UINT64_C(0xCAC9FB4937E5A851),
+	UINT64_C(0x9AE345FD2C53180C), UINT64_C(0xBEB41BB6B05DF1E6),
+	UINT64_C(0x5E4B9C0EE9EA502A), UINT64_C(0x07B859B7A1CC2457)
+};
+
+unsigned
+DCF77PM_BitOfSecond(const DCF77Block_t * pBlock, unsigned second)
+{
+	if (second >= DCF77TIMECODE_BITS_QTY - 1)
+		return 0;
+
+	return (pBlock->data[second / 8] >> (second % 8)) & 1u;
+}
+
+void
+DCF77PM_SecondChips(unsigned bit, uint64_t chips[DCF77PM_CHIP_WORDS])
+{
+	uint64_t invert = (uint64_t)0 - (uint64_t)(bit & 1u);
+	int i;
+
+	for (i = 0; i < DCF77PM_CHIP_WORDS; ++i) {
+		chips[i] = prnChips[i] ^ invert;
+	}
+}
+
+/*
+ * Chips of the 60 seconds the block is sent in.
+ */
+void
+DCF77PM_MinuteChips(const DCF77Block_t * pBlock,
+	uint64_t chips[][DCF77PM_CHIP_WORDS])
+{
+	unsigned second;
+
+	for (second = 0; second < DCF77TIMECODE_BITS_QTY; ++second) {
+		DCF77PM_SecondChips(DCF77PM_BitOfSecond(pBlock, second),
+		    chips[second]);
+	}
+}
+
+/*
+ * Chip being sent at sample 'sample' of a second, -1 outside of the
+ * sequence.  Whole numbers only, so chip edges land on the same samples
+ * in every second.
+ */
+int
+DCF77PM_ChipAt(uint64_t sample, unsigned sampleRate)
+{
+	uint64_t at = sample * DCF77PM_CARRIER_HZ;
+	uint64_t start = (uint64_t)sampleRate *
+	    (DCF77PM_CARRIER_HZ * DCF77PM_START_MS / 1000);
+	uint64_t chip;
+
+	if (at < start)
+		return -1;
+
+	chip = (at - start) / ((uint64_t)sampleRate * DCF77PM_CYCLES_PER_CHIP);
+
+	return (chip < DCF77PM_CHIPS_QTY) ? (int)chip : -1;
+}
+
+/*
+ * A second of baseband: +1 for a 0 chip, -1 for a 1 chip (its phase
+ * deviation is negative), 0 while the carrier is not modulated.
+ */
+void
+DCF77PM_RenderBaseband(unsigned bit, unsigned sampleRate, float samples[])
+{
+	uint64_t chips[DCF77PM_CHIP_WORDS];
+	unsigned n;
+
+	DCF77PM_SecondChips(bit, chips);
+
+	for (n = 0; n < sampleRate; ++n) {
+		int chip = DCF77PM_ChipAt(n, sampleRate);
+
+		if (chip < 0) {
+			samples[n] = 0.0f;
+		} else {
+			samples[n] = ((chips[chip / 64] >> (chip % 64)) & 1u) ?
+			    -1.0f : 1.0f;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef D_DCF77PM_h
+#define D_DCF77PM_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+/*
+ * Phase modulation of the DCF77 carrier: in every second, 200 ms after
+ * its start, 512 chips of a pseudo-random sequence follow, each lasting
+ * 120 carrier cycles (1.548 ms).  The sequence is sent as is for a 0 bit
+ * of the timecode and inverted for a 1 bit; second 59 (and 60 of a
+ * minute with a leap second) carries a 0.
+ *
+ * Chip N of a second is bit N % 64 of word N / 64.
+ */
+enum {
+	DCF77PM_CHIPS_QTY = 512,
+	DCF77PM_CHIP_WORDS = DCF77PM_CHIPS_QTY / 64,
+	DCF77PM_START_MS = 200,
+	DCF77PM_CARRIER_HZ = 77500,
+	DCF77PM_CYCLES_PER_CHIP = 120
+};
+
+/* of the DCF77 carrier, degrees */
+#define DCF77PM_DEVIATION_DEGREES	15.6
+
+unsigned DCF77PM_BitOfSecond(const DCF77Block_t * pBlock, unsigned second);
+void DCF77PM_SecondChips(unsigned bit, uint64_t chips[DCF77PM_CHIP_WORDS]);
+void DCF77PM_MinuteChips(const DCF77Block_t * pBlock,
+	uint64_t chips[][DCF77PM_CHIP_WORDS]);
+int DCF77PM_ChipAt(uint64_t sample, unsigned sampleRate);
+void DCF77PM_RenderBaseband(unsigned bit, unsigned sampleRate,
+	float samples[]);
+
+#endif /* #ifndef D_DCF77PM_h */
@@ -0,0 +1,402 @@
+#include <err.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77PM.h"
+#include "DCF77PMRx.h"
+
+#define PMRX_LANES		8	/* independent sums, for SIMD */
+#define PMRX_ACQ_SECONDS	3	/* correlated to find the chips */
+#define PMRX_LOST_SECONDS	8	/* missed in a row to search again */
+#define PMRX_PRESENT_MIN	0.1f	/* normalized correlation */
+#define PMRX_TRACK_HZ		4000	/* lags tracked: a quarter of a ms */
+#define PMRX_REF_HZ		10.0f	/* bandwidth of the I/Q reference */
+#define PMRX_IQ_CHUNK		4096
+
+static void *
+allocFloats(size_t qty)
+{
+	void * p = calloc(qty, sizeof(float));
+
+	if (NULL == p) {
+		err(EX_OSERR, "no memory for %zu samples", qty);
+		/* NOTREACHED */
+	}
+
+	return p;
+}
+
+/*
+ * In-place radix-2 FFT of fftLen points, e^-i for the forward transform;
+ * the inverse one is left unscaled.
+ */
+static void
+fft(const DCF77PMRx_t * pRx, float * re, float * im, int isInverse)
+{
+	size_t n = pRx->fftLen;
+	size_t i, j, k, len;
+
+	for (i = 1, j = 0; i < n; ++i) {
+		size_t bit = n >> 1;
+
+		for (; 0u != (j & bit); bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			float t = re[i]; re[i] = re[j]; re[j] = t;
+			t = im[i]; im[i] = im[j]; im[j] = t;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		size_t half = len / 2, step = n / len;
+
+		for (i = 0; i < n; i += len) {
+			for (k = 0; k < half; ++k) {
+				float wr = pRx->twCos[k * step];
+				float wi = isInverse ? pRx->twSin[k * step] :
+				    -pRx->twSin[k * step];
+				size_t a = i + k, b = a + half;
+				float tr = re[b] * wr - im[b] * wi;
+				float ti = re[b] * wi + im[b] * wr;
+
+				re[b] = re[a] - tr;
+				im[b] = im[a] - ti;
+				re[a] += tr;
+				im[a] += ti;
+			}
+		}
+	}
+}
+
+void
+DCF77PMRx_Init(DCF77PMRx_t * pRx, unsigned sampleRate,
+	DCF77PMRxSecondFn_t onSecond, void * ctx)
+{
+	float * second;
+	size_t n;
+
+	if (sampleRate < 1000 || sampleRate > 1000000) {
+		errx(EX_DATAERR, "PM sample rate out of 1000..1000000 Hz");
+		/* NOTREACHED */
+	}
+
+	memset(pRx, 0, sizeof(*pRx));
+	pRx->sampleRate = sampleRate;
+	pRx->onSecond = onSecond;
+	pRx->ctx = ctx;
+	pRx->refI = 1.0f;
+
+	/* the chips of a second run without a gap */
+	second = allocFloats(sampleRate);
+	DCF77PM_RenderBaseband(0, sampleRate, second);
+	for (n = 0; n < sampleRate; ++n) {
+		if (DCF77PM_ChipAt(n, sampleRate) < 0)
+			continue;
+		if (0u == pRx->tmplLen) {
+			pRx->tmplAt = n;
+		}
+		++pRx->tmplLen;
+		pRx->tmplSum += second[n];
+	}
+	pRx->tmpl = allocFloats(pRx->tmplLen);
+	memcpy(pRx->tmpl, &second[pRx->tmplAt],
+	    pRx->tmplLen * sizeof(float));
+	free(second);
+
+	/* two seconds correlate linearly, without wrapping around */
+	for (pRx->fftLen = 1; pRx->fftLen < 2 * (size_t)sampleRate; ) {
+		pRx->fftLen <<= 1;
+	}
+	pRx->twCos = allocFloats(pRx->fftLen / 2);
+	pRx->twSin = allocFloats(pRx->fftLen / 2);
+	for (n = 0; n < pRx->fftLen / 2; ++n) {
+		double angle = 2.0 * M_PI * (double)n / (double)pRx->fftLen;
+
+		pRx->twCos[n] = (float)cos(angle);
+		pRx->twSin[n] = (float)sin(angle);
+	}
+	pRx->tmplRe = allocFloats(pRx->fftLen);
+	pRx->tmplIm = allocFloats(pRx->fftLen);
+	memcpy(pRx->tmplRe, pRx->tmpl, pRx->tmplLen * sizeof(float));
+	fft(pRx, pRx->tmplRe, pRx->tmplIm, 0);
+	pRx->re = allocFloats(pRx->fftLen);
+	pRx->im = allocFloats(pRx->fftLen);
+	pRx->score = allocFloats(sampleRate);
+
+	pRx->track = sampleRate / PMRX_TRACK_HZ;
+	if (pRx->track < 2u) {
+		pRx->track = 2u;
+	}
+	pRx->corr = allocFloats(2 * pRx->track + 1);
+
+	pRx->bufCap = (PMRX_ACQ_SECONDS + 2) * (size_t)sampleRate;
+	pRx->buf = allocFloats(pRx->bufCap);
+}
+
+void
+DCF77PMRx_Free(DCF77PMRx_t * pRx)
+{
+	free(pRx->tmpl);
+	free(pRx->twCos);
+	free(pRx->twSin);
+	free(pRx->tmplRe);
+	free(pRx->tmplIm);
+	free(pRx->re);
+	free(pRx->im);
+	free(pRx->score);
+	free(pRx->corr);
+	free(pRx->buf);
+	memset(pRx, 0, sizeof(*pRx));
+}
+
+/*
+ * Lanes keep the additions independent, so the compiler may run them in
+ * vector registers without reassociating float math.
+ */
+static float
+dot(const float * x, const float * y, size_t qty)
+{
+	float lanes[PMRX_LANES] = { 0.0f };
+	float sum = 0.0f;
+	size_t i, k;
+
+	for (i = 0; i + PMRX_LANES <= qty; i += PMRX_LANES) {
+		for (k = 0; k < PMRX_LANES; ++k) {
+			lanes[k] += x[i + k] * y[i + k];
+		}
+	}
+	for (; i < qty; ++i) {
+		sum += x[i] * y[i];
+	}
+	for (k = 0; k < PMRX_LANES; ++k) {
+		sum += lanes[k];
+	}
+
+	return sum;
+}
+
+static void
+sumAndSquares(const float * x, size_t qty, float * pSum, float * pSquares)
+{
+	float sums[PMRX_LANES] = { 0.0f }, squares[PMRX_LANES] = { 0.0f };
+	size_t i, k;
+
+	*pSum = *pSquares = 0.0f;
+	for (i = 0; i + PMRX_LANES <= qty; i += PMRX_LANES) {
+		for (k = 0; k < PMRX_LANES; ++k) {
+			sums[k] += x[i + k];
+			squares[k] += x[i + k] * x[i + k];
+		}
+	}
+	for (; i < qty; ++i) {
+		*pSum += x[i];
+		*pSquares += x[i] * x[i];
+	}
+	for (k = 0; k < PMRX_LANES; ++k) {
+		*pSum += sums[k];
+		*pSquares += squares[k];
+	}
+}
+
+/*
+ * Each of the first seconds kept, with the one after it, is correlated
+ * against the chips through the FFT; magnitudes (bits flip the sign)
+ * add up over the seconds at every lag, and the highest sum tells where
+ * the chips start.
+ */
+static void
+acquire(DCF77PMRx_t * pRx)
+{
+	size_t rate = pRx->sampleRate;
+	size_t w, k, lag = 0;
+
+	memset(pRx->score, 0, rate * sizeof(float));
+	for (w = 0; w < PMRX_ACQ_SECONDS; ++w) {
+		const float * x = &pRx->buf[w * rate];
+		float sum, squares, mean;
+
+		sumAndSquares(x, 2 * rate, &sum, &squares);
+		mean = sum / (float)(2 * rate);
+		for (k = 0; k < pRx->fftLen; ++k) {
+			pRx->re[k] = (k < 2 * rate) ? x[k] - mean : 0.0f;
+			pRx->im[k] = 0.0f;
+		}
+		fft(pRx, pRx->re, pRx->im, 0);
+		for (k = 0; k < pRx->fftLen; ++k) {
+			float a = pRx->re[k], b = pRx->im[k];
+			float c = pRx->tmplRe[k], d = pRx->tmplIm[k];
+
+			pRx->re[k] = a * c + b * d;
+			pRx->im[k] = b * c - a * d;
+		}
+		fft(pRx, pRx->re, pRx->im, 1);
+		for (k = 0; k < rate; ++k) {
+			pRx->score[k] += fabsf(pRx->re[k]);
+		}
+	}
+	for (k = 1; k < rate; ++k) {
+		if (pRx->score[k] > pRx->score[lag]) {
+			lag = k;
+		}
+	}
+
+	/* lags before the first one tracked wait for the next second */
+	if (lag < pRx->track) {
+		lag += rate;
+	}
+	pRx->isLocked = 1;
+	pRx->missQty = 0;
+	pRx->nextChips = (double)(pRx->bufAt + lag);
+}
+
+/*
+ * Matches the second due against the chips at lags around it.  The
+ * correlation of rectangular chips peaks in a triangle, so its top lies
+ * where lines through the best lag and its lower neighbour meet.
+ * Returns 0 while samples of the second are still to come.
+ */
+static int
+trackSecond(DCF77PMRx_t * pRx)
+{
+	DCF77PMRxSecond_t second;
+	size_t track = pRx->track;
+	size_t base = (size_t)(pRx->nextChips + 0.5 - (double)pRx->bufAt);
+	const float * x = &pRx->buf[base - track];
+	float sum, squares, mean, norm;
+	size_t d, best = 0;
+	double at;
+
+	if (base + track + pRx->tmplLen > pRx->bufLen)
+		return 0;
+
+	sumAndSquares(&pRx->buf[base], pRx->tmplLen, &sum, &squares);
+	mean = sum / (float)pRx->tmplLen;
+	norm = sqrtf(fmaxf(squares - sum * mean, 0.0f) *
+	    (float)pRx->tmplLen);
+
+	for (d = 0; d <= 2 * track; ++d) {
+		pRx->corr[d] = dot(&x[d], pRx->tmpl, pRx->tmplLen) -
+		    mean * pRx->tmplSum;
+		if (fabsf(pRx->corr[d]) > fabsf(pRx->corr[best])) {
+			best = d;
+		}
+	}
+
+	second.quality = (norm > 0.0f) ? fabsf(pRx->corr[best]) / norm : 0.0f;
+	second.isPresent = (second.quality >= PMRX_PRESENT_MIN);
+	second.bit = (pRx->corr[best] < 0.0f) ? 1u : 0u;
+
+	if (second.isPresent) {
+		double frac = 0.0;
+
+		if (best > 0 && best < 2 * track) {
+			float a = fabsf(pRx->corr[best - 1]);
+			float b = fabsf(pRx->corr[best]);
+			float g = fabsf(pRx->corr[best + 1]);
+			float low = fminf(a, g);
+
+			if (b > low) {
+				frac = (double)(g - a) / (2.0 * (b - low));
+			}
+		}
+		at = (double)(pRx->bufAt + base - track + best) + frac;
+		pRx->nextChips = at + pRx->sampleRate;
+		pRx->missQty = 0;
+	} else {
+		at = pRx->nextChips;
+		pRx->nextChips += pRx->sampleRate;
+		if (++pRx->missQty >= PMRX_LOST_SECONDS) {
+			pRx->isLocked = 0;
+		}
+	}
+
+	second.start = at - (double)pRx->tmplAt;
+	pRx->onSecond(pRx->ctx, &second);
+
+	return 1;
+}
+
+static void
+process(DCF77PMRx_t * pRx)
+{
+	double keep;
+	size_t drop;
+
+	for (;;) {
+		if (!pRx->isLocked) {
+			if (pRx->bufLen < (PMRX_ACQ_SECONDS + 1) *
+			    (size_t)pRx->sampleRate)
+				break;
+			acquire(pRx);
+		}
+		if (!trackSecond(pRx))
+			break;
+	}
+
+	/* what the seconds due are matched in stays */
+	keep = pRx->nextChips - (double)pRx->track - 1.0 -
+	    (double)pRx->bufAt;
+	drop = (keep <= 0.0) ? 0u : (keep >= (double)pRx->bufLen) ?
+	    pRx->bufLen : (size_t)keep;
+	if (0u != drop) {
+		memmove(pRx->buf, &pRx->buf[drop],
+		    (pRx->bufLen - drop) * sizeof(float));
+		pRx->bufLen -= drop;
+		pRx->bufAt += drop;
+	}
+}
+
+/*
+ * Phase samples, radians off the carrier (any constant offset goes).
+ */
+void
+DCF77PMRx_Push(DCF77PMRx_t * pRx, const float * phase, size_t qty)
+{
+	size_t i = 0;
+
+	while (i < qty) {
+		size_t take = pRx->bufCap - pRx->bufLen;
+
+		if (take > qty - i) {
+			take = qty - i;
+		}
+		memcpy(&pRx->buf[pRx->bufLen], &phase[i],
+		    take * sizeof(float));
+		pRx->bufLen += take;
+		i += take;
+
+		process(pRx);
+	}
+}
+
+/*
+ * Interleaved I/Q pairs: the phase is taken against their running mean,
+ * which the balanced chips leave at the carrier's own phase; the carrier
+ * may thus drift off frequency by a fraction of PMRX_REF_HZ.
+ */
+void
+DCF77PMRx_PushIQ(DCF77PMRx_t * pRx, const float * iq, size_t pairs)
+{
+	float phase[PMRX_IQ_CHUNK];
+	float alpha = PMRX_REF_HZ / (float)pRx->sampleRate;
+	size_t i = 0, k;
+
+	while (i < pairs) {
+		size_t take = (pairs - i < PMRX_IQ_CHUNK) ? pairs - i :
+		    PMRX_IQ_CHUNK;
+
+		for (k = 0; k < take; ++k) {
+			float I = iq[2 * (i + k)], Q = iq[2 * (i + k) + 1];
+
+			phase[k] = atan2f(Q * pRx->refI - I * pRx->refQ,
+			    I * pRx->refI + Q * pRx->refQ);
+			pRx->refI += alpha * (I - pRx->refI);
+			pRx->refQ += alpha * (Q - pRx->refQ);
+		}
+		DCF77PMRx_Push(pRx, phase, take);
+		i += take;
+	}
+}
@@ -0,0 +1,62 @@
+#ifndef D_DCF77PMRx_h
+#define D_DCF77PMRx_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Receiver of DCF77 phase modulation.  Samples of the carrier's phase
+ * (or I/Q pairs it is taken from) are correlated against the chip
+ * sequence: a correlation over a few seconds finds where the chips of a
+ * second start, then every second is matched around where it is due.
+ * The sign of a match gives the bit, its peak the start of the second to
+ * a fraction of a sample.
+ */
+
+typedef struct {
+	double		start;		/* of the second, samples into
+					 * the stream */
+	float		quality;	/* normalized correlation, 0..1 */
+	int		isPresent;
+	unsigned	bit;
+} DCF77PMRxSecond_t;
+
+typedef void (*DCF77PMRxSecondFn_t)(void * ctx,
+	const DCF77PMRxSecond_t * pSecond);
+
+typedef struct {
+	unsigned		 sampleRate;
+	DCF77PMRxSecondFn_t	 onSecond;
+	void			*ctx;
+	/* chips of a 0 bit, from tmplAt samples into the second */
+	float			*tmpl;
+	size_t			 tmplLen;
+	size_t			 tmplAt;
+	float			 tmplSum;
+	/* acquisition */
+	size_t			 fftLen;
+	float			*tmplRe, *tmplIm;	/* spectrum */
+	float			*twCos, *twSin;
+	float			*re, *im;
+	float			*score;
+	/* samples kept, buf[0] being bufAt into the stream */
+	float			*buf;
+	size_t			 bufLen, bufCap;
+	uint64_t		 bufAt;
+	/* phase reference for I/Q input */
+	float			 refI, refQ;
+	/* tracking, over lags of -track to +track samples */
+	unsigned		 track;
+	float			*corr;
+	int			 isLocked;
+	double			 nextChips;	/* where the chips are due */
+	unsigned		 missQty;
+} DCF77PMRx_t;
+
+void DCF77PMRx_Init(DCF77PMRx_t * pRx, unsigned sampleRate,
+	DCF77PMRxSecondFn_t onSecond, void * ctx);
+void DCF77PMRx_Free(DCF77PMRx_t * pRx);
+void DCF77PMRx_Push(DCF77PMRx_t * pRx, const float * phase, size_t qty);
+void DCF77PMRx_PushIQ(DCF77PMRx_t * pRx, const float * iq, size_t pairs);
+
+#endif /* #ifndef D_DCF77PMRx_h */
@@ -0,0 +1,197 @@
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77Schedule.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+
+/* bits telling nothing of the time */
+#define KEY_MASK	(~(DCF77TC_MASK(WEATHER) | DCF77TC_MASK(R)))
+
+/* Fibonacci hashing: the top bits of the product are well mixed */
+#define HASH_MULTIPLIER	UINT64_C(0x9E3779B97F4A7C15)
+
+static time_t
+minuteOf(time_t t)
+{
+	time_t r = t % 60;
+
+	return t - ((r < 0) ? r + 60 : r);
+}
+
+static inline uint64_t
+keyOf(const DCF77Block_t * pBlock)
+{
+	return DCF77TimeCode_LoadWord(pBlock) & KEY_MASK;
+}
+
+static inline size_t
+slotOf(const DCF77Schedule_t * pSchedule, uint64_t key)
+{
+	return (size_t)((key * HASH_MULTIPLIER) >> (64 - pSchedule->slotBits));
+}
+
+/*
+ * Open addressing with linear probing, at most half of the slots used.
+ */
+static void
+buildIndex(DCF77Schedule_t * pSchedule)
+{
+	size_t mask, slot;
+	uint64_t i;
+
+	if (pSchedule->qty >= UINT32_MAX) {
+		errx(EX_DATAERR, "too many blocks to index: %llu",
+		    (unsigned long long)pSchedule->qty);
+		/* NOTREACHED */
+	}
+
+	pSchedule->slotBits = 1;
+	while ((UINT64_C(1) << pSchedule->slotBits) < 2 * pSchedule->qty) {
+		pSchedule->slotBits++;
+	}
+	mask = ((size_t)1 << pSchedule->slotBits) - 1;
+
+	pSchedule->slots = calloc(mask + 1, sizeof(*pSchedule->slots));
+	if (NULL == pSchedule->slots) {
+		err(EX_OSERR, "no memory for index of %llu blocks",
+		    (unsigned long long)pSchedule->qty);
+		/* NOTREACHED */
+	}
+
+	for (i = 0; i < pSchedule->qty; ++i) {
+		uint64_t key = keyOf(&pSchedule->blocks[i]);
+
+		for (slot = slotOf(pSchedule, key);
+		    0 != pSchedule->slots[slot]; slot = (slot + 1) & mask) {
+			if (key == keyOf(&pSchedule->blocks[
+			    pSchedule->slots[slot] - 1]))
+				break;
+		}
+		if (0 == pSchedule->slots[slot]) {
+			pSchedule->slots[slot] = (uint32_t)(i + 1);
+		}
+	}
+}
+
+/*
+ * Encodes 'qty' minutes from the one 'firstMinute' belongs to, in the
+ * local time zone (and DST table, if one is in use).
+ */
+void
+DCF77Schedule_Build(DCF77Schedule_t * pSchedule, time_t firstMinute,
+	uint64_t qty)
+{
+	DCF77Block_t * blocks;
+	struct tm stm;
+	uint64_t i;
+
+	memset(pSchedule, 0, sizeof(*pSchedule));
+
+	blocks = calloc((size_t)qty + 1, sizeof(*blocks));
+	if (NULL == blocks) {
+		err(EX_OSERR, "no memory for %llu blocks",
+		    (unsigned long long)qty);
+		/* NOTREACHED */
+	}
+
+	pSchedule->firstMinute = (int64_t)minuteOf(firstMinute);
+	pSchedule->qty = qty;
+	pSchedule->blocks = blocks;
+	pSchedule->ownBlocks = blocks;
+
+	firstMinute = (time_t)pSchedule->firstMinute;
+	(void)localtime_r(&firstMinute, &stm);
+	DCF77TimeCode_ConvertFromStructTM(&blocks[0], &stm);
+	for (i = 1; i < qty; ++i) {
+		blocks[i] = blocks[i - 1];
+		DCF77TimeCode_AdvanceByMinute(&blocks[i]);
+	}
+
+	buildIndex(pSchedule);
+}
+
+/*
+ * The blocks are used right from the mapped block file, only the index
+ * is built.
+ */
+void
+DCF77Schedule_Open(DCF77Schedule_t * pSchedule, const char * path)
+{
+	memset(pSchedule, 0, sizeof(*pSchedule));
+
+	DCF77BlockFile_Open(&pSchedule->file, path);
+	pSchedule->firstMinute = pSchedule->file.startTime;
+	pSchedule->qty = pSchedule->file.qty;
+	pSchedule->blocks = pSchedule->file.blocks;
+
+	buildIndex(pSchedule);
+}
+
+void
+DCF77Schedule_Save(const DCF77Schedule_t * pSchedule, const char * path)
+{
+	DCF77BlockFileWriter_t writer;
+
+	DCF77BlockFile_Create(&writer, path, (time_t)pSchedule->firstMinute);
+	DCF77BlockFile_Append(&writer, pSchedule->blocks,
+	    (size_t)pSchedule->qty);
+	DCF77BlockFile_Finish(&writer);
+}
+
+void
+DCF77Schedule_Free(DCF77Schedule_t * pSchedule)
+{
+	free(pSchedule->ownBlocks);
+	free(pSchedule->slots);
+	DCF77BlockFile_Close(&pSchedule->file);
+	memset(pSchedule, 0, sizeof(*pSchedule));
+}
+
+/*
+ * Returns the block of the minute 't' belongs to, NULL when the schedule
+ * has none.
+ */
+const DCF77Block_t *
+DCF77Schedule_BlockAt(const DCF77Schedule_t * pSchedule, time_t t)
+{
+	int64_t idx;
+
+	if ((int64_t)t < pSchedule->firstMinute)
+		return NULL;
+
+	idx = ((int64_t)t - pSchedule->firstMinute) / 60;
+	if ((uint64_t)idx >= pSchedule->qty)
+		return NULL;
+
+	return &pSchedule->blocks[idx];
+}
+
+/*
+ * Stores the time of the minute 'pBlock' encodes; returns 0 when the
+ * schedule has no such block.
+ */
+int
+DCF77Schedule_TimeOf(const DCF77Schedule_t * pSchedule,
+	const DCF77Block_t * pBlock, time_t * pTime)
+{
+	uint64_t key = keyOf(pBlock);
+	size_t mask, slot;
+	uint32_t pos;
+
+	if (NULL == pSchedule->slots)
+		return 0;
+
+	mask = ((size_t)1 << pSchedule->slotBits) - 1;
+	for (slot = slotOf(pSchedule, key);
+	    0 != (pos = pSchedule->slots[slot]); slot = (slot + 1) & mask) {
+		if (key == keyOf(&pSchedule->blocks[pos - 1])) {
+			*pTime = (time_t)(pSchedule->firstMinute +
+			    (int64_t)(pos - 1) * 60);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef D_DCF77Schedule_h
+#define D_DCF77Schedule_h
+
+#include <stdint.h>
+#include <time.h>
+#include "DCF77Block.h"
+#include "DCF77BlockFile.h"
+
+/*
+ * Blocks of consecutive minutes, built once and then looked up both
+ * ways: by time through the dense array, by block through a hash index
+ * of the array positions.  Weather and R bits are not part of the key,
+ * and a block met twice (a century apart) maps to its first minute.
+ */
+typedef struct {
+	int64_t			 firstMinute;
+	uint64_t		 qty;
+	const DCF77Block_t	*blocks;
+	DCF77Block_t		*ownBlocks;	/* NULL when read from a file */
+	DCF77BlockFile_t	 file;
+	uint32_t		*slots;		/* array position + 1, or 0 */
+	unsigned		 slotBits;
+} DCF77Schedule_t;
+
+void DCF77Schedule_Build(DCF77Schedule_t * pSchedule, time_t firstMinute,
+	uint64_t qty);
+void DCF77Schedule_Open(DCF77Schedule_t * pSchedule, const char * path);
+void DCF77Schedule_Save(const DCF77Schedule_t * pSchedule,
+	const char * path);
+void DCF77Schedule_Free(DCF77Schedule_t * pSchedule);
+
+const DCF77Block_t * DCF77Schedule_BlockAt(const DCF77Schedule_t * pSchedule,
+	time_t t);
+int DCF77Schedule_TimeOf(const DCF77Schedule_t * pSchedule,
+	const DCF77Block_t * pBlock, time_t * pTime);
+
+#endif /* #ifndef D_DCF77Schedule_h */
@@ -0,0 +1,595 @@
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include "DCF77Server.h"
+#include "DCF77TimeCode.h"
+
+#define EVENTS_QTY	64
+#define READ_CHUNK	4096
+#define OUT_MAX		(4 * 1024 * 1024)	/* slow client gets dropped */
+#define RESPONSE_MAX	(DCF77SERVER_HEADER_SZ + \
+			 DCF77SERVER_MAX_COUNT * DCF77BLOCK_SIZE)
+
+static time_t
+minuteOf(time_t t)
+{
+	time_t r = t % 60;
+
+	return t - ((r < 0) ? r + 60 : r);
+}
+
+static void
+computeBlock(time_t minute, DCF77Block_t * pBlock)
+{
+	struct tm stm;
+
+	(void)localtime_r(&minute, &stm);
+	DCF77TimeCode_ConvertFromStructTM(pBlock, &stm);
+}
+
+void
+DCF77Server_RingInit(DCF77BlockRing_t * pRing, time_t firstMinute,
+	size_t qty)
+{
+	DCF77Block_t block;
+	size_t i;
+
+	pRing->blocks = calloc(qty, sizeof(*pRing->blocks));
+	if (NULL == pRing->blocks) {
+		err(EX_OSERR, "no memory for %zu blocks", qty);
+		/* NOTREACHED */
+	}
+	pRing->firstMinute = minuteOf(firstMinute);
+	pRing->qty = qty;
+	pRing->head = 0;
+
+	computeBlock(pRing->firstMinute, &block);
+	for (i = 0; i < qty; ++i) {
+		pRing->blocks[i] = block;
+		DCF77TimeCode_AdvanceByMinute(&block);
+	}
+}
+
+/*
+ * Passed minutes are replaced by new ones at the far end; a jump back in
+ * time or too far ahead rebuilds the whole ring.
+ */
+void
+DCF77Server_RingSlide(DCF77BlockRing_t * pRing, time_t firstMinute)
+{
+	time_t minutes;
+
+	firstMinute = minuteOf(firstMinute);
+	minutes = (firstMinute - pRing->firstMinute) / 60;
+
+	if (minutes < 0 || (size_t)minutes >= pRing->qty) {
+		size_t qty = pRing->qty;
+
+		DCF77Server_RingFree(pRing);
+		DCF77Server_RingInit(pRing, firstMinute, qty);
+		return;
+	}
+
+	while (minutes-- > 0) {
+		size_t last = (pRing->head + pRing->qty - 1) % pRing->qty;
+		DCF77Block_t block = pRing->blocks[last];
+
+		DCF77TimeCode_AdvanceByMinute(&block);
+		pRing->blocks[pRing->head] = block;
+		pRing->head = (pRing->head + 1) % pRing->qty;
+		pRing->firstMinute += 60;
+	}
+}
+
+void
+DCF77Server_RingFree(DCF77BlockRing_t * pRing)
+{
+	free(pRing->blocks);
+	memset(pRing, 0, sizeof(*pRing));
+}
+
+/*
+ * Minutes outside of the ring are encoded on demand.
+ */
+void
+DCF77Server_BlockAt(const DCF77BlockRing_t * pRing, time_t minute,
+	DCF77Block_t * pBlock)
+{
+	time_t offset;
+
+	minute = minuteOf(minute);
+	offset = (minute - pRing->firstMinute) / 60;
+
+	if (offset >= 0 && (size_t)offset < pRing->qty) {
+		*pBlock = pRing->blocks[(pRing->head + (size_t)offset) %
+		    pRing->qty];
+	} else {
+		computeBlock(minute, pBlock);
+	}
+}
+
+static uint64_t
+getLE(const uint8_t * src, unsigned sz)
+{
+	uint64_t v = 0;
+
+	while (sz-- > 0) {
+		v = (v << 8) | src[sz];
+	}
+
+	return v;
+}
+
+static void
+putLE(uint8_t * dst, uint64_t v, unsigned sz)
+{
+	unsigned i;
+
+	for (i = 0; i < sz; ++i) {
+		dst[i] = (uint8_t)(v >> (8 * i));
+	}
+}
+
+static size_t
+putResponse(const DCF77BlockRing_t * pRing, unsigned status, unsigned op,
+	time_t first, uint32_t count, uint8_t * response)
+{
+	uint32_t i;
+
+	memset(response, 0, DCF77SERVER_HEADER_SZ);
+	response[0] = (uint8_t)status;
+	response[1] = (uint8_t)op;
+	putLE(&response[4], count, 4);
+	putLE(&response[8], (uint64_t)(int64_t)first, 8);
+
+	for (i = 0; i < count; ++i) {
+		DCF77Server_BlockAt(pRing, first + (time_t)i * 60,
+		    (DCF77Block_t *)&response[DCF77SERVER_HEADER_SZ +
+		    i * DCF77BLOCK_SIZE]);
+	}
+
+	return DCF77SERVER_HEADER_SZ + (size_t)count * DCF77BLOCK_SIZE;
+}
+
+/*
+ * Fills in the response to a request, returns its size.  'response' has
+ * to hold the header and DCF77SERVER_MAX_COUNT blocks.
+ */
+size_t
+DCF77Server_Answer(const DCF77BlockRing_t * pRing,
+	const uint8_t request[DCF77SERVER_REQUEST_SZ],
+	uint8_t * response, size_t responseSz)
+{
+	unsigned op = request[0];
+	uint32_t count = (uint32_t)getLE(&request[4], 4);
+	time_t t = (time_t)(int64_t)getLE(&request[8], 8);
+	int isReservedZero = 0 == (request[1] | request[2] | request[3]);
+
+	if (responseSz < RESPONSE_MAX || !isReservedZero ||
+	    count > DCF77SERVER_MAX_COUNT) {
+		op = 0;
+	}
+
+	switch (op) {
+	case DCF77SERVER_OP_BLOCK_AT:
+		return putResponse(pRing, DCF77SERVER_STATUS_OK, op,
+		    minuteOf(t), count, response);
+	case DCF77SERVER_OP_NEXT:
+		return putResponse(pRing, DCF77SERVER_STATUS_OK, op,
+		    pRing->firstMinute, count, response);
+	case DCF77SERVER_OP_SUBSCRIBE:
+		return putResponse(pRing, DCF77SERVER_STATUS_OK, op,
+		    pRing->firstMinute, 1, response);
+	case DCF77SERVER_OP_UNSUBSCRIBE:
+		return putResponse(pRing, DCF77SERVER_STATUS_OK, op,
+		    pRing->firstMinute, 0, response);
+	default:
+		return putResponse(pRing, DCF77SERVER_STATUS_BAD_REQUEST,
+		    request[0], 0, 0, response);
+	}
+}
+
+typedef struct Client_t {
+	int		 fd;
+	int		 isSubscribed;
+	int		 wantsOut;	/* EPOLLOUT armed */
+	uint8_t		 in[DCF77SERVER_REQUEST_SZ];
+	size_t		 inLen;
+	uint8_t		*out;
+	size_t		 outLen, outCap;
+	struct Client_t	*prev, *next;
+} Client_t;
+
+typedef struct {
+	int			 epollFd;
+	int			 listenFd;
+	int			 timerFd;
+	DCF77BlockRing_t	 ring;
+	Client_t		*clients;
+	Client_t		*dropped;	/* freed after each batch */
+	uint8_t			 response[RESPONSE_MAX];
+} Server_t;
+
+static volatile sig_atomic_t isStopping = 0;
+
+static void
+onStopSignal(int sig)
+{
+	(void)sig;
+	isStopping = 1;
+}
+
+/*
+ * Events of the batch being handled may still refer to the client, so it
+ * is only marked here and freed by freeDroppedClients().
+ */
+static void
+dropClient(Server_t * pServer, Client_t * pClient)
+{
+	(void)epoll_ctl(pServer->epollFd, EPOLL_CTL_DEL, pClient->fd, NULL);
+	close(pClient->fd);
+	pClient->fd = -1;
+
+	if (NULL != pClient->prev) {
+		pClient->prev->next = pClient->next;
+	} else {
+		pServer->clients = pClient->next;
+	}
+	if (NULL != pClient->next) {
+		pClient->next->prev = pClient->prev;
+	}
+
+	pClient->next = pServer->dropped;
+	pServer->dropped = pClient;
+}
+
+static void
+freeDroppedClients(Server_t * pServer)
+{
+	while (NULL != pServer->dropped) {
+		Client_t * pClient = pServer->dropped;
+
+		pServer->dropped = pClient->next;
+		free(pClient->out);
+		free(pClient);
+	}
+}
+
+static void
+armOut(Server_t * pServer, Client_t * pClient, int wantsOut)
+{
+	struct epoll_event ev;
+
+	if (wantsOut == pClient->wantsOut)
+		return;
+
+	ev.events = EPOLLIN | (wantsOut ? EPOLLOUT : 0);
+	ev.data.ptr = pClient;
+	(void)epoll_ctl(pServer->epollFd, EPOLL_CTL_MOD, pClient->fd, &ev);
+	pClient->wantsOut = wantsOut;
+}
+
+/*
+ * Returns 0 once the client is gone.
+ */
+static int
+flushClient(Server_t * pServer, Client_t * pClient)
+{
+	size_t sent = 0;
+
+	while (sent < pClient->outLen) {
+		ssize_t n = send(pClient->fd, &pClient->out[sent],
+		    pClient->outLen - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+		if (n < 0) {
+			if (EAGAIN == errno || EWOULDBLOCK == errno)
+				break;
+			if (EINTR == errno)
+				continue;
+			dropClient(pServer, pClient);
+			return 0;
+		}
+		sent += (size_t)n;
+	}
+
+	memmove(pClient->out, &pClient->out[sent], pClient->outLen - sent);
+	pClient->outLen -= sent;
+	armOut(pServer, pClient, 0 != pClient->outLen);
+
+	return 1;
+}
+
+static int
+sendToClient(Server_t * pServer, Client_t * pClient, const uint8_t * data,
+	size_t sz)
+{
+	if (pClient->outLen + sz > pClient->outCap) {
+		size_t cap = 2 * (pClient->outLen + sz);
+		uint8_t * out;
+
+		if (cap > OUT_MAX) {
+			dropClient(pServer, pClient);
+			return 0;
+		}
+		out = realloc(pClient->out, cap);
+		if (NULL == out) {
+			dropClient(pServer, pClient);
+			return 0;
+		}
+		pClient->out = out;
+		pClient->outCap = cap;
+	}
+
+	memcpy(&pClient->out[pClient->outLen], data, sz);
+	pClient->outLen += sz;
+
+	return flushClient(pServer, pClient);
+}
+
+static void
+acceptClients(Server_t * pServer)
+{
+	for (;;) {
+		struct epoll_event ev;
+		Client_t * pClient;
+		int fd = accept4(pServer->listenFd, NULL, NULL,
+		    SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+		if (fd < 0) {
+			if (EINTR == errno)
+				continue;
+			return;
+		}
+
+		pClient = calloc(1, sizeof(*pClient));
+		if (NULL == pClient) {
+			close(fd);
+			continue;
+		}
+		pClient->fd = fd;
+		ev.events = EPOLLIN;
+		ev.data.ptr = pClient;
+		if (0 != epoll_ctl(pServer->epollFd, EPOLL_CTL_ADD, fd, &ev)) {
+			close(fd);
+			free(pClient);
+			continue;
+		}
+
+		pClient->next = pServer->clients;
+		if (NULL != pClient->next) {
+			pClient->next->prev = pClient;
+		}
+		pServer->clients = pClient;
+	}
+}
+
+/*
+ * Returns 0 once the client is gone.
+ */
+static int
+answerRequest(Server_t * pServer, Client_t * pClient)
+{
+	size_t sz = DCF77Server_Answer(&pServer->ring, pClient->in,
+	    pServer->response, sizeof(pServer->response));
+
+	if (DCF77SERVER_STATUS_OK == pServer->response[0]) {
+		if (DCF77SERVER_OP_SUBSCRIBE == pClient->in[0]) {
+			pClient->isSubscribed = 1;
+		} else if (DCF77SERVER_OP_UNSUBSCRIBE == pClient->in[0]) {
+			pClient->isSubscribed = 0;
+		}
+	}
+
+	return sendToClient(pServer, pClient, pServer->response, sz);
+}
+
+static void
+readClient(Server_t * pServer, Client_t * pClient)
+{
+	uint8_t buf[READ_CHUNK];
+
+	for (;;) {
+		ssize_t n = read(pClient->fd, buf, sizeof(buf));
+		size_t i;
+
+		if (n < 0 && EINTR == errno)
+			continue;
+		if (n < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+			return;
+		if (n <= 0) {
+			dropClient(pServer, pClient);
+			return;
+		}
+
+		for (i = 0; i < (size_t)n; ++i) {
+			pClient->in[pClient->inLen++] = buf[i];
+			if (DCF77SERVER_REQUEST_SZ != pClient->inLen)
+				continue;
+
+			pClient->inLen = 0;
+			if (!answerRequest(pServer, pClient))
+				return;
+		}
+	}
+}
+
+static time_t
+onAirMinute(void)
+{
+	/* block on air now encodes the coming minute */
+	return minuteOf(time(NULL)) + 60;
+}
+
+static void
+onMinute(Server_t * pServer)
+{
+	uint64_t expirations;
+	Client_t * pClient, * pNext;
+	size_t sz;
+
+	if (read(pServer->timerFd, &expirations, sizeof(expirations)) < 0)
+		return;
+
+	/*
+	 * time(2) may lag behind the timer by a clock tick: the boundary
+	 * just passed is the nearest one.
+	 */
+	DCF77Server_RingSlide(&pServer->ring, minuteOf(time(NULL) + 30) + 60);
+	sz = putResponse(&pServer->ring, DCF77SERVER_STATUS_OK,
+	    DCF77SERVER_OP_PUSH, pServer->ring.firstMinute, 1,
+	    pServer->response);
+
+	for (pClient = pServer->clients; NULL != pClient; pClient = pNext) {
+		pNext = pClient->next;
+		if (pClient->isSubscribed) {
+			(void)sendToClient(pServer, pClient,
+			    pServer->response, sz);
+		}
+	}
+}
+
+static void
+openListener(Server_t * pServer, const char * path)
+{
+	struct sockaddr_un sun;
+	struct stat st;
+
+	if (strlen(path) >= sizeof(sun.sun_path)) {
+		errx(EX_USAGE, "socket path too long: %s", path);
+		/* NOTREACHED */
+	}
+	/* a stale socket of a previous run is taken over */
+	if (0 == lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+		(void)unlink(path);
+	}
+
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	strcpy(sun.sun_path, path);
+
+	pServer->listenFd = socket(AF_UNIX,
+	    SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (pServer->listenFd < 0 ||
+	    0 != bind(pServer->listenFd, (struct sockaddr *)&sun,
+	    sizeof(sun)) ||
+	    0 != listen(pServer->listenFd, SOMAXCONN)) {
+		err(EX_OSERR, "%s", path);
+		/* NOTREACHED */
+	}
+}
+
+static void
+openMinuteTimer(Server_t * pServer)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = minuteOf(time(NULL)) + 60;
+	its.it_interval.tv_sec = 60;
+
+	pServer->timerFd = timerfd_create(CLOCK_REALTIME,
+	    TFD_NONBLOCK | TFD_CLOEXEC);
+	if (pServer->timerFd < 0 || 0 != timerfd_settime(pServer->timerFd,
+	    TFD_TIMER_ABSTIME, &its, NULL)) {
+		err(EX_OSERR, "timerfd");
+		/* NOTREACHED */
+	}
+}
+
+static void
+watch(Server_t * pServer, int fd, void * tag)
+{
+	struct epoll_event ev;
+
+	ev.events = EPOLLIN;
+	ev.data.ptr = tag;
+	if (0 != epoll_ctl(pServer->epollFd, EPOLL_CTL_ADD, fd, &ev)) {
+		err(EX_OSERR, "epoll_ctl");
+		/* NOTREACHED */
+	}
+}
+
+/*
+ * Serves till SIGINT or SIGTERM, then removes the socket.  Blocks of
+ * 'aheadMinutes' minutes from the one on air are kept encoded.
+ */
+void
+DCF77Server_Run(const char * path, size_t aheadMinutes)
+{
+	static Server_t server;
+	struct epoll_event events[EVENTS_QTY];
+	struct sigaction sa;
+	int listenTag, timerTag;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = onStopSignal;
+	(void)sigaction(SIGINT, &sa, NULL);
+	(void)sigaction(SIGTERM, &sa, NULL);
+	sa.sa_handler = SIG_IGN;
+	(void)sigaction(SIGPIPE, &sa, NULL);
+
+	DCF77Server_RingInit(&server.ring, onAirMinute(), aheadMinutes);
+
+	server.epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (server.epollFd < 0) {
+		err(EX_OSERR, "epoll_create1");
+		/* NOTREACHED */
+	}
+	openListener(&server, path);
+	openMinuteTimer(&server);
+	watch(&server, server.listenFd, &listenTag);
+	watch(&server, server.timerFd, &timerTag);
+
+	while (!isStopping) {
+		int i, qty = epoll_wait(server.epollFd, events, EVENTS_QTY, -1);
+
+		if (qty < 0) {
+			if (EINTR == errno)
+				continue;
+			err(EX_OSERR, "epoll_wait");
+			/* NOTREACHED */
+		}
+
+		for (i = 0; i < qty; ++i) {
+			void * tag = events[i].data.ptr;
+
+			if (&listenTag == tag) {
+				acceptClients(&server);
+			} else if (&timerTag == tag) {
+				onMinute(&server);
+			} else if (((Client_t *)tag)->fd < 0) {
+				continue;
+			} else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+				dropClient(&server, tag);
+			} else {
+				if (events[i].events & EPOLLOUT &&
+				    !flushClient(&server, tag))
+					continue;
+				if (events[i].events & EPOLLIN) {
+					readClient(&server, tag);
+				}
+			}
+		}
+		freeDroppedClients(&server);
+	}
+
+	while (NULL != server.clients) {
+		dropClient(&server, server.clients);
+	}
+	freeDroppedClients(&server);
+	close(server.timerFd);
+	close(server.listenFd);
+	close(server.epollFd);
+	(void)unlink(path);
+	DCF77Server_RingFree(&server.ring);
+}
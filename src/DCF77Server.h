@@ -0,0 +1,75 @@
+#ifndef D_DCF77Server_h
+#define D_DCF77Server_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include "DCF77Block.h"
+
+/*
+ * Protocol over a SOCK_STREAM Unix domain socket, numbers little-endian.
+ *
+ * Request, 16 bytes:
+ *   0: uint8  op (DCF77SERVER_OP_...)
+ *   1: uint8  reserved[3], zero
+ *   4: uint32 count of blocks wanted
+ *   8: int64  time, seconds since the Epoch (BLOCK_AT only)
+ *
+ * Response, 16 byte header followed by 'count' blocks of 8 bytes:
+ *   0: uint8  status (DCF77SERVER_STATUS_...)
+ *   1: uint8  op of the request, or DCF77SERVER_OP_PUSH
+ *   2: uint16 reserved, zero
+ *   4: uint32 count of blocks that follow
+ *   8: int64  time of the minute the first block encodes
+ *
+ * Blocks are of consecutive minutes.  The block of minute T is the one
+ * on air during the minute before T.  NEXT starts with the block to be
+ * transmitted during the coming minute.  A subscriber gets, right away
+ * and then at every minute boundary, a PUSH of the block to transmit in
+ * the minute just begun.
+ */
+enum {
+	DCF77SERVER_REQUEST_SZ = 16,
+	DCF77SERVER_HEADER_SZ = 16,
+	DCF77SERVER_MAX_COUNT = 1440
+};
+
+enum {
+	DCF77SERVER_OP_BLOCK_AT = 1,	/* 'count' blocks from minute 'time' */
+	DCF77SERVER_OP_NEXT,		/* 'count' upcoming blocks */
+	DCF77SERVER_OP_SUBSCRIBE,
+	DCF77SERVER_OP_UNSUBSCRIBE,
+	DCF77SERVER_OP_PUSH		/* responses only */
+};
+
+enum {
+	DCF77SERVER_STATUS_OK = 0,
+	DCF77SERVER_STATUS_BAD_REQUEST
+};
+
+/*
+ * Blocks of 'qty' consecutive minutes from 'firstMinute' on, kept in a
+ * circle: sliding forward drops passed minutes and derives new ones from
+ * the last block.
+ */
+typedef struct {
+	time_t		 firstMinute;
+	size_t		 qty;
+	size_t		 head;
+	DCF77Block_t	*blocks;
+} DCF77BlockRing_t;
+
+void DCF77Server_RingInit(DCF77BlockRing_t * pRing, time_t firstMinute,
+	size_t qty);
+void DCF77Server_RingSlide(DCF77BlockRing_t * pRing, time_t firstMinute);
+void DCF77Server_RingFree(DCF77BlockRing_t * pRing);
+void DCF77Server_BlockAt(const DCF77BlockRing_t * pRing, time_t minute,
+	DCF77Block_t * pBlock);
+
+size_t DCF77Server_Answer(const DCF77BlockRing_t * pRing,
+	const uint8_t request[DCF77SERVER_REQUEST_SZ],
+	uint8_t * response, size_t responseSz);
+
+void DCF77Server_Run(const char * path, size_t aheadMinutes);
+
+#endif /* #ifndef D_DCF77Server_h */
@@ -0,0 +1,154 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <err.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include "DCF77Shm.h"
+
+/* a writer dead in the middle of a publication must not hang readers */
+#define READ_ATTEMPTS	100000
+
+static DCF77ShmRegion_t *
+mapRegion(const char * name, int flags, mode_t mode)
+{
+	DCF77ShmRegion_t * pRegion;
+	int prot = (O_RDONLY == flags) ? PROT_READ : PROT_READ | PROT_WRITE;
+	int fd;
+
+	fd = shm_open(name, flags, mode);
+	if (fd < 0) {
+		err(EX_NOINPUT, "shm_open(%s)", name);
+		/* NOTREACHED */
+	}
+	if (O_RDONLY != flags && 0 != ftruncate(fd, sizeof(*pRegion))) {
+		err(EX_IOERR, "ftruncate(%s)", name);
+		/* NOTREACHED */
+	}
+
+	pRegion = mmap(NULL, sizeof(*pRegion), prot, MAP_SHARED, fd, 0);
+	if (MAP_FAILED == pRegion) {
+		err(EX_OSERR, "mmap(%s)", name);
+		/* NOTREACHED */
+	}
+	close(fd);
+
+	return pRegion;
+}
+
+void
+DCF77Shm_Create(DCF77Shm_t * pShm, const char * name)
+{
+	DCF77ShmRegion_t * pRegion;
+
+	pRegion = mapRegion(name, O_RDWR | O_CREAT, 0644);
+
+	/* stays odd, thus unreadable, till the first publication */
+	__atomic_store_n(&pRegion->seq, 1, __ATOMIC_RELAXED);
+	pRegion->qty = DCF77SHM_QTY;
+	pRegion->version = DCF77SHM_VERSION;
+	__atomic_store_n(&pRegion->magic, DCF77SHM_MAGIC, __ATOMIC_RELEASE);
+
+	pShm->pRegion = pRegion;
+	pShm->name = name;
+	pShm->isWriter = 1;
+}
+
+void
+DCF77Shm_Publish(DCF77Shm_t * pShm, time_t firstMinute,
+	const DCF77Block_t blocks[DCF77SHM_QTY])
+{
+	DCF77ShmRegion_t * pRegion = pShm->pRegion;
+	uint32_t seq = __atomic_load_n(&pRegion->seq, __ATOMIC_RELAXED);
+	uint64_t word;
+	int i;
+
+	seq |= 1u;
+	__atomic_store_n(&pRegion->seq, seq, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&pRegion->firstMinute, (int64_t)firstMinute,
+	    __ATOMIC_RELAXED);
+	for (i = 0; i < DCF77SHM_QTY; ++i) {
+		memcpy(&word, &blocks[i], sizeof(word));
+		__atomic_store_n(&pRegion->blocks[i], word, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&pRegion->seq, seq + 1u, __ATOMIC_RELEASE);
+}
+
+void
+DCF77Shm_Attach(DCF77Shm_t * pShm, const char * name)
+{
+	DCF77ShmRegion_t * pRegion;
+
+	pRegion = mapRegion(name, O_RDONLY, 0);
+
+	if (DCF77SHM_MAGIC != __atomic_load_n(&pRegion->magic,
+	    __ATOMIC_ACQUIRE) || DCF77SHM_VERSION != pRegion->version ||
+	    DCF77SHM_QTY != pRegion->qty) {
+		errx(EX_DATAERR, "%s: not a block segment of version %d",
+		    name, DCF77SHM_VERSION);
+		/* NOTREACHED */
+	}
+
+	pShm->pRegion = pRegion;
+	pShm->name = name;
+	pShm->isWriter = 0;
+}
+
+/*
+ * Copies the block encoding 'minute' (seconds since the Epoch, rounded
+ * down to the minute), returns 0 if the segment holds no such block.
+ */
+int
+DCF77Shm_BlockAt(const DCF77Shm_t * pShm, time_t minute,
+	DCF77Block_t * pBlock)
+{
+	DCF77ShmRegion_t * pRegion = pShm->pRegion;
+	uint32_t seq;
+	int64_t offset;
+	uint64_t word = 0;
+	int attempts;
+
+	minute -= ((minute % 60) + 60) % 60;
+
+	for (attempts = 0; attempts < READ_ATTEMPTS; ++attempts) {
+		seq = __atomic_load_n(&pRegion->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1u)
+			continue;
+
+		offset = ((int64_t)minute - __atomic_load_n(
+		    &pRegion->firstMinute, __ATOMIC_RELAXED)) / 60;
+		if (offset >= 0 && offset < DCF77SHM_QTY) {
+			word = __atomic_load_n(&pRegion->blocks[offset],
+			    __ATOMIC_RELAXED);
+		}
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (seq != __atomic_load_n(&pRegion->seq, __ATOMIC_RELAXED))
+			continue;
+
+		if (offset < 0 || offset >= DCF77SHM_QTY)
+			return 0;
+
+		memcpy(pBlock, &word, sizeof(*pBlock));
+		return 1;
+	}
+
+	return 0;
+}
+
+void
+DCF77Shm_Close(DCF77Shm_t * pShm)
+{
+	if (NULL == pShm->pRegion)
+		return;
+
+	munmap(pShm->pRegion, sizeof(*pShm->pRegion));
+	if (pShm->isWriter) {
+		(void)shm_unlink(pShm->name);
+	}
+	memset(pShm, 0, sizeof(*pShm));
+}
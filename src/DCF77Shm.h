@@ -0,0 +1,53 @@
+#ifndef D_DCF77Shm_h
+#define D_DCF77Shm_h
+
+#include <stdint.h>
+#include <time.h>
+#include "DCF77Block.h"
+
+/*
+ * POSIX shared memory segment with the blocks of the upcoming minutes,
+ * for local readers only (native byte order):
+ *   0: uint32 magic "D77S"
+ *   4: uint32 layout version
+ *   8: uint32 quantity of blocks
+ *  12: uint32 sequence, odd while the writer is at work
+ *  16: int64  time of the minute the first block encodes
+ *  24: blocks of consecutive minutes, 8 bytes each
+ *
+ * The sequence makes a seqlock: the writer never waits for readers, and
+ * readers retry a copy that overlapped a write.  Reading takes no system
+ * call once the segment is mapped.
+ */
+enum {
+	DCF77SHM_MAGIC = 0x53373744,
+	DCF77SHM_VERSION = 1,
+	DCF77SHM_QTY = 16
+};
+
+typedef struct {
+	uint32_t	 magic;
+	uint32_t	 version;
+	uint32_t	 qty;
+	uint32_t	 seq;
+	int64_t		 firstMinute;
+	uint64_t	 blocks[DCF77SHM_QTY];	/* bytes of DCF77Block_t */
+} DCF77ShmRegion_t;
+
+typedef struct {
+	DCF77ShmRegion_t	*pRegion;
+	const char		*name;
+	int			 isWriter;
+} DCF77Shm_t;
+
+void DCF77Shm_Create(DCF77Shm_t * pShm, const char * name);
+void DCF77Shm_Publish(DCF77Shm_t * pShm, time_t firstMinute,
+	const DCF77Block_t blocks[DCF77SHM_QTY]);
+
+void DCF77Shm_Attach(DCF77Shm_t * pShm, const char * name);
+int DCF77Shm_BlockAt(const DCF77Shm_t * pShm, time_t minute,
+	DCF77Block_t * pBlock);
+
+void DCF77Shm_Close(DCF77Shm_t * pShm);
+
+#endif /* #ifndef D_DCF77Shm_h */
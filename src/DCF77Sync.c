@@ -0,0 +1,196 @@
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77Sync.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+
+/* bits of a frame read past its first word: 59 at most */
+#define PAD_WORDS	2
+
+#define FRAME_PULSES	((UINT64_C(1) << DCF77TC_MM_SHIFT) - 1)
+
+void
+DCF77Sync_InitBits(DCF77Bits_t * pBits)
+{
+	memset(pBits, 0, sizeof(*pBits));
+}
+
+void
+DCF77Sync_FreeBits(DCF77Bits_t * pBits)
+{
+	free(pBits->present);
+	free(pBits->value);
+	memset(pBits, 0, sizeof(*pBits));
+}
+
+static void
+growBits(DCF77Bits_t * pBits)
+{
+	size_t capWords = (0 == pBits->capWords) ? 1024 : 2 * pBits->capWords;
+	size_t sz = (capWords + PAD_WORDS) * sizeof(uint64_t);
+	size_t oldSz = (0 == pBits->capWords) ? 0 :
+	    (pBits->capWords + PAD_WORDS) * sizeof(uint64_t);
+	uint64_t * present = realloc(pBits->present, sz);
+	uint64_t * value = (NULL == present) ? NULL :
+	    realloc(pBits->value, sz);
+
+	if (NULL == present || NULL == value) {
+		err(EX_OSERR, "no memory for %zu seconds", capWords * 64);
+		/* NOTREACHED */
+	}
+	memset((char *)present + oldSz, 0, sz - oldSz);
+	memset((char *)value + oldSz, 0, sz - oldSz);
+
+	pBits->present = present;
+	pBits->value = value;
+	pBits->capWords = capWords;
+}
+
+void
+DCF77Sync_AppendBit(DCF77Bits_t * pBits, int isPresent, int value)
+{
+	uint64_t bit = UINT64_C(1) << (pBits->qty & 63);
+	size_t w = (size_t)(pBits->qty >> 6);
+
+	if (w >= pBits->capWords) {
+		growBits(pBits);
+	}
+	if (isPresent) {
+		pBits->present[w] |= bit;
+		if (value) {
+			pBits->value[w] |= bit;
+		}
+	}
+	pBits->qty++;
+}
+
+/*
+ * A character per second: '0' and '1' are pulses, white space is
+ * skipped, anything else stands for a second with no pulse.
+ */
+void
+DCF77Sync_AppendText(DCF77Bits_t * pBits, const char * text)
+{
+	for (; '\0' != *text; ++text) {
+		switch (*text) {
+		case ' ': case '\t': case '\r': case '\n':
+			break;
+		case '0': case '1':
+			DCF77Sync_AppendBit(pBits, 1, '1' == *text);
+			break;
+		default:
+			DCF77Sync_AppendBit(pBits, 0, 0);
+			break;
+		}
+	}
+}
+
+/*
+ * 64 bits of a plane from second 'pos' on.
+ */
+static inline uint64_t
+bitsAt(const uint64_t * plane, uint64_t pos)
+{
+	size_t w = (size_t)(pos >> 6);
+	unsigned k = (unsigned)(pos & 63);
+
+	return (0 == k) ? plane[w] :
+	    (plane[w] >> k) | (plane[w + 1] << (64 - k));
+}
+
+/*
+ * XOR of the bits 'first'..'last' of the frames starting at the 64
+ * seconds from 'pos' on: even parity makes it zero.
+ */
+static inline uint64_t
+parityOfRange(const uint64_t * plane, uint64_t pos, unsigned first,
+	unsigned last)
+{
+	uint64_t x = 0;
+	unsigned k;
+
+	for (k = first; k <= last; ++k) {
+		x ^= bitsAt(plane, pos + k);
+	}
+
+	return x;
+}
+
+/*
+ * Frames starting at the 64 seconds from 'pos' on that pass the checks
+ * done on all of them at once: a bit per candidate.
+ */
+static uint64_t
+candidatesAt(const DCF77Bits_t * pBits, uint64_t pos, unsigned flags)
+{
+	const uint64_t * P = pBits->present;
+	const uint64_t * V = pBits->value;
+	uint64_t cand;
+	unsigned k;
+
+	/* cheap filter first: M is 0, S is 1, Z1 differs from Z2 */
+	cand = bitsAt(P, pos + DCF77TC_M_SHIFT) &
+	    ~bitsAt(V, pos + DCF77TC_M_SHIFT) &
+	    bitsAt(P, pos + DCF77TC_S_SHIFT) &
+	    bitsAt(V, pos + DCF77TC_S_SHIFT) &
+	    (bitsAt(V, pos + DCF77TC_Z1_SHIFT) ^
+	     bitsAt(V, pos + DCF77TC_Z2_SHIFT));
+	if (flags & DCF77SYNC_NEEDS_MARK) {
+		cand &= ~bitsAt(P, pos + DCF77TC_MM_SHIFT);
+	}
+
+	for (k = 0; 0u != cand && k < DCF77TC_MM_SHIFT; ++k) {
+		cand &= bitsAt(P, pos + k);
+	}
+	if (0u == cand)
+		return 0;
+
+	cand &= ~parityOfRange(V, pos, DCF77TC_MIN_SHIFT, DCF77TC_P1_SHIFT);
+	cand &= ~parityOfRange(V, pos, DCF77TC_HOUR_SHIFT, DCF77TC_P2_SHIFT);
+	cand &= ~parityOfRange(V, pos, DCF77TC_DOM_SHIFT, DCF77TC_P3_SHIFT);
+
+	return cand;
+}
+
+/*
+ * Reports every frame of the capture that is a valid block, in order of
+ * its first second, and returns their quantity.  Candidates are checked
+ * 64 starting seconds at a time on whole words of the bitplanes; only
+ * those with the right structure and parities get decoded.
+ */
+uint64_t
+DCF77Sync_Scan(const DCF77Bits_t * pBits, unsigned flags,
+	DCF77SyncFn_t fn, void * ctx)
+{
+	uint64_t frameSz = (flags & DCF77SYNC_NEEDS_MARK) ?
+	    DCF77TIMECODE_BITS_QTY : DCF77TC_MM_SHIFT;
+	uint64_t pos, found = 0;
+	DCF77Block_t block;
+
+	if (pBits->qty < frameSz)
+		return 0;
+
+	for (pos = 0; pos <= pBits->qty - frameSz; pos += 64) {
+		uint64_t cand = candidatesAt(pBits, pos, flags);
+
+		while (0u != cand) {
+			unsigned j = (unsigned)__builtin_ctzll(cand);
+			uint64_t start = pos + j;
+
+			cand &= cand - 1;
+			if (start > pBits->qty - frameSz)
+				break;
+
+			DCF77TimeCode_StoreWord(bitsAt(pBits->value, start) &
+			    FRAME_PULSES, &block);
+			if (0 == DCF77TimeCode_Validate(&block)) {
+				fn(ctx, start, &block);
+				++found;
+			}
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,34 @@
+#ifndef D_DCF77Sync_h
+#define D_DCF77Sync_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+/*
+ * A capture of received seconds as two bitplanes, bit N of the planes
+ * being second N: 'present' tells a pulse was seen, 'value' its bit.
+ */
+typedef struct {
+	uint64_t	*present;
+	uint64_t	*value;
+	uint64_t	 qty;		/* seconds */
+	size_t		 capWords;
+} DCF77Bits_t;
+
+enum {
+	DCF77SYNC_NEEDS_MARK = 0x1	/* no pulse in second 59 required */
+};
+
+typedef void (*DCF77SyncFn_t)(void * ctx, uint64_t second,
+	const DCF77Block_t * pBlock);
+
+void DCF77Sync_InitBits(DCF77Bits_t * pBits);
+void DCF77Sync_FreeBits(DCF77Bits_t * pBits);
+void DCF77Sync_AppendBit(DCF77Bits_t * pBits, int isPresent, int value);
+void DCF77Sync_AppendText(DCF77Bits_t * pBits, const char * text);
+
+uint64_t DCF77Sync_Scan(const DCF77Bits_t * pBits, unsigned flags,
+	DCF77SyncFn_t fn, void * ctx);
+
+#endif /* #ifndef D_DCF77Sync_h */
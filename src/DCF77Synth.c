@@ -0,0 +1,231 @@
+#include <err.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include "DCF77PM.h"
+#include "DCF77Synth.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+
+#define WAV_HEADER_SZ	44
+#define WAV_FMT_PCM	1
+#define WAV_FMT_FLOAT	3
+
+static void renderWave(const DCF77SynthParams_t * pParams,
+	unsigned pulseMs, unsigned pmBit, uint8_t * pWave);
+static void writeWAVHeader(DCF77Synth_t * pSynth);
+static void writeOut(DCF77Synth_t * pSynth, const void * data, size_t sz);
+
+/*
+ * DCF77 reduces the carrier to 15%; a sound card friendly subharmonic of
+ * 77.5 kHz is the default carrier.
+ */
+void
+DCF77Synth_DefaultParams(DCF77SynthParams_t * pParams)
+{
+	pParams->sampleRate = 48000;
+	pParams->carrierHz  = 15500;
+	pParams->depth      = 0.85;
+	pParams->level      = 0.9;
+	pParams->pmDegrees  = 0.0;
+	pParams->format     = DCF77SYNTH_S16;
+	pParams->wav        = 1;
+}
+
+/*
+ * "-" as 'path' stands for stdout.
+ */
+void
+DCF77Synth_Open(DCF77Synth_t * pSynth, const DCF77SynthParams_t * pParams,
+	const char * path)
+{
+	static const unsigned pulseMs[DCF77SYNTH_WAVES_QTY] = { 100, 200, 0 };
+	/* second 59 carries a 0 in phase */
+	static const unsigned pmBit[DCF77SYNTH_WAVES_QTY] = { 0, 1, 0 };
+	int i;
+
+	memset(pSynth, 0, sizeof(*pSynth));
+	pSynth->params = *pParams;
+	pSynth->path = path;
+
+	if (0 == pParams->sampleRate ||
+	    pParams->carrierHz * 2 >= pParams->sampleRate) {
+		errx(EX_USAGE, "carrier must be below half the sample rate");
+		/* NOTREACHED */
+	}
+
+	pSynth->bytesPerSample = (DCF77SYNTH_F32 == pParams->format) ?
+	    sizeof(float) : sizeof(int16_t);
+	pSynth->bytesPerSecond = pSynth->bytesPerSample * pParams->sampleRate;
+
+	for (i = 0; i < DCF77SYNTH_WAVES_QTY; ++i) {
+		pSynth->waves[i] = malloc(pSynth->bytesPerSecond);
+		if (NULL == pSynth->waves[i]) {
+			err(EX_OSERR, "no memory for waveforms");
+			/* NOTREACHED */
+		}
+		renderWave(pParams, pulseMs[i], pmBit[i], pSynth->waves[i]);
+	}
+
+	if (0 == strcmp(path, "-")) {
+		pSynth->out = stdout;
+	} else {
+		pSynth->out = fopen(path, "wb");
+		if (NULL == pSynth->out) {
+			err(EX_CANTCREAT, "%s", path);
+			/* NOTREACHED */
+		}
+	}
+
+	if (pParams->wav) {
+		/* sizes get fixed up by DCF77Synth_Close() when seekable */
+		writeWAVHeader(pSynth);
+	}
+}
+
+/*
+ * With PM the carrier phase is advanced for 0 chips and retarded for 1
+ * chips; there is nothing to shift in baseband.
+ */
+static void
+renderWave(const DCF77SynthParams_t * pParams, unsigned pulseMs,
+	unsigned pmBit, uint8_t * pWave)
+{
+	const double twoPi = 2.0 * 3.14159265358979323846;
+	unsigned rate = pParams->sampleRate;
+	unsigned pulseEnd = (unsigned)((uint64_t)rate * pulseMs / 1000);
+	double pmRad = pParams->pmDegrees * twoPi / 360.0;
+	uint64_t chips[DCF77PM_CHIP_WORDS];
+	unsigned n;
+
+	DCF77PM_SecondChips(pmBit, chips);
+
+	for (n = 0; n < rate; ++n) {
+		double v = pParams->level;
+		double phase = 0.0;
+		int chip;
+
+		if (n < pulseEnd) {
+			v *= 1.0 - pParams->depth;
+		}
+		if (0.0 != pmRad && (chip = DCF77PM_ChipAt(n, rate)) >= 0) {
+			phase = ((chips[chip / 64] >> (chip % 64)) & 1u) ?
+			    -pmRad : pmRad;
+		}
+		if (0 != pParams->carrierHz) {
+			/* reduced exactly, so phase stays exact over the second */
+			v *= sin(twoPi * (double)(((uint64_t)n *
+			    pParams->carrierHz) % rate) / rate + phase);
+		}
+
+		if (DCF77SYNTH_F32 == pParams->format) {
+			float f = (float)v;
+
+			memcpy(&pWave[n * sizeof(f)], &f, sizeof(f));
+		} else {
+			int16_t s = (int16_t)lrint(v * 32767.0);
+
+			pWave[2 * n]     = (uint8_t)((uint16_t)s & 0xFFu);
+			pWave[2 * n + 1] = (uint8_t)((uint16_t)s >> 8);
+		}
+	}
+}
+
+/*
+ * Block of the minute that follows: 59 pulses and a silent 59th second,
+ * or with a leap second 60 pulses (the last one a 0) and a silent 60th.
+ */
+void
+DCF77Synth_RenderMinute(DCF77Synth_t * pSynth, const DCF77Block_t * pBlock)
+{
+	unsigned pulses = DCF77TIMECODE_BITS_QTY - 1 +
+	    (DCF77TimeCode_HasLeapSecond(pBlock) ? 1u : 0u);
+	unsigned i;
+
+	for (i = 0; i < pulses; ++i) {
+		unsigned bit = (i < DCF77TIMECODE_BITS_QTY - 1) ?
+		    (pBlock->data[i / 8] >> (i % 8)) & 1u : 0u;
+
+		writeOut(pSynth, pSynth->waves[bit], pSynth->bytesPerSecond);
+	}
+	writeOut(pSynth, pSynth->waves[DCF77SYNTH_WAVE_NOPULSE],
+	    pSynth->bytesPerSecond);
+}
+
+void
+DCF77Synth_Close(DCF77Synth_t * pSynth)
+{
+	int i;
+
+	if (pSynth->params.wav && 0 == fseek(pSynth->out, 0L, SEEK_SET)) {
+		writeWAVHeader(pSynth);
+	}
+
+	if (0 != fflush(pSynth->out) ||
+	    (stdout != pSynth->out && 0 != fclose(pSynth->out))) {
+		err(EX_IOERR, "%s", pSynth->path);
+		/* NOTREACHED */
+	}
+
+	for (i = 0; i < DCF77SYNTH_WAVES_QTY; ++i) {
+		free(pSynth->waves[i]);
+	}
+	memset(pSynth, 0, sizeof(*pSynth));
+}
+
+static void
+writeOut(DCF77Synth_t * pSynth, const void * data, size_t sz)
+{
+	if (fwrite(data, 1, sz, pSynth->out) != sz) {
+		err(EX_IOERR, "%s", pSynth->path);
+		/* NOTREACHED */
+	}
+	pSynth->dataBytes += sz;
+}
+
+static void
+putLE(uint8_t * dst, uint32_t v, unsigned sz)
+{
+	unsigned i;
+
+	for (i = 0; i < sz; ++i) {
+		dst[i] = (uint8_t)(v >> (8 * i));
+	}
+}
+
+/*
+ * Sizes unknown yet (or too big for RIFF) are written as 0xFFFFFFFF,
+ * which most readers take as "till the end of file".
+ */
+static void
+writeWAVHeader(DCF77Synth_t * pSynth)
+{
+	uint8_t h[WAV_HEADER_SZ];
+	uint64_t data = pSynth->dataBytes;
+	uint32_t dataSz = (0u == data || data > 0xFFFFFFFFu - WAV_HEADER_SZ) ?
+	    0xFFFFFFFFu : (uint32_t)data;
+	uint32_t riffSz = (0xFFFFFFFFu == dataSz) ?
+	    0xFFFFFFFFu : dataSz + WAV_HEADER_SZ - 8;
+	unsigned bits = (unsigned)pSynth->bytesPerSample * 8;
+
+	memcpy(&h[0], "RIFF", 4);
+	putLE(&h[4], riffSz, 4);
+	memcpy(&h[8], "WAVEfmt ", 8);
+	putLE(&h[16], 16, 4);
+	putLE(&h[20], (DCF77SYNTH_F32 == pSynth->params.format) ?
+	    WAV_FMT_FLOAT : WAV_FMT_PCM, 2);
+	putLE(&h[22], 1, 2);			/* mono */
+	putLE(&h[24], pSynth->params.sampleRate, 4);
+	putLE(&h[28], (uint32_t)pSynth->bytesPerSecond, 4);
+	putLE(&h[32], (uint32_t)pSynth->bytesPerSample, 2);
+	putLE(&h[34], bits, 2);
+	memcpy(&h[36], "data", 4);
+	putLE(&h[40], dataSz, 4);
+
+	if (fwrite(h, sizeof(h), 1, pSynth->out) != 1) {
+		err(EX_IOERR, "%s", pSynth->path);
+		/* NOTREACHED */
+	}
+}
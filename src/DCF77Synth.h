@@ -0,0 +1,52 @@
+#ifndef D_DCF77Synth_h
+#define D_DCF77Synth_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+enum {
+	DCF77SYNTH_S16 = 0,	/* signed 16-bit little-endian */
+	DCF77SYNTH_F32		/* 32-bit IEEE float */
+};
+
+typedef struct {
+	unsigned	sampleRate;	/* Hz */
+	unsigned	carrierHz;	/* 0 renders baseband envelope */
+	double		depth;		/* amplitude reduction of pulses, 0-1 */
+	double		level;		/* full carrier amplitude, 0-1 */
+	double		pmDegrees;	/* phase deviation of chips, 0: no PM */
+	int		format;		/* DCF77SYNTH_... */
+	int		wav;		/* RIFF/WAVE header or raw samples */
+} DCF77SynthParams_t;
+
+enum {
+	DCF77SYNTH_WAVE_BIT0 = 0,
+	DCF77SYNTH_WAVE_BIT1,
+	DCF77SYNTH_WAVE_NOPULSE,
+	DCF77SYNTH_WAVES_QTY
+};
+
+/*
+ * A second of samples for each kind of second is rendered beforehand:
+ * with whole carrier cycles per second every second starts at phase 0,
+ * so the output is made of copies of these.
+ */
+typedef struct {
+	DCF77SynthParams_t	 params;
+	size_t			 bytesPerSample;
+	size_t			 bytesPerSecond;
+	uint8_t			*waves[DCF77SYNTH_WAVES_QTY];
+	FILE			*out;
+	const char		*path;
+	uint64_t		 dataBytes;
+} DCF77Synth_t;
+
+void DCF77Synth_DefaultParams(DCF77SynthParams_t * pParams);
+void DCF77Synth_Open(DCF77Synth_t * pSynth,
+	const DCF77SynthParams_t * pParams, const char * path);
+void DCF77Synth_RenderMinute(DCF77Synth_t * pSynth,
+	const DCF77Block_t * pBlock);
+void DCF77Synth_Close(DCF77Synth_t * pSynth);
+
+#endif /* #ifndef D_DCF77Synth_h */
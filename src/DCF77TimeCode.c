@@ -3,89 +3,372 @@
 #include <string.h>
 #include <time.h>
 #include "DCF77Block.h"
+#include "DCF77DSTTable.h"
+#include "DCF77LeapTable.h"
 #include "DCF77TimeCode.h"
 #include "DCF77TimeCodePrivate.h"
 #include "utils.h"
 
-static void timeCode_Init(union TimeCodeConversion_t * pTcc);
-static void timeCode_CopyIn(union TimeCodeConversion_t * pTcc,
-	const DCF77Block_t * pInBlock);
-static void timeCode_CopyOut(const union TimeCodeConversion_t * pTcc,
-	DCF77Block_t * pOutBlock);
+static void timeCode_ToStructTM(uint64_t w, struct tm * outStm);
+static long wallClockMinute(const struct tm * pStm);
 static unsigned int convertTwoDigitBCDtoInt(unsigned int v);
 static unsigned int convertIntToTwoDigitBCD(unsigned int v);
-static unsigned int computeEvenParityBit(unsigned int v);
-static void breakBlockToTimecodeFields(const DCF77Block_t * pBlock);
-static void splitBlockToStringOfBits(const DCF77Block_t * pBlock,
-	char outBits[]);
-static void regroupBitsIntoTimecodeFields(const char blockBits[]);
+static unsigned int incrementTwoDigitBCD(unsigned int v);
+static unsigned int daysInMonth(unsigned int monthBCD, unsigned int yearBCD);
 
+static const DCF77DSTTable_t * pDSTTable = NULL;
+static const DCF77LeapTable_t * pLeapTable = NULL;
 
+/*
+ * Once set, DST announcements and changes are resolved by the table
+ * (for the years it covers) instead of libc.  The table must stay intact
+ * while in use.
+ */
 void
-DCF77TimeCode_Init(DCF77Block_t * pBlock)
+DCF77TimeCode_UseDSTTable(const DCF77DSTTable_t * pTable)
+{
+	pDSTTable = pTable;
+}
+
+/*
+ * Once set, A2 announces the leap seconds of the table; without one it
+ * stays clear.  The table must stay intact while in use.
+ */
+void
+DCF77TimeCode_UseLeapTable(const DCF77LeapTable_t * pTable)
+{
+	pLeapTable = pTable;
+}
+
+/*
+ * The block sent in a minute with a leap second: A2 is up and the
+ * minute it encodes is the first of an hour, leap seconds ending UTC
+ * days.  Its second 59 carries a 0 and the mark moves to second 60.
+ */
+static inline int
+timeCode_HasLeapSecond(uint64_t w)
+{
+	return DCF77TC_GET(w, A2) && 0u == DCF77TC_GET(w, MIN);
+}
+
+int
+DCF77TimeCode_HasLeapSecond(const DCF77Block_t * pBlock)
 {
-	union TimeCodeConversion_t tcc;
+	return timeCode_HasLeapSecond(DCF77TimeCode_LoadWord(pBlock));
+}
 
+void
+DCF77TimeCode_Init(DCF77Block_t * pBlock)
+{
 	if (NULL == pBlock)
 		return;
 
-	timeCode_Init(&tcc);
-	timeCode_CopyOut(&tcc, pBlock);
+	DCF77TimeCode_StoreWord(DCF77TC_MASK(S), pBlock);
 }
 
-static void
-timeCode_Init(union TimeCodeConversion_t * pTcc)
+void
+DCF77TimeCode_ConvertToStructTM(const DCF77Block_t * pBlock,
+	struct tm * outStm)
 {
-	unsigned i;
+	if (NULL == pBlock || NULL == outStm)
+		return;
+
+	timeCode_ToStructTM(DCF77TimeCode_LoadWord(pBlock), outStm);
+}
 
-	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
-		pTcc->block.data[i] = 0u;
+/* bits covered by P1, P2 and P3 */
+#define TC_MIN_BITS	DCF77TC_MASK(MIN)
+#define TC_HOUR_BITS	DCF77TC_MASK(HOUR)
+#define TC_DATE_BITS	(DCF77TC_MASK(DOM) | DCF77TC_MASK(DOW) | \
+			 DCF77TC_MASK(MONTH) | DCF77TC_MASK(YEAR))
+
+/*
+ * Straight from the bits of the block to binary field values, struct tm
+ * is not involved.
+ */
+void
+DCF77TimeCode_DecodeFields(const DCF77Block_t * pBlock,
+	DCF77Fields_t * pFields)
+{
+	if (NULL == pBlock || NULL == pFields)
+		return;
+
+	DCF77TimeCode_DecodeFieldsBatch(pBlock, pFields, 1);
+}
+
+void
+DCF77TimeCode_DecodeFieldsBatch(const DCF77Block_t blocks[],
+	DCF77Fields_t fields[], size_t qty)
+{
+	size_t i;
+
+	for (i = 0; i < qty; ++i) {
+		uint64_t w = DCF77TimeCode_LoadWord(&blocks[i]);
+
+		fields[i].minute     = convertTwoDigitBCDtoInt(DCF77TC_GET(w, MIN));
+		fields[i].hour       = convertTwoDigitBCDtoInt(DCF77TC_GET(w, HOUR));
+		fields[i].dayOfMonth = convertTwoDigitBCDtoInt(DCF77TC_GET(w, DOM));
+		fields[i].dayOfWeek  = DCF77TC_GET(w, DOW);
+		fields[i].month      = convertTwoDigitBCDtoInt(DCF77TC_GET(w, MONTH));
+		fields[i].year       = convertTwoDigitBCDtoInt(DCF77TC_GET(w, YEAR));
+		fields[i].isdst      = DCF77TC_GET(w, Z1);
+		fields[i].flags      =
+		    (DCF77TC_GET(w, A1) * DCF77FIELDS_DST_ANNOUNCED) |
+		    (DCF77TC_GET(w, A2) * DCF77FIELDS_LEAP_ANNOUNCED) |
+		    (DCF77TC_GET(w, R)  * DCF77FIELDS_ABNORMAL_TX) |
+		    (timeCode_HasLeapSecond(w) * DCF77FIELDS_LEAP_SECOND);
 	}
+}
+
+/*
+ * Tens and units digits of a BCD field are checked apart, so values like
+ * 0x1A are caught, then the whole value against the field's range.
+ */
+static unsigned
+bcdFieldIsBad(unsigned v, unsigned min, unsigned max)
+{
+	unsigned units = v & 0x0Fu;
+	unsigned value = (v >> 4) * 10 + units;
 
-	pTcc->dcfTc.S  = 1;
+	return (units > 9) | (value < min) | (value > max);
 }
 
-static void
-timeCode_CopyOut(const union TimeCodeConversion_t * pTcc,
-	DCF77Block_t * pOutBlock)
+/*
+ * Comparisons and parities only, no branches: the cost is the same
+ * whatever the block holds.  Bits 59-63 of the block must be zero.
+ */
+unsigned
+DCF77TimeCode_Validate(const DCF77Block_t * pBlock)
 {
-	unsigned i;
+	uint64_t w = DCF77TimeCode_LoadWord(pBlock);
+	unsigned errors = 0u;
+
+	errors |= DCF77TC_GET(w, M) * DCF77TIMECODE_ERR_M;
+	errors |= (1u ^ DCF77TC_GET(w, S)) * DCF77TIMECODE_ERR_S;
+	errors |= (1u ^ DCF77TC_GET(w, Z1) ^ DCF77TC_GET(w, Z2)) *
+	    DCF77TIMECODE_ERR_Z;
+	errors |= (unsigned)__builtin_parityll(w & (TC_MIN_BITS |
+	    DCF77TC_MASK(P1))) * DCF77TIMECODE_ERR_P1;
+	errors |= (unsigned)__builtin_parityll(w & (TC_HOUR_BITS |
+	    DCF77TC_MASK(P2))) * DCF77TIMECODE_ERR_P2;
+	errors |= (unsigned)__builtin_parityll(w & (TC_DATE_BITS |
+	    DCF77TC_MASK(P3))) * DCF77TIMECODE_ERR_P3;
+	errors |= bcdFieldIsBad(DCF77TC_GET(w, MIN), 0, 59) *
+	    DCF77TIMECODE_ERR_MINUTE;
+	errors |= bcdFieldIsBad(DCF77TC_GET(w, HOUR), 0, 23) *
+	    DCF77TIMECODE_ERR_HOUR;
+	errors |= bcdFieldIsBad(DCF77TC_GET(w, DOM), 1, 31) *
+	    DCF77TIMECODE_ERR_DOM;
+	errors |= (unsigned)(0u == DCF77TC_GET(w, DOW)) *
+	    DCF77TIMECODE_ERR_DOW;
+	errors |= bcdFieldIsBad(DCF77TC_GET(w, MONTH), 1, 12) *
+	    DCF77TIMECODE_ERR_MONTH;
+	errors |= bcdFieldIsBad(DCF77TC_GET(w, YEAR), 0, 99) *
+	    DCF77TIMECODE_ERR_YEAR;
+	errors |= (unsigned)(0u != (w >> DCF77TC_MM_SHIFT)) *
+	    DCF77TIMECODE_ERR_TAIL;
+
+	return errors;
+}
 
-	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
-		pOutBlock->data[i] = pTcc->block.data[i];
+/*
+ * Returns how many blocks are faulty.
+ */
+size_t
+DCF77TimeCode_ValidateBatch(const DCF77Block_t blocks[], unsigned errors[],
+	size_t qty)
+{
+	size_t i, faulty = 0;
+
+	for (i = 0; i < qty; ++i) {
+		errors[i] = DCF77TimeCode_Validate(&blocks[i]);
+		faulty += (0u != errors[i]);
 	}
+
+	return faulty;
 }
 
+static const char * const errorNames[] = {
+	"M", "S", "Z", "P1", "P2", "P3",
+	"minute", "hour", "dom", "dow", "month", "year", "tail"
+};
+
+/*
+ * Comma separated names of the faults, truncated to fit 'bufSz'.
+ */
 void
-DCF77TimeCode_ConvertToStructTM(const DCF77Block_t * pBlock,
-	struct tm * outStm)
+DCF77TimeCode_DescribeErrors(unsigned errors, char * buf, size_t bufSz)
 {
-	union TimeCodeConversion_t tcc;
+	size_t i, len = 0;
 
-	if (NULL == pBlock || NULL == outStm)
+	if (0u == bufSz)
 		return;
 
-	timeCode_CopyIn(&tcc, pBlock);
+	buf[0] = '\0';
+	for (i = 0; i < sizeof(errorNames) / sizeof(errorNames[0]); ++i) {
+		if (0u == (errors & (1u << i)))
+			continue;
 
-        memset(outStm, 0, sizeof(struct tm));
-        outStm->tm_min   = convertTwoDigitBCDtoInt( tcc.dcfTc.minute );
-        outStm->tm_hour  = convertTwoDigitBCDtoInt( tcc.dcfTc.hour );
-        outStm->tm_mday  = convertTwoDigitBCDtoInt( tcc.dcfTc.dayOfMonth );
-        outStm->tm_mon   = convertTwoDigitBCDtoInt( tcc.dcfTc.month ) - 1;
-        outStm->tm_year  = convertTwoDigitBCDtoInt( tcc.dcfTc.year ) + 100;
-        outStm->tm_wday  = (7 == tcc.dcfTc.dayOfWeek) ?
-		0 : tcc.dcfTc.dayOfWeek;
-        outStm->tm_isdst = tcc.dcfTc.Z1;
+		len += (size_t)snprintf(&buf[len], bufSz - len, "%s%s",
+		    (0u == len) ? "" : ",", errorNames[i]);
+		if (len >= bufSz)
+			break;
+	}
 }
 
-static void
-timeCode_CopyIn(union TimeCodeConversion_t * pTcc,
-	const DCF77Block_t * pInBlock)
+/*
+ * Bits a correct successor of a block is known to have; weather, R, A1
+ * and A2 may change at any minute.
+ */
+#define TC_PREDICTABLE_BITS \
+	(DCF77TC_MASK(M) | DCF77TC_MASK(Z1) | DCF77TC_MASK(Z2) | \
+	 DCF77TC_MASK(S) | DCF77TC_MASK(P1) | DCF77TC_MASK(P2) | \
+	 DCF77TC_MASK(P3) | TC_MIN_BITS | TC_HOUR_BITS | TC_DATE_BITS)
+
+/* past the minute, nothing to keep */
+#define TC_TAIL_BITS	(~UINT64_C(0) << DCF77TC_MM_SHIFT)
+
+/*
+ * Fixes a single-bit error of 'pBlock', the block received right after
+ * the valid 'pPrev'.  Every single flip of a checked bit that makes the
+ * block valid is a candidate; the one closest to the minute following
+ * 'pPrev' wins, provided no other is as close.  Bits 59-63 are cleared
+ * beforehand, 'pPrev' (which may be NULL) not needed for that.
+ */
+int
+DCF77TimeCode_Repair(const DCF77Block_t * pPrev, DCF77Block_t * pBlock)
 {
-	unsigned i;
+	DCF77Block_t expected, candidate;
+	uint64_t w, want;
+	int best = -1, bestDistance = 64, isTie = 0;
+	int i;
+
+	if (0u == DCF77TimeCode_Validate(pBlock))
+		return DCF77TIMECODE_REPAIR_INTACT;
+
+	w = DCF77TimeCode_LoadWord(pBlock) & ~TC_TAIL_BITS;
+	DCF77TimeCode_StoreWord(w, &candidate);
+	if (0u == DCF77TimeCode_Validate(&candidate)) {
+		*pBlock = candidate;
+		return DCF77TIMECODE_REPAIR_FIXED;
+	}
+
+	if (NULL == pPrev || 0u != DCF77TimeCode_Validate(pPrev))
+		return DCF77TIMECODE_REPAIR_FAILED;
+
+	expected = *pPrev;
+	DCF77TimeCode_AdvanceByMinute(&expected);
+	want = DCF77TimeCode_LoadWord(&expected) & TC_PREDICTABLE_BITS;
 
-	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
-		pTcc->block.data[i] = pInBlock->data[i];
+	for (i = 0; i < DCF77TC_MM_SHIFT; ++i) {
+		uint64_t flipped = w ^ (UINT64_C(1) << i);
+		int distance;
+
+		if (0u == ((TC_PREDICTABLE_BITS >> i) & 1u))
+			continue;
+
+		DCF77TimeCode_StoreWord(flipped, &candidate);
+		if (0u != DCF77TimeCode_Validate(&candidate))
+			continue;
+
+		distance = __builtin_popcountll(
+		    (flipped & TC_PREDICTABLE_BITS) ^ want);
+		if (distance < bestDistance) {
+			best = i;
+			bestDistance = distance;
+			isTie = 0;
+		} else if (distance == bestDistance) {
+			isTie = 1;
+		}
+	}
+
+	if (best < 0 || isTie)
+		return DCF77TIMECODE_REPAIR_FAILED;
+
+	DCF77TimeCode_StoreWord(w ^ (UINT64_C(1) << best), pBlock);
+
+	return DCF77TIMECODE_REPAIR_FIXED;
+}
+
+/* blocks decoded into fields at once by the batch conversion */
+#define TC_BATCH_CHUNK	64
+
+void
+DCF77TimeCode_ConvertToStructTMBatch(const DCF77Block_t blocks[],
+	struct tm stms[], size_t qty)
+{
+	DCF77Fields_t fields[TC_BATCH_CHUNK];
+	size_t i, k, n;
+
+	if (NULL == blocks || NULL == stms)
+		return;
+
+	for (i = 0; i < qty; i += n) {
+		n = (qty - i < TC_BATCH_CHUNK) ? qty - i : TC_BATCH_CHUNK;
+		DCF77TimeCode_DecodeFieldsBatch(&blocks[i], fields, n);
+
+		for (k = 0; k < n; ++k) {
+			struct tm * pStm = &stms[i + k];
+
+			memset(pStm, 0, sizeof(struct tm));
+			pStm->tm_min   = fields[k].minute;
+			pStm->tm_hour  = fields[k].hour;
+			pStm->tm_mday  = fields[k].dayOfMonth;
+			pStm->tm_mon   = fields[k].month - 1;
+			pStm->tm_year  = fields[k].year + 100;
+			pStm->tm_wday  = fields[k].dayOfWeek % 7;
+			pStm->tm_isdst = fields[k].isdst;
+		}
+	}
+}
+
+static uint64_t timeCode_PackStructTM(const struct tm * inStm);
+static int timeCode_DSTChangeApproaching(const struct tm * inStm);
+static int timeCode_LeapApproaching(const struct tm * inStm);
+
+static int
+sameHour(const struct tm * pA, const struct tm * pB)
+{
+	return (pA->tm_hour == pB->tm_hour && pA->tm_mday == pB->tm_mday &&
+	    pA->tm_mon == pB->tm_mon && pA->tm_year == pB->tm_year &&
+	    pA->tm_isdst == pB->tm_isdst);
+}
+
+/*
+ * The time and date are packed first, with no lookups.  Then A1 and A2:
+ * DST changes fall on the hour, so A1 is looked up once per hour of the
+ * batch rather than once per block; A2 only with a leap table in use.
+ */
+void
+DCF77TimeCode_ConvertFromStructTMBatch(DCF77Block_t blocks[],
+	const struct tm stms[], size_t qty)
+{
+	const struct tm * pHour = NULL;
+	unsigned a1 = 0;
+	size_t i;
+
+	if (NULL == blocks || NULL == stms)
+		return;
+
+	for (i = 0; i < qty; ++i) {
+		DCF77TimeCode_StoreWord(timeCode_PackStructTM(&stms[i]),
+		    &blocks[i]);
+	}
+
+	for (i = 0; i < qty; ++i) {
+		uint64_t w = DCF77TimeCode_LoadWord(&blocks[i]);
+
+		if (NULL == pHour || !sameHour(pHour, &stms[i])) {
+			pHour = &stms[i];
+			a1 = (unsigned)timeCode_DSTChangeApproaching(pHour);
+		}
+		w = DCF77TC_PUT(w, A1, a1);
+		if (NULL != pLeapTable) {
+			w = DCF77TC_PUT(w, A2,
+			    timeCode_LeapApproaching(&stms[i]));
+		}
+
+		DCF77TimeCode_StoreWord(w, &blocks[i]);
 	}
 }
 
@@ -98,55 +381,252 @@ convertTwoDigitBCDtoInt(unsigned int v)
         return (10 * hi + lo);
 }
 
-static int timeCode_DSTChangeApproaching(const struct tm * inStm);
+/*
+ * Each parity bit sits right past the bits it covers.
+ */
+static uint64_t
+timeCode_SetParities(uint64_t w)
+{
+	w = DCF77TC_PUT(w, P1, __builtin_parityll(w & TC_MIN_BITS));
+	w = DCF77TC_PUT(w, P2, __builtin_parityll(w & TC_HOUR_BITS));
+
+	return DCF77TC_PUT(w, P3, __builtin_parityll(w & TC_DATE_BITS));
+}
 
 /*
- * We assume that our input (struct tm) has sane values in its fields.
+ * We assume that our input (struct tm) has sane values in its fields,
+ * tm_gmtoff included (as localtime_r(3) leaves it) when a leap table is
+ * in use.
  */
 void
 DCF77TimeCode_ConvertFromStructTM(DCF77Block_t * pBlock,
 	const struct tm * inStm)
 {
-	union TimeCodeConversion_t tcc;
+	uint64_t w;
 
 	if (NULL == pBlock || NULL == inStm)
 		return;
 
-	timeCode_Init(&tcc);
+	w = timeCode_PackStructTM(inStm);
+	w = DCF77TC_PUT(w, A1, timeCode_DSTChangeApproaching(inStm));
+	w = DCF77TC_PUT(w, A2, timeCode_LeapApproaching(inStm));
+
+	DCF77TimeCode_StoreWord(w, pBlock);
+}
+
+/*
+ * All but A1 and A2, which take lookups; the parities do not cover them.
+ */
+static uint64_t
+timeCode_PackStructTM(const struct tm * inStm)
+{
+	uint64_t w;
+	unsigned wday;
+
+	wday = (0 == inStm->tm_wday) ? 7u : (unsigned)inStm->tm_wday;
+
+	w = DCF77TC_MASK(S);
+	w = DCF77TC_PUT(w, Z1, inStm->tm_isdst ? 1u : 0u);
+	w = DCF77TC_PUT(w, Z2, inStm->tm_isdst ? 0u : 1u);
+	w = DCF77TC_PUT(w, MIN, convertIntToTwoDigitBCD(inStm->tm_min));
+	w = DCF77TC_PUT(w, HOUR, convertIntToTwoDigitBCD(inStm->tm_hour));
+	w = DCF77TC_PUT(w, DOM, convertIntToTwoDigitBCD(inStm->tm_mday));
+	w = DCF77TC_PUT(w, DOW, wday);
+	w = DCF77TC_PUT(w, MONTH, convertIntToTwoDigitBCD(inStm->tm_mon + 1));
+	w = DCF77TC_PUT(w, YEAR, convertIntToTwoDigitBCD(inStm->tm_year));
+
+	return timeCode_SetParities(w);
+}
+
+static uint64_t timeCode_AdvanceViaStructTM(uint64_t w);
+static uint64_t timeCode_IncrementMinute(uint64_t w);
+static uint64_t timeCode_AdvanceA2(uint64_t prev, uint64_t w);
+static uint64_t timeCode_IncrementDate(uint64_t w);
+
+/*
+ * Turns the block into the block of the next minute.  Time and date
+ * fields are carried in BCD right within the block, so libc is consulted
+ * only once per hour (to learn whether a DST change is approaching) and
+ * throughout the hour announcing a DST change (A1 asserted), when the
+ * minute is advanced by means of mktime(3) and localtime_r(3).  A2 is
+ * carried along and looked up in the leap table once per hour.
+ */
+void
+DCF77TimeCode_AdvanceByMinute(DCF77Block_t * pBlock)
+{
+	uint64_t prev, w;
+
+	if (NULL == pBlock)
+		return;
 
-	int mon  = inStm->tm_mon + 1;
-	int wday = inStm->tm_wday;
+	prev = DCF77TimeCode_LoadWord(pBlock);
 
-	wday = (0 == wday) ? 7 : wday;
+	if (DCF77TC_GET(prev, A1)) {
+		w = timeCode_AdvanceViaStructTM(prev);
+	} else {
+		w = timeCode_IncrementMinute(prev);
+	}
 
-	tcc.dcfTc.A1 = timeCode_DSTChangeApproaching(inStm);
+	DCF77TimeCode_StoreWord(timeCode_AdvanceA2(prev, w), pBlock);
+}
 
-	if (inStm->tm_isdst) {
-		tcc.dcfTc.Z1 = 1;
-		tcc.dcfTc.Z2 = 0;
+/*
+ * Announcements start with minute 01 and end with minute 00 of the next
+ * hour, so only minute 01 needs the table.  The block carries no UTC
+ * offset: it is taken from the DST table when that covers the year,
+ * from mktime(3) otherwise.
+ */
+static uint64_t
+timeCode_AdvanceA2(uint64_t prev, uint64_t w)
+{
+	struct tm stm;
+	time_t t;
+	long wall;
+
+	if (NULL == pLeapTable)
+		return w;
+	if (0x01u != DCF77TC_GET(w, MIN))
+		return DCF77TC_PUT(w, A2, DCF77TC_GET(prev, A2));
+
+	timeCode_ToStructTM(w, &stm);
+	if (DCF77DSTTable_Covers(pDSTTable, stm.tm_year + 1900)) {
+		wall = wallClockMinute(&stm);
+		t = (time_t)wall * 60 - DCF77DSTTable_UTCOffset(pDSTTable,
+		    wall, stm.tm_isdst);
 	} else {
-		tcc.dcfTc.Z1 = 0;
-		tcc.dcfTc.Z2 = 1;
+		t = mktime(&stm);
+	}
+
+	return DCF77TC_PUT(w, A2, DCF77LeapTable_Announced(pLeapTable, t));
+}
+
+static void
+timeCode_ToStructTM(uint64_t w, struct tm * outStm)
+{
+	unsigned dow = DCF77TC_GET(w, DOW);
+
+	memset(outStm, 0, sizeof(struct tm));
+	outStm->tm_min   = convertTwoDigitBCDtoInt(DCF77TC_GET(w, MIN));
+	outStm->tm_hour  = convertTwoDigitBCDtoInt(DCF77TC_GET(w, HOUR));
+	outStm->tm_mday  = convertTwoDigitBCDtoInt(DCF77TC_GET(w, DOM));
+	outStm->tm_mon   = convertTwoDigitBCDtoInt(DCF77TC_GET(w, MONTH)) - 1;
+	outStm->tm_year  = convertTwoDigitBCDtoInt(DCF77TC_GET(w, YEAR)) + 100;
+	outStm->tm_wday  = (7 == dow) ? 0 : (int)dow;
+	outStm->tm_isdst = (int)DCF77TC_GET(w, Z1);
+}
+
+static void advanceStructTMViaDSTTable(struct tm * pStm);
+
+/*
+ * DST is known from the block itself, so both mktime(3) and the DST table
+ * resolve the repeated hour unambiguously.
+ */
+static uint64_t
+timeCode_AdvanceViaStructTM(uint64_t w)
+{
+	DCF77Block_t next;
+	struct tm stm;
+	time_t t;
+
+	timeCode_ToStructTM(w, &stm);
+
+	if (DCF77DSTTable_Covers(pDSTTable, stm.tm_year + 1900)) {
+		advanceStructTMViaDSTTable(&stm);
+	} else {
+		stm.tm_min += 1;
+		t = mktime(&stm);
+		(void)localtime_r(&t, &stm);
+	}
+
+	DCF77TimeCode_ConvertFromStructTM(&next, &stm);
+
+	return DCF77TimeCode_LoadWord(&next);
+}
+
+static void
+advanceStructTMViaDSTTable(struct tm * pStm)
+{
+	const DCF77DSTTransition_t * pTr;
+	long wall = wallClockMinute(pStm);
+	long days;
+
+	pTr = DCF77DSTTable_NextTransition(pDSTTable, wall, pStm->tm_isdst);
+	wall += 1;
+	if (NULL != pTr && pTr->wallMinute == wall) {
+		wall += pTr->shiftMinutes;
+		pStm->tm_isdst = pTr->isdstAfter;
+	}
+
+	days = wall / (24 * 60);
+	civilFromDays(days, &pStm->tm_year, &pStm->tm_mon, &pStm->tm_mday);
+	pStm->tm_year -= 1900;
+	pStm->tm_mon  -= 1;
+	pStm->tm_hour  = (int)(wall / 60 % 24);
+	pStm->tm_min   = (int)(wall % 60);
+	pStm->tm_wday  = (int)((days + 4) % 7);	/* 1970-01-01 is Thursday */
+}
+
+static uint64_t
+timeCode_IncrementMinute(uint64_t w)
+{
+	struct tm stm;
+	unsigned minute = incrementTwoDigitBCD(DCF77TC_GET(w, MIN));
+	unsigned hour;
+
+	minute = (0x60u == minute) ? 0x00u : minute;
+	w = DCF77TC_PUT(w, MIN, minute);
+	w = DCF77TC_PUT(w, P1, __builtin_parityll(w & TC_MIN_BITS));
+
+	if (0x00u != minute)
+		return w;
+
+	hour = incrementTwoDigitBCD(DCF77TC_GET(w, HOUR));
+	if (0x24u == hour) {
+		hour = 0x00u;
+		w = timeCode_IncrementDate(w);
+	}
+	w = DCF77TC_PUT(w, HOUR, hour);
+	w = DCF77TC_PUT(w, P2, __builtin_parityll(w & TC_HOUR_BITS));
+
+	/* a new hour may be the one announcing a DST change */
+	timeCode_ToStructTM(w, &stm);
+
+	return DCF77TC_PUT(w, A1, timeCode_DSTChangeApproaching(&stm));
+}
+
+static uint64_t
+timeCode_IncrementDate(uint64_t w)
+{
+	unsigned dom = incrementTwoDigitBCD(DCF77TC_GET(w, DOM));
+	unsigned month = DCF77TC_GET(w, MONTH);
+	unsigned year = DCF77TC_GET(w, YEAR);
+
+	w = DCF77TC_PUT(w, DOW, DCF77TC_GET(w, DOW) % 7 + 1);
+
+	if (convertTwoDigitBCDtoInt(dom) > daysInMonth(month, year)) {
+		dom = 0x01u;
+		month = incrementTwoDigitBCD(month);
+
+		if (0x13u == month) {
+			month = 0x01u;
+			year = incrementTwoDigitBCD(year);
+		}
 	}
 
-	tcc.dcfTc.minute	= convertIntToTwoDigitBCD( inStm->tm_min );
-	tcc.dcfTc.hour		= convertIntToTwoDigitBCD( inStm->tm_hour );
-	tcc.dcfTc.dayOfMonth	= convertIntToTwoDigitBCD( inStm->tm_mday );
-	tcc.dcfTc.dayOfWeek	= convertIntToTwoDigitBCD( wday );
-	tcc.dcfTc.month		= convertIntToTwoDigitBCD( mon );
-	tcc.dcfTc.year		= convertIntToTwoDigitBCD( inStm->tm_year );
+	w = DCF77TC_PUT(w, DOM, dom);
+	w = DCF77TC_PUT(w, MONTH, month);
+	w = DCF77TC_PUT(w, YEAR, year);
 
-	/* set parities */
-	tcc.dcfTc.P1 = computeEvenParityBit( tcc.dcfTc.minute );
-	tcc.dcfTc.P2 = computeEvenParityBit( tcc.dcfTc.hour   );
-	unsigned c = 0u;
-	c += computeEvenParityBit( tcc.dcfTc.dayOfMonth	);
-	c += computeEvenParityBit( tcc.dcfTc.dayOfWeek	);
-	c += computeEvenParityBit( tcc.dcfTc.month	);
-	c += computeEvenParityBit( tcc.dcfTc.year	);
-	tcc.dcfTc.P3 = (c % 2);
+	return DCF77TC_PUT(w, P3, __builtin_parityll(w & TC_DATE_BITS));
+}
+
+static long
+wallClockMinute(const struct tm * pStm)
+{
+	long days = daysFromCivil(pStm->tm_year + 1900, pStm->tm_mon + 1,
+	    pStm->tm_mday);
 
-	timeCode_CopyOut(&tcc, pBlock);
+	return (days * 24 + pStm->tm_hour) * 60 + pStm->tm_min;
 }
 
 static int
@@ -154,243 +634,185 @@ timeCode_DSTChangeApproaching(const struct tm * inStm)
 {
 	struct tm nextHourTM = *inStm;
 
+	if (DCF77DSTTable_Covers(pDSTTable, inStm->tm_year + 1900)) {
+		return DCF77DSTTable_ChangeApproaching(pDSTTable,
+		    wallClockMinute(inStm), inStm->tm_isdst);
+	}
+
 	nextHourTM.tm_hour += 1;
 	normalizeStructTM(&nextHourTM);
 
 	return (inStm->tm_isdst != nextHourTM.tm_isdst);
 }
 
+/*
+ * UTC offset taken from the struct tm, no libc involved.
+ */
+static int
+timeCode_LeapApproaching(const struct tm * inStm)
+{
+	if (NULL == pLeapTable)
+		return 0;
+
+	return DCF77LeapTable_Announced(pLeapTable,
+	    (time_t)wallClockMinute(inStm) * 60 - inStm->tm_gmtoff);
+}
+
+#define BCD_TENS(t)							\
+	0x##t##0, 0x##t##1, 0x##t##2, 0x##t##3, 0x##t##4,		\
+	0x##t##5, 0x##t##6, 0x##t##7, 0x##t##8, 0x##t##9
+
+static const uint8_t intToTwoDigitBCD[100] = {
+	BCD_TENS(0), BCD_TENS(1), BCD_TENS(2), BCD_TENS(3), BCD_TENS(4),
+	BCD_TENS(5), BCD_TENS(6), BCD_TENS(7), BCD_TENS(8), BCD_TENS(9)
+};
+
 static unsigned int
 convertIntToTwoDigitBCD(unsigned int v)
 {
-	v %= 100u;
+	return intToTwoDigitBCD[v % 100u];
+}
 
-	unsigned hi = v / 10;
-	unsigned lo = v % 10;
+/*
+ * 0x99 wraps around to 0x00 (which is the century carry for the year).
+ */
+static unsigned int
+incrementTwoDigitBCD(unsigned int v)
+{
+	v += 1u;
+
+	if (0x0Au == (v & 0x0Fu)) {
+		v += 0x06u;
+	}
 
-	return ((hi << 4) + lo);
+	return (0xA0u == v) ? 0x00u : v;
 }
 
+/*
+ * The year within century is enough to tell leap years within 2000-2099.
+ */
 static unsigned int
-computeEvenParityBit(unsigned int v)
+daysInMonth(unsigned int monthBCD, unsigned int yearBCD)
 {
-	unsigned i, mask = 1u, onesQty = 0;
+	static const unsigned char monthLength[12] = {
+		31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+	};
+	unsigned month = convertTwoDigitBCDtoInt(monthBCD);
+	unsigned year  = convertTwoDigitBCDtoInt(yearBCD);
 
-	for (i = 0; i < (sizeof(v) * 8u); ++i) {
-		if ( (v & mask) ) {
-			++onesQty;
-		}
-		mask <<= 1;
-	}
+	if (month < 1 || month > 12)
+		return 31;
 
-	return (onesQty % 2);
-}
-
-static const char  f0name[] = "M";
-static const char  f0desc[] = "Start of minute";
-static const char  f1name[] = "weather";
-static const char  f1desc[] = "Weather info";
-static const char  f2name[] = "R";
-static const char  f2desc[] = "Abnormal transmitter operation";
-static const char  f3name[] = "A1";
-static const char  f3desc[] = "Summer time announcement";
-static const char  f4name[] = "Z1";
-static const char  f4desc[] = "CEST in effect";
-static const char  f5name[] = "Z2";
-static const char  f5desc[] = "CET in effect";
-static const char  f6name[] = "A2";
-static const char  f6desc[] = "Leap second announcement";
-static const char  f7name[] = "S";
-static const char  f7desc[] = "Start of encoded time";
-static const char  f8name[] = "min";
-static const char  f8desc[] = "Minutes 00-59";
-static const char  f9name[] = "P1";
-static const char  f9desc[] = "Even parity over minute bits";
-static const char f10name[] = "hour";
-static const char f10desc[] = "Hours 00-23";
-static const char f11name[] = "P2";
-static const char f11desc[] = "Even parity over hour bits";
-static const char f12name[] = "dom";
-static const char f12desc[] = "Day of month";
-static const char f13name[] = "dow";
-static const char f13desc[] = "Day of week (Mon=1, Sun=7)";
-static const char f14name[] = "month";
-static const char f14desc[] = "Month number 01-12";
-static const char f15name[] = "year";
-static const char f15desc[] = "Year within century 00-99";
-static const char f16name[] = "P3";
-static const char f16desc[] = "Parity over date bits";
-static const char f17name[] = "-";
-static const char f17desc[] = "Minute Mark (no AM)";
-
-#define FIELDSPLIT_ROWS_QTY 18
-#define FIELDSPLIT_BINSTR_SZ 16
-#define FIELDSPLIT_HEXSTR_SZ 8
-
-static struct {
+	if (2 == month && 0 == (year % 4))
+		return 29;
+
+	return monthLength[month - 1];
+}
+
+#define FIELD_SPLIT_ROW(id, offset, length, name, desc)		\
+	{ (offset), (length), (name), (desc) },
+
+static const struct {
 	const unsigned	 offset;
 	const unsigned	 length;
 	const char	*name;
 	const char	*desc;
-	unsigned	 value;
-	char		 valueAsBinStr[FIELDSPLIT_BINSTR_SZ];
-	char		 valueAsHexStr[FIELDSPLIT_HEXSTR_SZ];
-} fieldSplit[FIELDSPLIT_ROWS_QTY] = {
-	{  0,   1,   f0name,   f0desc,  0,  "\0",  "\0" },
-	{  1,  14,   f1name,   f1desc,  0,  "\0",  "\0" },
-	{ 15,   1,   f2name,   f2desc,  0,  "\0",  "\0" },
-	{ 16,   1,   f3name,   f3desc,  0,  "\0",  "\0" },
-	{ 17,   1,   f4name,   f4desc,  0,  "\0",  "\0" },
-	{ 18,   1,   f5name,   f5desc,  0,  "\0",  "\0" },
-	{ 19,   1,   f6name,   f6desc,  0,  "\0",  "\0" },
-	{ 20,   1,   f7name,   f7desc,  0,  "\0",  "\0" },
-	{ 21,   7,   f8name,   f8desc,  0,  "\0",  "\0" },
-	{ 28,   1,   f9name,   f9desc,  0,  "\0",  "\0" },
-	{ 29,   6,  f10name,  f10desc,  0,  "\0",  "\0" },
-	{ 35,   1,  f11name,  f11desc,  0,  "\0",  "\0" },
-	{ 36,   6,  f12name,  f12desc,  0,  "\0",  "\0" },
-	{ 42,   3,  f13name,  f13desc,  0,  "\0",  "\0" },
-	{ 45,   5,  f14name,  f14desc,  0,  "\0",  "\0" },
-	{ 50,   8,  f15name,  f15desc,  0,  "\0",  "\0" },
-	{ 58,   1,  f16name,  f16desc,  0,  "\0",  "\0" },
-	{ 59,   1,  f17name,  f17desc,  0,  "\0",  "\0" },
+} fieldSplit[DCF77FIELDSPLIT_ROWS_QTY] = {
+	DCF77TIMECODE_FIELDS(FIELD_SPLIT_ROW)
 };
 
-static const DCF77FieldViews_t  fieldsViews[FIELDSPLIT_ROWS_QTY] = {
-    {	&fieldSplit[0].valueAsBinStr[0],
-	&fieldSplit[0].valueAsHexStr[0],
-	f0name,
-	f0desc					},
-    {	&fieldSplit[1].valueAsBinStr[0],
-	&fieldSplit[1].valueAsHexStr[0],
-	f1name,
-	f1desc					},
-    {	&fieldSplit[2].valueAsBinStr[0],
-	&fieldSplit[2].valueAsHexStr[0],
-	f2name,
-	f2desc					},
-    {	&fieldSplit[3].valueAsBinStr[0],
-	&fieldSplit[3].valueAsHexStr[0],
-	f3name,
-	f3desc					},
-    {	&fieldSplit[4].valueAsBinStr[0],
-	&fieldSplit[4].valueAsHexStr[0],
-	f4name,
-	f4desc					},
-    {	&fieldSplit[5].valueAsBinStr[0],
-	&fieldSplit[5].valueAsHexStr[0],
-	f5name,
-	f5desc					},
-    {	&fieldSplit[6].valueAsBinStr[0],
-	&fieldSplit[6].valueAsHexStr[0],
-	f6name,
-	f6desc					},
-    {	&fieldSplit[7].valueAsBinStr[0],
-	&fieldSplit[7].valueAsHexStr[0],
-	f7name,
-	f7desc					},
-    {	&fieldSplit[8].valueAsBinStr[0],
-	&fieldSplit[8].valueAsHexStr[0],
-	f8name,
-	f8desc					},
-    {	&fieldSplit[9].valueAsBinStr[0],
-	&fieldSplit[9].valueAsHexStr[0],
-	f9name,
-	f9desc					},
-    {	&fieldSplit[10].valueAsBinStr[0],
-	&fieldSplit[10].valueAsHexStr[0],
-	f10name,
-	f10desc					},
-    {	&fieldSplit[11].valueAsBinStr[0],
-	&fieldSplit[11].valueAsHexStr[0],
-	f11name,
-	f11desc					},
-    {	&fieldSplit[12].valueAsBinStr[0],
-	&fieldSplit[12].valueAsHexStr[0],
-	f12name,
-	f12desc					},
-    {	&fieldSplit[13].valueAsBinStr[0],
-	&fieldSplit[13].valueAsHexStr[0],
-	f13name,
-	f13desc					},
-    {	&fieldSplit[14].valueAsBinStr[0],
-	&fieldSplit[14].valueAsHexStr[0],
-	f14name,
-	f14desc					},
-    {	&fieldSplit[15].valueAsBinStr[0],
-	&fieldSplit[15].valueAsHexStr[0],
-	f15name,
-	f15desc					},
-    {	&fieldSplit[16].valueAsBinStr[0],
-	&fieldSplit[16].valueAsHexStr[0],
-	f16name,
-	f16desc					},
-    {	&fieldSplit[17].valueAsBinStr[0],
-	&fieldSplit[17].valueAsHexStr[0],
-	f17name,
-	f17desc					},
-};
+/* backs the non-reentrant DCF77TimeCode_SplitInFields() */
+static DCF77FieldSplit_t sharedFieldSplit;
 
 void
 DCF77TimeCode_SplitInFields(const DCF77Block_t * pBlock,
     const DCF77FieldViews_t * pFieldsViews[],
     size_t * fieldsViewsSz)
 {
-	breakBlockToTimecodeFields(pBlock);
+	DCF77TimeCode_SplitInFieldsR(pBlock, &sharedFieldSplit,
+	    DCF77FIELDSPLIT_BINSTR | DCF77FIELDSPLIT_HEXSTR);
 
-	*pFieldsViews  = fieldsViews;
-	*fieldsViewsSz = FIELDSPLIT_ROWS_QTY;
+	*pFieldsViews  = sharedFieldSplit.views;
+	*fieldsViewsSz = DCF77FIELDSPLIT_ROWS_QTY;
 }
 
-static void
-breakBlockToTimecodeFields(const DCF77Block_t * pBlock)
-{
-	char blockBits[DCF77TIMECODE_BITS_QTY];
+static void formatFieldAsBinStr(unsigned value, unsigned length,
+	char binStr[]);
+static void formatFieldAsHexStr(unsigned value, char hexStr[]);
 
-	splitBlockToStringOfBits(pBlock, blockBits);
-	regroupBitsIntoTimecodeFields(blockBits);
-}
-
-static void
-splitBlockToStringOfBits(const DCF77Block_t * pBlock, char outBits[])
+/*
+ * Reentrant: everything lands in the caller's 'pSplit'.  Field values are
+ * always filled in, their textual forms only when asked for by 'flags';
+ * views of strings not asked for are NULL.
+ */
+void
+DCF77TimeCode_SplitInFieldsR(const DCF77Block_t * pBlock,
+	DCF77FieldSplit_t * pSplit, unsigned flags)
 {
+	uint64_t w;
 	unsigned i;
 
-	for (i = 0; i < DCF77TIMECODE_BITS_QTY; ++i) {
-		unsigned byteIdx = i / 8;
-		unsigned bitMask = 1u << (i % 8);
+	if (NULL == pBlock || NULL == pSplit)
+		return;
+
+	w = DCF77TimeCode_LoadWord(pBlock);
 
-		outBits[i] = (pBlock->data[byteIdx] & bitMask) ? 1 : 0;
+	for (i = 0; i < DCF77FIELDSPLIT_ROWS_QTY; ++i) {
+		unsigned length = fieldSplit[i].length;
+		unsigned value = (unsigned)(w >> fieldSplit[i].offset) &
+		    ((1u << length) - 1u);
+		DCF77FieldViews_t * pView = &pSplit->views[i];
+
+		pSplit->value[i] = value;
+		pView->name      = fieldSplit[i].name;
+		pView->nameDescr = fieldSplit[i].desc;
+		pView->asBinStr  = NULL;
+		pView->asHexStr  = NULL;
+
+		if (flags & DCF77FIELDSPLIT_BINSTR) {
+			formatFieldAsBinStr(value, length, pSplit->asBinStr[i]);
+			pView->asBinStr = pSplit->asBinStr[i];
+		}
+		if (flags & DCF77FIELDSPLIT_HEXSTR) {
+			formatFieldAsHexStr(value, pSplit->asHexStr[i]);
+			pView->asHexStr = pSplit->asHexStr[i];
+		}
+	}
+
+	if (timeCode_HasLeapSecond(w)) {
+		pSplit->views[DCF77FIELDSPLIT_ROWS_QTY - 1].nameDescr =
+		    "Leap second: 0 here, no AM in second 60";
 	}
 }
 
+/*
+ * Least significant bit goes first, the way bits are transmitted.
+ */
 static void
-regroupBitsIntoTimecodeFields(const char blockBits[])
+formatFieldAsBinStr(unsigned value, unsigned length, char binStr[])
 {
-	unsigned i, j;
+	unsigned j;
 
-	for (i = 0; i < FIELDSPLIT_ROWS_QTY; ++i) {
-		unsigned offset = fieldSplit[i].offset;
-		unsigned length = fieldSplit[i].length;
-		unsigned collected = 0u;
-		unsigned mask = 1u;
-
-		for (j = 0; j < length; ++j) {
-			unsigned currBit = blockBits[offset + j];
+	for (j = 0; j < length; ++j) {
+		binStr[j] = (char)('0' + ((value >> j) & 1u));
+	}
+	binStr[j] = '\0';
+}
 
-			if (currBit) {
-				fieldSplit[i].valueAsBinStr[j] = '1';
-				collected |= mask;
-			} else {
-				fieldSplit[i].valueAsBinStr[j] = '0';
-			}
+static void
+formatFieldAsHexStr(unsigned value, char hexStr[])
+{
+	static const char hexDigits[16] = "0123456789abcdef";
+	char reversed[DCF77FIELDSPLIT_HEXSTR_SZ];
+	unsigned n = 0;
 
-			mask <<= 1;
-		}
-		fieldSplit[i].value = collected;
-		fieldSplit[i].valueAsBinStr[j] = '\0';
+	do {
+		reversed[n++] = hexDigits[value & 0x0Fu];
+		value >>= 4;
+	} while (value);
 
-		snprintf(fieldSplit[i].valueAsHexStr, FIELDSPLIT_HEXSTR_SZ,
-			"%x", fieldSplit[i].value);
+	while (n) {
+		*hexStr++ = reversed[--n];
 	}
+	*hexStr = '\0';
 }
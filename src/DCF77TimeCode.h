@@ -3,6 +3,8 @@
 
 #include <time.h>
 #include "DCF77Block.h"
+#include "DCF77DSTTable.h"
+#include "DCF77LeapTable.h"
 
 typedef struct {
 	const char *asBinStr;
@@ -11,13 +13,100 @@ typedef struct {
 	const char *nameDescr;
 } DCF77FieldViews_t;
 
+enum {
+	DCF77FIELDSPLIT_ROWS_QTY = 18,
+	DCF77FIELDSPLIT_BINSTR_SZ = 16,
+	DCF77FIELDSPLIT_HEXSTR_SZ = 8
+};
+
+enum {
+	DCF77FIELDSPLIT_BINSTR = 0x01,	/* fill in asBinStr */
+	DCF77FIELDSPLIT_HEXSTR = 0x02	/* fill in asHexStr */
+};
+
+typedef struct {
+	unsigned		value[DCF77FIELDSPLIT_ROWS_QTY];
+	char			asBinStr[DCF77FIELDSPLIT_ROWS_QTY]
+				    [DCF77FIELDSPLIT_BINSTR_SZ];
+	char			asHexStr[DCF77FIELDSPLIT_ROWS_QTY]
+				    [DCF77FIELDSPLIT_HEXSTR_SZ];
+	DCF77FieldViews_t	views[DCF77FIELDSPLIT_ROWS_QTY];
+} DCF77FieldSplit_t;
+
+enum {
+	DCF77FIELDS_DST_ANNOUNCED	= 0x01,	/* A1 */
+	DCF77FIELDS_LEAP_ANNOUNCED	= 0x02,	/* A2 */
+	DCF77FIELDS_ABNORMAL_TX		= 0x04,	/* R */
+	DCF77FIELDS_LEAP_SECOND		= 0x08	/* minute of 61 seconds */
+};
+
+/*
+ * Time and date of a block in binary, a lightweight struct tm stand-in.
+ */
+typedef struct {
+	uint8_t	minute;		/* 0-59 */
+	uint8_t	hour;		/* 0-23 */
+	uint8_t	dayOfMonth;	/* 1-31 */
+	uint8_t	dayOfWeek;	/* Monday=1, Sunday=7 */
+	uint8_t	month;		/* 1-12 */
+	uint8_t	year;		/* Year within century 00-99 */
+	uint8_t	isdst;		/* Z1: CEST in effect */
+	uint8_t	flags;		/* DCF77FIELDS_... */
+} DCF77Fields_t;
+
+/*
+ * Faults reported by DCF77TimeCode_Validate(), a bit per check.
+ */
+enum {
+	DCF77TIMECODE_ERR_M	 = 0x0001,	/* M is not 0 */
+	DCF77TIMECODE_ERR_S	 = 0x0002,	/* S is not 1 */
+	DCF77TIMECODE_ERR_Z	 = 0x0004,	/* Z1 equals Z2 */
+	DCF77TIMECODE_ERR_P1	 = 0x0008,
+	DCF77TIMECODE_ERR_P2	 = 0x0010,
+	DCF77TIMECODE_ERR_P3	 = 0x0020,
+	DCF77TIMECODE_ERR_MINUTE = 0x0040,	/* not BCD 00-59 */
+	DCF77TIMECODE_ERR_HOUR	 = 0x0080,	/* not BCD 00-23 */
+	DCF77TIMECODE_ERR_DOM	 = 0x0100,	/* not BCD 01-31 */
+	DCF77TIMECODE_ERR_DOW	 = 0x0200,	/* zero */
+	DCF77TIMECODE_ERR_MONTH	 = 0x0400,	/* not BCD 01-12 */
+	DCF77TIMECODE_ERR_YEAR	 = 0x0800,	/* not BCD 00-99 */
+	DCF77TIMECODE_ERR_TAIL	 = 0x1000	/* bits past 58 set */
+};
+
+enum {
+	DCF77TIMECODE_REPAIR_INTACT = 0,	/* valid as received */
+	DCF77TIMECODE_REPAIR_FIXED,		/* one bit corrected */
+	DCF77TIMECODE_REPAIR_FAILED		/* left as received */
+};
+
+void DCF77TimeCode_UseDSTTable(const DCF77DSTTable_t * pTable);
+void DCF77TimeCode_UseLeapTable(const DCF77LeapTable_t * pTable);
+int DCF77TimeCode_HasLeapSecond(const DCF77Block_t * pBlock);
 void DCF77TimeCode_Init(DCF77Block_t * pBlock);
 void DCF77TimeCode_ConvertToStructTM(const DCF77Block_t * pBlock,
 	struct tm * outStm);
 void DCF77TimeCode_ConvertFromStructTM(DCF77Block_t * pBlock,
 	const struct tm * inStm);
+void DCF77TimeCode_DecodeFields(const DCF77Block_t * pBlock,
+	DCF77Fields_t * pFields);
+void DCF77TimeCode_DecodeFieldsBatch(const DCF77Block_t blocks[],
+	DCF77Fields_t fields[], size_t qty);
+unsigned DCF77TimeCode_Validate(const DCF77Block_t * pBlock);
+size_t DCF77TimeCode_ValidateBatch(const DCF77Block_t blocks[],
+	unsigned errors[], size_t qty);
+void DCF77TimeCode_DescribeErrors(unsigned errors, char * buf,
+	size_t bufSz);
+int DCF77TimeCode_Repair(const DCF77Block_t * pPrev,
+	DCF77Block_t * pBlock);
+void DCF77TimeCode_ConvertToStructTMBatch(const DCF77Block_t blocks[],
+	struct tm stms[], size_t qty);
+void DCF77TimeCode_ConvertFromStructTMBatch(DCF77Block_t blocks[],
+	const struct tm stms[], size_t qty);
+void DCF77TimeCode_AdvanceByMinute(DCF77Block_t * pBlock);
 void DCF77TimeCode_SplitInFields(const DCF77Block_t * pBlock,
 	const DCF77FieldViews_t * pFieldsViews[],
 	size_t * fieldsViewsSz);
+void DCF77TimeCode_SplitInFieldsR(const DCF77Block_t * pBlock,
+	DCF77FieldSplit_t * pSplit, unsigned flags);
 
 #endif /* #ifndef D_DCF77TimeCode_h */
@@ -1,12 +1,97 @@
 #ifndef D_DCF77TimeCodePrivate_h
 #define D_DCF77TimeCodePrivate_h
 
+#include <stdint.h>
+#include <string.h>
 #include "DCF77Block.h"
 
 enum {
 	DCF77TIMECODE_BITS_QTY = 60
 };
 
+/*
+ * Fields of the timecode, bit 0 first:
+ *   X(id, offset, length, name, description)
+ * Shift and mask constants of the codec below and the rows of
+ * DCF77TimeCode_SplitInFields() are all generated from this table.
+ */
+#define DCF77TIMECODE_FIELDS(X)						\
+	X(M,        0,  1, "M",       "Start of minute")		\
+	X(WEATHER,  1, 14, "weather", "Weather info")			\
+	X(R,       15,  1, "R",       "Abnormal transmitter operation")	\
+	X(A1,      16,  1, "A1",      "Summer time announcement")	\
+	X(Z1,      17,  1, "Z1",      "CEST in effect")			\
+	X(Z2,      18,  1, "Z2",      "CET in effect")			\
+	X(A2,      19,  1, "A2",      "Leap second announcement")	\
+	X(S,       20,  1, "S",       "Start of encoded time")		\
+	X(MIN,     21,  7, "min",     "Minutes 00-59")			\
+	X(P1,      28,  1, "P1",      "Even parity over minute bits")	\
+	X(HOUR,    29,  6, "hour",    "Hours 00-23")			\
+	X(P2,      35,  1, "P2",      "Even parity over hour bits")	\
+	X(DOM,     36,  6, "dom",     "Day of month")			\
+	X(DOW,     42,  3, "dow",     "Day of week (Mon=1, Sun=7)")	\
+	X(MONTH,   45,  5, "month",   "Month number 01-12")		\
+	X(YEAR,    50,  8, "year",    "Year within century 00-99")	\
+	X(P3,      58,  1, "P3",      "Parity over date bits")		\
+	X(MM,      59,  1, "-",       "Minute Mark (no AM)")
+
+#define DCF77TC_FIELD_ENUM(id, offset, length, name, desc)		\
+	DCF77TC_##id##_SHIFT = (offset), DCF77TC_##id##_LEN = (length),
+
+enum {
+	DCF77TIMECODE_FIELDS(DCF77TC_FIELD_ENUM)
+};
+
+#define DCF77TC_MASK(id)						\
+	(((UINT64_C(1) << DCF77TC_##id##_LEN) - 1) << DCF77TC_##id##_SHIFT)
+#define DCF77TC_GET(w, id)						\
+	((unsigned)(((w) & DCF77TC_MASK(id)) >> DCF77TC_##id##_SHIFT))
+#define DCF77TC_PUT(w, id, v)						\
+	(((w) & ~DCF77TC_MASK(id)) |					\
+	 (((uint64_t)(v) << DCF77TC_##id##_SHIFT) & DCF77TC_MASK(id)))
+
+/*
+ * A block is its 60 bits as a little-endian 64-bit number: on
+ * little-endian targets a single load or store, elsewhere the bytes are
+ * assembled in order.  Either way the result does not depend on how the
+ * compiler lays out bitfields.
+ */
+static inline uint64_t
+DCF77TimeCode_LoadWord(const DCF77Block_t * pBlock)
+{
+	uint64_t w;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	memcpy(&w, pBlock->data, sizeof(w));
+#else
+	int i;
+
+	w = 0u;
+	for (i = DCF77BLOCK_SIZE - 1; i >= 0; --i) {
+		w = (w << 8) | pBlock->data[i];
+	}
+#endif
+	return w;
+}
+
+static inline void
+DCF77TimeCode_StoreWord(uint64_t w, DCF77Block_t * pBlock)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	memcpy(pBlock->data, &w, sizeof(w));
+#else
+	int i;
+
+	for (i = 0; i < DCF77BLOCK_SIZE; ++i) {
+		pBlock->data[i] = (uint8_t)(w >> (8 * i));
+	}
+#endif
+}
+
+/*
+ * The former bitfield view of a block.  Its layout depends on the
+ * compiler; the library no longer uses it, tests check the codec above
+ * against it.
+ */
 typedef struct __attribute__((packed)) DCF77TimeCode_t {
 	unsigned	M:1;		/* Start of minute. Always 0 */
 	unsigned	weather:14;	/* junk */
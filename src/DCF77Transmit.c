@@ -0,0 +1,222 @@
+#include <sys/ioctl.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sysexits.h>
+#include <termios.h>
+#include <unistd.h>
+#include "DCF77Transmit.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+
+#define NS_PER_SEC	1000000000L
+#define NS_PER_MS	1000000L
+#define SINK_STDOUT	"stdout"
+#define SINK_GPIO	"gpio:"
+#define SINK_SERIAL	"serial:"
+
+static void stdoutPulseStart(DCF77TxSink_t * pSink, unsigned second,
+	unsigned bit);
+static void stdoutPulseEnd(DCF77TxSink_t * pSink, unsigned second);
+static void gpioPulseStart(DCF77TxSink_t * pSink, unsigned second,
+	unsigned bit);
+static void gpioPulseEnd(DCF77TxSink_t * pSink, unsigned second);
+static void serialPulseStart(DCF77TxSink_t * pSink, unsigned second,
+	unsigned bit);
+static void serialPulseEnd(DCF77TxSink_t * pSink, unsigned second);
+static void fdSinkClose(DCF77TxSink_t * pSink);
+
+/*
+ * Sink specs:
+ *   stdout		- an event line per pulse edge
+ *   gpio:<path>	- "1"/"0" written to a sysfs GPIO value file
+ *   serial:<path>	- RTS line of a serial port asserted/deasserted
+ */
+void
+DCF77Transmit_OpenSink(DCF77TxSink_t * pSink, const char * spec)
+{
+	memset(pSink, 0, sizeof(*pSink));
+	pSink->fd = -1;
+
+	if (NULL == spec || 0 == strcmp(spec, SINK_STDOUT)) {
+		pSink->pulseStart = stdoutPulseStart;
+		pSink->pulseEnd   = stdoutPulseEnd;
+	} else if (0 == strncmp(spec, SINK_GPIO, strlen(SINK_GPIO))) {
+		spec += strlen(SINK_GPIO);
+		pSink->fd = open(spec, O_WRONLY);
+		pSink->pulseStart = gpioPulseStart;
+		pSink->pulseEnd   = gpioPulseEnd;
+		pSink->close      = fdSinkClose;
+	} else if (0 == strncmp(spec, SINK_SERIAL, strlen(SINK_SERIAL))) {
+		spec += strlen(SINK_SERIAL);
+		pSink->fd = open(spec, O_RDWR | O_NOCTTY | O_NONBLOCK);
+		pSink->pulseStart = serialPulseStart;
+		pSink->pulseEnd   = serialPulseEnd;
+		pSink->close      = fdSinkClose;
+	} else {
+		errx(EX_USAGE, "unknown sink '%s'", spec);
+		/* NOTREACHED */
+	}
+
+	if (NULL != pSink->close && pSink->fd < 0) {
+		err(EX_OSFILE, "%s", spec);
+		/* NOTREACHED */
+	}
+
+	/* start with full carrier */
+	pSink->pulseEnd(pSink, 0);
+}
+
+void
+DCF77Transmit_CloseSink(DCF77TxSink_t * pSink)
+{
+	if (NULL != pSink->close) {
+		pSink->close(pSink);
+	}
+}
+
+static void
+stdoutPulseStart(DCF77TxSink_t * pSink, unsigned second, unsigned bit)
+{
+	struct timespec now;
+
+	(void)clock_gettime(CLOCK_REALTIME, &now);
+	printf("%lld.%09ld %02u %u\n", (long long)now.tv_sec, now.tv_nsec,
+	    second, bit);
+	fflush(stdout);
+}
+
+static void
+stdoutPulseEnd(DCF77TxSink_t * pSink, unsigned second)
+{
+	/* pulse width is implied by the bit printed at the start */
+}
+
+static void
+writeGPIOValue(int fd, char value)
+{
+	if (pwrite(fd, &value, 1, 0) != 1) {
+		err(EX_IOERR, "gpio");
+		/* NOTREACHED */
+	}
+}
+
+static void
+gpioPulseStart(DCF77TxSink_t * pSink, unsigned second, unsigned bit)
+{
+	writeGPIOValue(pSink->fd, '1');
+}
+
+static void
+gpioPulseEnd(DCF77TxSink_t * pSink, unsigned second)
+{
+	writeGPIOValue(pSink->fd, '0');
+}
+
+static void
+setRTS(int fd, int asserted)
+{
+	int lines = TIOCM_RTS;
+
+	if (ioctl(fd, asserted ? TIOCMBIS : TIOCMBIC, &lines) < 0) {
+		err(EX_IOERR, "serial");
+		/* NOTREACHED */
+	}
+}
+
+static void
+serialPulseStart(DCF77TxSink_t * pSink, unsigned second, unsigned bit)
+{
+	setRTS(pSink->fd, 1);
+}
+
+static void
+serialPulseEnd(DCF77TxSink_t * pSink, unsigned second)
+{
+	setRTS(pSink->fd, 0);
+}
+
+static void
+fdSinkClose(DCF77TxSink_t * pSink)
+{
+	pSink->pulseEnd(pSink, 0);
+	close(pSink->fd);
+	pSink->fd = -1;
+}
+
+void
+DCF77Transmit_ResetStats(DCF77TxStats_t * pStats)
+{
+	memset(pStats, 0, sizeof(*pStats));
+}
+
+static void
+sleepUntil(const struct timespec * pWhen)
+{
+	int rc;
+
+	do {
+		rc = clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, pWhen, NULL);
+	} while (EINTR == rc);
+}
+
+static void
+accountLateness(DCF77TxJitter_t * pJitter, const struct timespec * pWhen)
+{
+	struct timespec now;
+	long late;
+
+	(void)clock_gettime(CLOCK_REALTIME, &now);
+	late = (long)(now.tv_sec - pWhen->tv_sec) * NS_PER_SEC +
+	    (now.tv_nsec - pWhen->tv_nsec);
+
+	if (0 == pJitter->qty || late < pJitter->minNs) {
+		pJitter->minNs = late;
+	}
+	if (0 == pJitter->qty || late > pJitter->maxNs) {
+		pJitter->maxNs = late;
+	}
+	pJitter->sumNs += (double)late;
+	++pJitter->qty;
+}
+
+static unsigned
+blockBit(const DCF77Block_t * pBlock, unsigned i)
+{
+	return (pBlock->data[i / 8] >> (i % 8)) & 1u;
+}
+
+/*
+ * Sends the block during the minute starting at 'minuteStart': bit N
+ * at second N, sharp.  The 59th second carries no pulse, which marks the
+ * start of the next minute.  In a minute with a leap second it carries
+ * a 0 and second 60 goes without; the system clock repeats second 59
+ * then, so the next minute still starts at minuteStart + 60.
+ */
+void
+DCF77Transmit_Minute(DCF77TxSink_t * pSink, const DCF77Block_t * pBlock,
+	time_t minuteStart, DCF77TxStats_t * pStats)
+{
+	unsigned pulses = DCF77TIMECODE_BITS_QTY - 1 +
+	    (DCF77TimeCode_HasLeapSecond(pBlock) ? 1u : 0u);
+	unsigned second;
+
+	for (second = 0; second < pulses; ++second) {
+		unsigned bit = (second < DCF77TIMECODE_BITS_QTY - 1) ?
+		    blockBit(pBlock, second) : 0u;
+		struct timespec edge;
+
+		edge.tv_sec  = minuteStart + second;
+		edge.tv_nsec = 0;
+		sleepUntil(&edge);
+		pSink->pulseStart(pSink, second, bit);
+		accountLateness(&pStats->leading, &edge);
+
+		edge.tv_nsec = (bit ? 200 : 100) * NS_PER_MS;
+		sleepUntil(&edge);
+		pSink->pulseEnd(pSink, second);
+		accountLateness(&pStats->trailing, &edge);
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef D_DCF77Transmit_h
+#define D_DCF77Transmit_h
+
+#include <time.h>
+#include "DCF77Block.h"
+
+/*
+ * Sink drives the hardware: amplitude of the carrier is reduced from
+ * pulseStart() till pulseEnd() (100 ms for 0, 200 ms for 1).
+ */
+typedef struct DCF77TxSink_t {
+	int	 fd;
+	void	(*pulseStart)(struct DCF77TxSink_t * pSink,
+		    unsigned second, unsigned bit);
+	void	(*pulseEnd)(struct DCF77TxSink_t * pSink, unsigned second);
+	void	(*close)(struct DCF77TxSink_t * pSink);
+} DCF77TxSink_t;
+
+/*
+ * Lateness of pulse edges (taken once the sink has been driven) against
+ * their exact moments, nanoseconds.
+ */
+typedef struct {
+	long		minNs;
+	long		maxNs;
+	double		sumNs;
+	unsigned long	qty;
+} DCF77TxJitter_t;
+
+typedef struct {
+	DCF77TxJitter_t	leading;	/* pulse starts: the second marks */
+	DCF77TxJitter_t	trailing;	/* pulse ends: the bit values */
+} DCF77TxStats_t;
+
+void DCF77Transmit_OpenSink(DCF77TxSink_t * pSink, const char * spec);
+void DCF77Transmit_CloseSink(DCF77TxSink_t * pSink);
+void DCF77Transmit_ResetStats(DCF77TxStats_t * pStats);
+void DCF77Transmit_Minute(DCF77TxSink_t * pSink, const DCF77Block_t * pBlock,
+	time_t minuteStart, DCF77TxStats_t * pStats);
+
+#endif /* #ifndef D_DCF77Transmit_h */
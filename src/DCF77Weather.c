@@ -0,0 +1,184 @@
+#include "DCF77Weather.h"
+#include "DCF77TimeCodePrivate.h"
+
+/* the time a frame is keyed with */
+#define KEY_MASK	(DCF77TC_MASK(MIN) | DCF77TC_MASK(HOUR) |	\
+			 DCF77TC_MASK(DOM) | DCF77TC_MASK(DOW) |	\
+			 DCF77TC_MASK(MONTH) | DCF77TC_MASK(YEAR))
+
+/* the same in all blocks of a frame: it never spans an hour */
+#define HOUR_MASK	(KEY_MASK & ~DCF77TC_MASK(MIN))
+
+static inline unsigned
+bcdNext(unsigned bcd)
+{
+	return (9u == (bcd & 0xFu)) ? (bcd & 0xF0u) + 0x10u : bcd + 1u;
+}
+
+/*
+ * Words only: a BCD number taken modulo 3 is the sum of its digits
+ * modulo 3, as 10 is 1 modulo 3.
+ */
+static inline int
+isFrame(uint64_t w0, uint64_t w1, uint64_t w2)
+{
+	unsigned minute = DCF77TC_GET(w0, MIN);
+
+	if (0u != ((minute >> 4) + (minute & 0xFu)) % 3u)
+		return 0;
+
+	minute = bcdNext(minute);
+	if (DCF77TC_GET(w1, MIN) != minute ||
+	    DCF77TC_GET(w2, MIN) != bcdNext(minute))
+		return 0;
+
+	return (w0 & HOUR_MASK) == (w1 & HOUR_MASK) &&
+	    (w0 & HOUR_MASK) == (w2 & HOUR_MASK);
+}
+
+static inline uint64_t
+keyOf(uint64_t w)
+{
+	return (w & KEY_MASK) >> DCF77TC_MIN_SHIFT;
+}
+
+int
+DCF77Weather_IsFrameAt(const DCF77Block_t * blocks, size_t qty)
+{
+	return qty >= DCF77WEATHER_FRAME_BLOCKS &&
+	    isFrame(DCF77TimeCode_LoadWord(&blocks[0]),
+		DCF77TimeCode_LoadWord(&blocks[1]),
+		DCF77TimeCode_LoadWord(&blocks[2]));
+}
+
+uint64_t
+DCF77Weather_KeyOf(const DCF77Block_t * pFirst)
+{
+	return keyOf(DCF77TimeCode_LoadWord(pFirst));
+}
+
+static inline void
+putBits(DCF77Block_t * frame, uint64_t w[DCF77WEATHER_FRAME_BLOCKS],
+	uint64_t payload, const DCF77WeatherCipher_t * pCipher)
+{
+	unsigned k;
+
+	payload &= DCF77WEATHER_PAYLOAD_MASK;
+	if (NULL != pCipher) {
+		payload = pCipher->encrypt(pCipher->ctx, payload,
+		    keyOf(w[0])) & DCF77WEATHER_PAYLOAD_MASK;
+	}
+
+	for (k = 0; k < DCF77WEATHER_FRAME_BLOCKS; ++k) {
+		DCF77TimeCode_StoreWord(DCF77TC_PUT(w[k], WEATHER,
+		    payload >> (k * DCF77TC_WEATHER_LEN)), &frame[k]);
+	}
+}
+
+static inline uint64_t
+getBits(const uint64_t w[DCF77WEATHER_FRAME_BLOCKS],
+	const DCF77WeatherCipher_t * pCipher)
+{
+	uint64_t bits = 0u;
+	unsigned k;
+
+	for (k = 0; k < DCF77WEATHER_FRAME_BLOCKS; ++k) {
+		bits |= (uint64_t)DCF77TC_GET(w[k], WEATHER) <<
+		    (k * DCF77TC_WEATHER_LEN);
+	}
+	if (NULL != pCipher) {
+		bits = pCipher->decrypt(pCipher->ctx, bits, keyOf(w[0])) &
+		    DCF77WEATHER_PAYLOAD_MASK;
+	}
+
+	return bits;
+}
+
+/*
+ * The frame is taken as such, whatever minutes its blocks are of.
+ */
+void
+DCF77Weather_Put(DCF77Block_t frame[DCF77WEATHER_FRAME_BLOCKS],
+	uint64_t payload, const DCF77WeatherCipher_t * pCipher)
+{
+	uint64_t w[DCF77WEATHER_FRAME_BLOCKS];
+	unsigned k;
+
+	for (k = 0; k < DCF77WEATHER_FRAME_BLOCKS; ++k) {
+		w[k] = DCF77TimeCode_LoadWord(&frame[k]);
+	}
+	putBits(frame, w, payload, pCipher);
+}
+
+uint64_t
+DCF77Weather_Get(const DCF77Block_t frame[DCF77WEATHER_FRAME_BLOCKS],
+	const DCF77WeatherCipher_t * pCipher)
+{
+	uint64_t w[DCF77WEATHER_FRAME_BLOCKS];
+	unsigned k;
+
+	for (k = 0; k < DCF77WEATHER_FRAME_BLOCKS; ++k) {
+		w[k] = DCF77TimeCode_LoadWord(&frame[k]);
+	}
+
+	return getBits(w, pCipher);
+}
+
+/*
+ * Payloads go into the frames met in the blocks, in order, until either
+ * runs out; blocks outside frames keep their weather bits.  Returns the
+ * frames filled.
+ */
+size_t
+DCF77Weather_Pack(DCF77Block_t * blocks, size_t qty,
+	const uint64_t * payloads, size_t payloadQty,
+	const DCF77WeatherCipher_t * pCipher)
+{
+	uint64_t w[DCF77WEATHER_FRAME_BLOCKS];
+	size_t i = 0, n = 0;
+
+	while (n < payloadQty && i + DCF77WEATHER_FRAME_BLOCKS <= qty) {
+		w[0] = DCF77TimeCode_LoadWord(&blocks[i]);
+		w[1] = DCF77TimeCode_LoadWord(&blocks[i + 1]);
+		w[2] = DCF77TimeCode_LoadWord(&blocks[i + 2]);
+		if (!isFrame(w[0], w[1], w[2])) {
+			++i;
+			continue;
+		}
+
+		putBits(&blocks[i], w, payloads[n++], pCipher);
+		i += DCF77WEATHER_FRAME_BLOCKS;
+	}
+
+	return n;
+}
+
+/*
+ * Hands the payload of every frame in the blocks to fn, with the
+ * position of the frame's first block.  Blocks lost or out of order
+ * just leave their frames out.  Returns the frames found.
+ */
+size_t
+DCF77Weather_Unpack(const DCF77Block_t * blocks, size_t qty,
+	const DCF77WeatherCipher_t * pCipher, DCF77WeatherFn_t fn,
+	void * ctx)
+{
+	uint64_t w[DCF77WEATHER_FRAME_BLOCKS];
+	size_t i = 0, n = 0;
+
+	while (i + DCF77WEATHER_FRAME_BLOCKS <= qty) {
+		w[0] = DCF77TimeCode_LoadWord(&blocks[i]);
+		w[1] = DCF77TimeCode_LoadWord(&blocks[i + 1]);
+		w[2] = DCF77TimeCode_LoadWord(&blocks[i + 2]);
+		if (!isFrame(w[0], w[1], w[2])) {
+			++i;
+			continue;
+		}
+
+		fn(ctx, i, getBits(w, pCipher));
+		++n;
+		i += DCF77WEATHER_FRAME_BLOCKS;
+	}
+
+	return n;
+}
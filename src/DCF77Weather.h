@@ -0,0 +1,55 @@
+#ifndef D_DCF77Weather_h
+#define D_DCF77Weather_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include "DCF77Block.h"
+
+/*
+ * Weather data (Meteotime) in the 14 weather bits of the blocks.  A
+ * frame is three blocks of consecutive minutes, the first one's minute
+ * being a multiple of 3, and carries 42 bits: bits 0-13 in the first
+ * block, 14-27 in the second, 28-41 in the third.  The bits on air are
+ * ciphered with the time of the frame's first block as the key; the
+ * cipher is left to the caller, none meaning the payload is sent as is.
+ */
+enum {
+	DCF77WEATHER_FRAME_BLOCKS = 3,
+	DCF77WEATHER_BITS_QTY = 42
+};
+
+#define DCF77WEATHER_PAYLOAD_MASK	\
+	((UINT64_C(1) << DCF77WEATHER_BITS_QTY) - 1)
+
+/*
+ * Maps 42 bits to 42 bits, with the minute, hour, date and year bits of
+ * the frame's first block (bits 21-57 of its word, parities cleared)
+ * as the key.
+ */
+typedef uint64_t (*DCF77WeatherCipherFn_t)(void * ctx, uint64_t bits,
+	uint64_t key);
+
+typedef struct {
+	DCF77WeatherCipherFn_t	 encrypt;
+	DCF77WeatherCipherFn_t	 decrypt;
+	void			*ctx;
+} DCF77WeatherCipher_t;
+
+typedef void (*DCF77WeatherFn_t)(void * ctx, size_t first,
+	uint64_t payload);
+
+int DCF77Weather_IsFrameAt(const DCF77Block_t * blocks, size_t qty);
+uint64_t DCF77Weather_KeyOf(const DCF77Block_t * pFirst);
+void DCF77Weather_Put(DCF77Block_t frame[DCF77WEATHER_FRAME_BLOCKS],
+	uint64_t payload, const DCF77WeatherCipher_t * pCipher);
+uint64_t DCF77Weather_Get(const DCF77Block_t frame[DCF77WEATHER_FRAME_BLOCKS],
+	const DCF77WeatherCipher_t * pCipher);
+
+size_t DCF77Weather_Pack(DCF77Block_t * blocks, size_t qty,
+	const uint64_t * payloads, size_t payloadQty,
+	const DCF77WeatherCipher_t * pCipher);
+size_t DCF77Weather_Unpack(const DCF77Block_t * blocks, size_t qty,
+	const DCF77WeatherCipher_t * pCipher, DCF77WeatherFn_t fn,
+	void * ctx);
+
+#endif /* #ifndef D_DCF77Weather_h */
@@ -1,5 +1,9 @@
 #include <ctype.h>
 #include <err.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <signal.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -9,7 +13,21 @@
 #include <unistd.h>
 
 #include "DCF77Block.h"
+#include "DCF77Continuity.h"
+#include "DCF77BlockFile.h"
+#include "DCF77Demod.h"
+#include "DCF77DSTTable.h"
+#include "DCF77Format.h"
+#include "DCF77LeapTable.h"
+#include "DCF77PM.h"
+#include "DCF77PMRx.h"
+#include "DCF77Server.h"
+#include "DCF77Shm.h"
+#include "DCF77Sync.h"
+#include "DCF77Synth.h"
 #include "DCF77TimeCode.h"
+#include "DCF77Transmit.h"
+#include "DCF77Weather.h"
 #include "utils.h"
 
 #define PROGNAME "dcfcode"
@@ -18,27 +36,56 @@ static enum {
 	OP_MODE_UNSPECIFIED,
 	OP_MODE_CREATE_BLOCK,
 	OP_MODE_DUMP_BLOCK,
-	OP_MODE_DETAILED_DUMP
+	OP_MODE_DETAILED_DUMP,
+	OP_MODE_CHECK,
+	OP_MODE_TRANSMIT,
+	OP_MODE_SERVE,
+	OP_MODE_PUBLISH
 } opMode = OP_MODE_UNSPECIFIED;
 
 static int startOffset  = 0;
 static int createBlocks = 1;
+static int isCreateBlocksGiven = 0;
+static int createJobs = 1;
+static int validateBlocks = 0;
 static const char * timeSpec = NULL;
 static const char * dumpTimeFormat = "%c (%Z)";
+static const char * inputPath = NULL;
+static const char * outputPath = NULL;
+static char * audioSpec = NULL;
+static char * pmSpec = NULL;
+static const char * socketPath = NULL;
+static const char * shmName = NULL;
+static int bitsScan = 0;
+static int showWeather = 0;
+static const char * leapPath = NULL;
+static DCF77LeapTable_t leapTable;
 
 static void printUsage(void);
 static void processCreateBlockCmd(int argc, char * argv[]);
 static void processDumpBlockCmd(int argc, char * argv[]);
 static void processDetailedDumpCmd(int argc, char * argv[]);
+static void processCheckCmd(int argc, char * argv[]);
+static void processTransmitCmd(int argc, char * argv[]);
+static void processServeCmd(int argc, char * argv[]);
+static void processPublishCmd(int argc, char * argv[]);
 static void parseTimeSpec(const char * text, struct tm * pStm);
+static void parseSynthParams(char * spec, DCF77SynthParams_t * pParams);
+static void outFlush(void);
 
 int
 main(int argc, char * argv[])
 {
 	int ch;
 
-	while ((ch = getopt(argc, argv, "cDdf:n:s:t:")) != -1) {
+	while ((ch = getopt(argc, argv, "a:bcDdf:i:j:kL:n:o:P:p:rS:s:t:vw")) != -1) {
 		switch (ch) {
+		case 'a':
+			audioSpec = optarg;
+			break;
+		case 'b':
+			++bitsScan;
+			break;
 		case 'c':
 			opMode = OP_MODE_CREATE_BLOCK;
 			break;
@@ -51,8 +98,38 @@ main(int argc, char * argv[])
 		case 'f':
 			dumpTimeFormat = optarg;
 			break;
+		case 'i':
+			inputPath = optarg;
+			break;
+		case 'j':
+			createJobs = (int)strtol(optarg, NULL, 10);
+			break;
+		case 'k':
+			opMode = OP_MODE_CHECK;
+			break;
+		case 'L':
+			leapPath = optarg;
+			break;
 		case 'n':
 			createBlocks = (int)strtol(optarg, NULL, 10);
+			isCreateBlocksGiven = 1;
+			break;
+		case 'o':
+			outputPath = optarg;
+			break;
+		case 'p':
+			pmSpec = optarg;
+			break;
+		case 'P':
+			opMode = OP_MODE_PUBLISH;
+			shmName = optarg;
+			break;
+		case 'r':
+			opMode = OP_MODE_TRANSMIT;
+			break;
+		case 'S':
+			opMode = OP_MODE_SERVE;
+			socketPath = optarg;
 			break;
 		case 's':
 			startOffset = (int)strtol(optarg, NULL, 10);
@@ -60,6 +137,12 @@ main(int argc, char * argv[])
 		case 't':
 			timeSpec = optarg;
 			break;
+		case 'v':
+			validateBlocks = 1;
+			break;
+		case 'w':
+			showWeather = 1;
+			break;
 		}
 	}
 	argc -= optind;
@@ -67,6 +150,15 @@ main(int argc, char * argv[])
 
 	tzset();
 
+	if (NULL != leapPath) {
+		DCF77LeapTable_Load(&leapTable, leapPath);
+		if (0 != leapTable.expires && leapTable.expires < time(NULL)) {
+			warnx("%s has expired, leap seconds to come may be "
+			    "missing", leapPath);
+		}
+		DCF77TimeCode_UseLeapTable(&leapTable);
+	}
+
 	switch (opMode) {
 	case OP_MODE_UNSPECIFIED:
 		printUsage();
@@ -81,8 +173,22 @@ main(int argc, char * argv[])
 	case OP_MODE_DETAILED_DUMP:
 		processDetailedDumpCmd(argc, argv);
 		break;
+	case OP_MODE_CHECK:
+		processCheckCmd(argc, argv);
+		break;
+	case OP_MODE_TRANSMIT:
+		processTransmitCmd(argc, argv);
+		break;
+	case OP_MODE_SERVE:
+		processServeCmd(argc, argv);
+		break;
+	case OP_MODE_PUBLISH:
+		processPublishCmd(argc, argv);
+		break;
 	}
 
+	outFlush();
+
 	return 0;
 }
 
@@ -113,24 +219,67 @@ printUsage(void)
 	fprintf(stderr,
 	    "\n"
 	    "    Mode of operation is selected by:\n"
-	    "  %% dcfcode { -c | -d | -D } ...\n"
+	    "  %% dcfcode { -c | -d | -D | -k | -r | -S <socket> | -P <shm> }"
+	    " ...\n"
 	    "\n"
 	    "    To create a block, use:\n"
-	    "  %% dcfcode -c [-t <timespec>] [-s <offset>] [-n <repeat>]\n"
+	    "  %% dcfcode -c [-t <timespec>] [-s <offset>] [-n <repeat>]"
+	    " [-o <blockfile>]\n"
+	    "               [-j <threads>] [-a <audio_params>] [-p <pm_output>]\n"
 	    "    To dump a block, run:\n"
-	    "  %% dcfcode -d [-f <time_format>] <block1> [<blockN>]\n"
+	    "  %% dcfcode -d [-v] [-w] [-f <time_format>] <block1> [<blockN>]\n"
+	    "    -v checks blocks, repairing single-bit errors by the\n"
+	    "    block before; faulty ones are reported as comments.\n"
+	    "    -w follows each 3-minute weather frame with a comment\n"
+	    "    giving its 42 bits.\n"
 	    "    To split a block in bits, use:\n"
 	    "  %% dcfcode -D <block1> [<blockN>]\n"
+	    "    Without blocks given, -d and -D read them line by line\n"
+	    "    from stdin or from the file given by -i <path>.\n"
+	    "    A block file made by -o is read by -i <blockfile>;\n"
+	    "    -t, -s and -n then select the minutes to dump.\n"
+	    "    Audio (-i <file.wav>, or raw samples described by -a)\n"
+	    "    is demodulated into blocks, as are the phase\n"
+	    "    modulation samples described by -p.\n"
+	    "    With -b the input is a capture of received bits, a\n"
+	    "    character a second ('0', '1', else no pulse), searched\n"
+	    "    for minute frames; -bb drops the need for the minute mark.\n"
+	    "    To check that blocks follow each other minute by minute:\n"
+	    "  %% dcfcode -k [-i <path>] [<block1> [<blockN>]]\n"
+	    "    Input is taken as by -d; the blocks that do not follow\n"
+	    "    the one before are reported in ranges.\n"
+	    "    To transmit blocks in real time, use:\n"
+	    "  %% dcfcode -r [-o <sink>] [-n <minutes>] [-i <shm>]\n"
+	    "    -i takes the blocks from a segment published by -P.\n"
+	    "    To serve blocks over a Unix socket, use:\n"
+	    "  %% dcfcode -S <socket> [-n <minutes_kept_ahead>]\n"
+	    "    To publish upcoming blocks in POSIX shared memory, use:\n"
+	    "  %% dcfcode -P /<shm_name>\n"
 	    "    where:\n"
 	    "    -t { [[[[yy]mm]dd]HH]MM | <block> }\n"
 	    "    -s { [+]<minutes> | -<minutes> }\n"
 	    "    -f <according to strftime(3)>\n"
+	    "    -o { stdout | gpio:<value_file> | serial:<tty> }"
+	    " for -r\n"
+	    "    -n 0 for -r transmits until killed\n"
+	    "    -L <leap-seconds.list> announces the leap seconds listed\n"
+	    "       (A2) and sends their minutes with 61 seconds\n"
+	    "    -a rate=<Hz>,carrier=<Hz>,depth=<%%>,level=<%%>,\n"
+	    "       pm[=<degrees>],format={s16|f32},{wav|raw}\n"
+	    "       renders the blocks as audio into -o <path> (or stdout)\n"
+	    "       or describes audio input for -d and -D\n"
+	    "    -p { chips | text | baseband[=<Hz>] } writes the phase\n"
+	    "       modulation chips of the blocks into -o <path> (or stdout)\n"
+	    "    -p { baseband | iq }[=<Hz>] describes phase modulation\n"
+	    "       input for -d and -D: float phase or I/Q samples\n"
 	);
 
 	exit(EX_USAGE);
 }
 
-static void createBlockAt(const struct tm * pStm);
+static void printBlock(const DCF77Block_t * pBlock);
+static void outWrite(const void * data, size_t sz);
+static void outPuts(const char * str);
 static void
 advanceTimeByMinutes(struct tm * pStm, int minutes)
 {
@@ -139,35 +288,384 @@ advanceTimeByMinutes(struct tm * pStm, int minutes)
 	normalizeStructTM(pStm);
 }
 
+static void createBlocksInParallel(struct tm * pStm);
+static void renderAudio(DCF77Block_t * pBlock);
+static void renderPM(DCF77Block_t * pBlock);
+
+#define MINUTES_PER_YEAR (366 * 24 * 60)
+static DCF77DSTTable_t dstTable;
+
+/*
+ * Only the first block is made of struct tm, the following ones are
+ * derived from their predecessors.  DST changes over the years spanned
+ * are looked up once, beforehand.
+ */
 static void
 processCreateBlockCmd(int argc, char * argv[])
 {
 	struct tm stm;
-	int i;
+	DCF77Block_t block;
+	int firstYear, i;
 
 	parseTimeSpec(timeSpec, &stm);
 	advanceTimeByMinutes(&stm, startOffset);
 
+	firstYear = stm.tm_year + 1900;
+	DCF77DSTTable_Build(&dstTable, firstYear,
+	    firstYear + createBlocks / MINUTES_PER_YEAR + 1);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+
+	if (NULL == audioSpec && NULL == pmSpec && createJobs > 1 &&
+	    createBlocks > createJobs) {
+		createBlocksInParallel(&stm);
+		return;
+	}
+
+	DCF77TimeCode_ConvertFromStructTM(&block, &stm);
+
+	if (NULL != pmSpec) {
+		renderPM(&block);
+		return;
+	}
+
+	if (NULL != audioSpec) {
+		renderAudio(&block);
+		return;
+	}
+
+	if (NULL != outputPath) {
+		DCF77BlockFileWriter_t writer;
+
+		DCF77BlockFile_Create(&writer, outputPath, mktime(&stm));
+		for (i = 0; i < createBlocks; ++i) {
+			DCF77BlockFile_Append(&writer, &block, 1);
+			DCF77TimeCode_AdvanceByMinute(&block);
+		}
+		DCF77BlockFile_Finish(&writer);
+
+		return;
+	}
+
 	for (i = 0; i < createBlocks; ++i) {
-		createBlockAt(&stm);
-		advanceTimeByMinutes(&stm, 1);
+		printBlock(&block);
+		DCF77TimeCode_AdvanceByMinute(&block);
 	}
 }
 
 #define BLOCK_TEXT_SZ (DCF77BLOCK_TEXT_LEN + 1)
+
+typedef struct {
+	pthread_t	 thread;
+	DCF77Block_t	 first;
+	DCF77Block_t	*blocks;
+	char		*text;		/* BLOCK_TEXT_SZ per block, or NULL */
+	size_t		 qty;
+} CreateChunk_t;
+
+static void *
+createChunk(void * arg)
+{
+	CreateChunk_t * pChunk = arg;
+	DCF77Block_t block = pChunk->first;
+	size_t i;
+
+	for (i = 0; i < pChunk->qty; ++i) {
+		pChunk->blocks[i] = block;
+
+		if (NULL != pChunk->text) {
+			char * pText = &pChunk->text[i * BLOCK_TEXT_SZ];
+
+			DCF77Block_ToText(&block, pText, BLOCK_TEXT_SZ);
+			pText[DCF77BLOCK_TEXT_LEN] = '\n';
+		}
+
+		DCF77TimeCode_AdvanceByMinute(&block);
+	}
+
+	return NULL;
+}
+
+/*
+ * The range is cut into -j chunks.  First block of each chunk is encoded
+ * here out of its absolute time, the rest of the chunk is derived by its
+ * own thread: with the DST table in place no thread touches libc time
+ * state (the UTC time leap seconds are looked up by included).  Chunks
+ * land in one array, so output keeps the order.
+ */
 static void
-createBlockAt(const struct tm * pStm)
+createBlocksInParallel(struct tm * pStm)
 {
-	char textBlock[BLOCK_TEXT_SZ];
-	DCF77Block_t block;
+	CreateChunk_t * chunks;
+	DCF77Block_t * blocks;
+	char * text = NULL;
+	size_t qty = (size_t)createBlocks;
+	size_t perChunk = (qty + createJobs - 1) / createJobs;
+	time_t startTime = mktime(pStm);
+	int i, rc;
+
+	chunks = calloc((size_t)createJobs, sizeof(*chunks));
+	blocks = calloc(qty, sizeof(*blocks));
+	if (NULL == outputPath) {
+		text = malloc(qty * BLOCK_TEXT_SZ);
+	}
+	if (NULL == chunks || NULL == blocks ||
+	    (NULL == outputPath && NULL == text)) {
+		err(EX_OSERR, "no memory for %zu blocks", qty);
+		/* NOTREACHED */
+	}
+
+	for (i = 0; i < createJobs; ++i) {
+		CreateChunk_t * pChunk = &chunks[i];
+		size_t offset = (size_t)i * perChunk;
+		time_t t = startTime + (time_t)offset * 60;
+		struct tm stm;
+
+		if (offset >= qty)
+			break;
+
+		(void)localtime_r(&t, &stm);
+		DCF77TimeCode_ConvertFromStructTM(&pChunk->first, &stm);
+		pChunk->blocks = &blocks[offset];
+		pChunk->text = (NULL == text) ?
+		    NULL : &text[offset * BLOCK_TEXT_SZ];
+		pChunk->qty = (qty - offset < perChunk) ?
+		    qty - offset : perChunk;
+
+		rc = pthread_create(&pChunk->thread, NULL, createChunk, pChunk);
+		if (0 != rc) {
+			errno = rc;
+			err(EX_OSERR, "pthread_create");
+			/* NOTREACHED */
+		}
+	}
+
+	while (--i >= 0) {
+		(void)pthread_join(chunks[i].thread, NULL);
+	}
+
+	if (NULL != outputPath) {
+		DCF77BlockFileWriter_t writer;
+
+		DCF77BlockFile_Create(&writer, outputPath, startTime);
+		DCF77BlockFile_Append(&writer, blocks, qty);
+		DCF77BlockFile_Finish(&writer);
+	} else {
+		outWrite(text, qty * BLOCK_TEXT_SZ);
+	}
+
+	free(text);
+	free(blocks);
+	free(chunks);
+}
+
+/*
+ * A block is on air during the minute before the one it encodes: the
+ * audio starts a minute before the first block's time.
+ */
+static void
+renderAudio(DCF77Block_t * pBlock)
+{
+	DCF77SynthParams_t params;
+	DCF77Synth_t synth;
+	int i;
+
+	DCF77Synth_DefaultParams(&params);
+	parseSynthParams(audioSpec, &params);
+
+	outFlush();
+	DCF77Synth_Open(&synth, &params, (NULL == outputPath) ? "-" : outputPath);
+	for (i = 0; i < createBlocks; ++i) {
+		DCF77Synth_RenderMinute(&synth, pBlock);
+		DCF77TimeCode_AdvanceByMinute(pBlock);
+	}
+	DCF77Synth_Close(&synth);
+}
 
-	/* 1. convert to DCF77Block_t  */
-	DCF77TimeCode_ConvertFromStructTM(&block, pStm);
+static long
+synthParamValue(const char * name, const char * value, long min, long max)
+{
+	char * end;
+	long v;
 
-	/* 2. convert Bin to Text */
-	DCF77Block_ToText(&block, textBlock, BLOCK_TEXT_SZ);
+	if (NULL == value) {
+		errx(EX_USAGE, "audio parameter '%s' needs a value", name);
+		/* NOTREACHED */
+	}
+	v = strtol(value, &end, 10);
+	if ('\0' != *end || v < min || v > max) {
+		errx(EX_USAGE, "audio parameter '%s': bad value '%s'",
+		    name, value);
+		/* NOTREACHED */
+	}
+
+	return v;
+}
 
-	printf("%s\n", textBlock);
+static void
+parseSynthParams(char * spec, DCF77SynthParams_t * pParams)
+{
+	enum { SP_RATE, SP_CARRIER, SP_DEPTH, SP_LEVEL, SP_PM, SP_FORMAT,
+	    SP_WAV, SP_RAW };
+	char * const tokens[] = {
+		[SP_RATE]    = "rate",
+		[SP_CARRIER] = "carrier",
+		[SP_DEPTH]   = "depth",
+		[SP_LEVEL]   = "level",
+		[SP_PM]      = "pm",
+		[SP_FORMAT]  = "format",
+		[SP_WAV]     = "wav",
+		[SP_RAW]     = "raw",
+		NULL
+	};
+	char * value, * end;
+
+	while ('\0' != *spec) {
+		switch (getsubopt(&spec, tokens, &value)) {
+		case SP_RATE:
+			pParams->sampleRate = (unsigned)synthParamValue(
+			    "rate", value, 1, 1000000);
+			break;
+		case SP_CARRIER:
+			pParams->carrierHz = (unsigned)synthParamValue(
+			    "carrier", value, 0, 500000);
+			break;
+		case SP_DEPTH:
+			pParams->depth = synthParamValue(
+			    "depth", value, 0, 100) / 100.0;
+			break;
+		case SP_LEVEL:
+			pParams->level = synthParamValue(
+			    "level", value, 0, 100) / 100.0;
+			break;
+		case SP_PM:
+			pParams->pmDegrees = (NULL == value) ? DCF77PM_DEVIATION_DEGREES :
+			    strtod(value, &end);
+			if ((NULL != value && '\0' != *end) ||
+			    pParams->pmDegrees < 0.0 ||
+			    pParams->pmDegrees > 90.0) {
+				errx(EX_USAGE, "audio parameter 'pm': bad value "
+				    "'%s'", value);
+				/* NOTREACHED */
+			}
+			break;
+		case SP_FORMAT:
+			if (NULL != value && 0 == strcmp(value, "s16")) {
+				pParams->format = DCF77SYNTH_S16;
+			} else if (NULL != value && 0 == strcmp(value, "f32")) {
+				pParams->format = DCF77SYNTH_F32;
+			} else {
+				errx(EX_USAGE, "audio format is s16 or f32");
+				/* NOTREACHED */
+			}
+			break;
+		case SP_WAV:
+			pParams->wav = 1;
+			break;
+		case SP_RAW:
+			pParams->wav = 0;
+			break;
+		default:
+			errx(EX_USAGE, "unknown audio parameter '%s'", value);
+			/* NOTREACHED */
+		}
+	}
+}
+
+enum { PM_CHIPS, PM_TEXT, PM_BASEBAND, PM_IQ };
+
+#define PM_BASEBAND_RATE	48000
+#define SECONDS_PER_MINUTE	60
+
+/*
+ * Chips of every second the blocks are sent in: packed (a bit per chip,
+ * 64 bytes a second), as text (a line of 512 '0' and '1' a second) or as
+ * raw float baseband samples (+1 and -1 while modulated, 0 elsewhere).
+ * The seconds are copies of the sequence, or of its inverse, prepared
+ * beforehand.
+ */
+static void
+renderPM(DCF77Block_t * pBlock)
+{
+	char * const tokens[] = {
+		[PM_CHIPS]    = "chips",
+		[PM_TEXT]     = "text",
+		[PM_BASEBAND] = "baseband",
+		NULL
+	};
+	char * spec = pmSpec, * value;
+	unsigned rate = PM_BASEBAND_RATE;
+	int kind = getsubopt(&spec, tokens, &value);
+	size_t secondSz;
+	uint8_t * seconds[2];
+	uint64_t chips[DCF77PM_CHIP_WORDS];
+	unsigned bit, k;
+	int i;
+
+	if (kind < 0 || '\0' != *spec) {
+		errx(EX_USAGE, "PM output is chips, text or baseband[=<rate>]");
+		/* NOTREACHED */
+	}
+	if (PM_BASEBAND == kind && NULL != value) {
+		rate = (unsigned)synthParamValue("baseband", value, 1000,
+		    1000000);
+	}
+
+	secondSz = (PM_CHIPS == kind) ? DCF77PM_CHIPS_QTY / 8 :
+	    (PM_TEXT == kind) ? DCF77PM_CHIPS_QTY + 1 : rate * sizeof(float);
+	for (bit = 0; bit < 2; ++bit) {
+		seconds[bit] = malloc(secondSz);
+		if (NULL == seconds[bit]) {
+			err(EX_OSERR, "no memory for PM seconds");
+			/* NOTREACHED */
+		}
+
+		DCF77PM_SecondChips(bit, chips);
+		for (k = 0; k < DCF77PM_CHIPS_QTY && PM_BASEBAND != kind; ++k) {
+			unsigned chip = (chips[k / 64] >> (k % 64)) & 1u;
+
+			if (PM_TEXT == kind) {
+				seconds[bit][k] = (uint8_t)('0' + chip);
+			} else if (0 == k % 8) {
+				seconds[bit][k / 8] = (uint8_t)chip;
+			} else {
+				seconds[bit][k / 8] |= (uint8_t)(chip << (k % 8));
+			}
+		}
+		if (PM_TEXT == kind) {
+			seconds[bit][DCF77PM_CHIPS_QTY] = '\n';
+		} else if (PM_BASEBAND == kind) {
+			DCF77PM_RenderBaseband(bit, rate, (float *)seconds[bit]);
+		}
+	}
+
+	if (NULL != outputPath && NULL == freopen(outputPath, "wb", stdout)) {
+		err(EX_CANTCREAT, "%s", outputPath);
+		/* NOTREACHED */
+	}
+	for (i = 0; i < createBlocks; ++i) {
+		unsigned secondsQty = SECONDS_PER_MINUTE +
+		    (DCF77TimeCode_HasLeapSecond(pBlock) ? 1u : 0u);
+
+		for (k = 0; k < secondsQty; ++k) {
+			outWrite(seconds[DCF77PM_BitOfSecond(pBlock, k)],
+			    secondSz);
+		}
+		DCF77TimeCode_AdvanceByMinute(pBlock);
+	}
+
+	free(seconds[0]);
+	free(seconds[1]);
+}
+
+static void
+printBlock(const DCF77Block_t * pBlock)
+{
+	char textBlock[BLOCK_TEXT_SZ];
+
+	DCF77Block_ToText(pBlock, textBlock, BLOCK_TEXT_SZ);
+	textBlock[DCF77BLOCK_TEXT_LEN] = '\n';
+
+	outWrite(textBlock, BLOCK_TEXT_SZ);
 }
 
 static void getCurrentTime(struct tm * pStm);
@@ -326,86 +824,647 @@ parseAsDCF77Block(const char * userInput, struct tm * pStm)
 	*pStm = stm;
 }
 
-#define CTBUF_SZ 80
+static void forEachInput(void (*processLine)(const char * line));
+static void forEachInputLine(void (*processLine)(const char * line));
+static void forEachFileBlock(void (*processLine)(const char * line));
+static void forEachAudioBlock(void (*processLine)(const char * line));
+static void forEachBitsBlock(void (*processLine)(const char * line));
+static void forEachPMBlock(void (*processLine)(const char * line));
+static void dumpBlock(const char * textBlock);
+static void dumpBlockDetailed(const char * textBlock);
+static void blockFromText(const char * textBlock, DCF77Block_t * pBlock);
+static const DCF77Block_t * selectFileBlocks(const DCF77BlockFile_t * pFile,
+	uint64_t * pQty);
+
+/* what asctime(3) gives */
+#define ASCTIME_FORMAT "%a %b %e %H:%M:%S %Y"
+
+static DCF77Format_t dumpFormat;
+
 static void
 processDumpBlockCmd(int argc, char * argv[])
 {
-	DCF77Block_t block;
-	struct tm stm;
-	char ctBuf[CTBUF_SZ];
 	int i;
 
+	DCF77Format_Compile(&dumpFormat,
+	    (NULL == dumpTimeFormat) ? ASCTIME_FORMAT : dumpTimeFormat);
+
+	if (0 == argc || NULL != inputPath) {
+		forEachInput(dumpBlock);
+	}
+
 	for (i = 0; i < argc; ++i) {
-		ctBuf[0] = '\0';
+		dumpBlock(argv[i]);
+	}
+}
 
-		DCF77Block_FromText(argv[i], &block);
-		DCF77TimeCode_ConvertToStructTM(&block, &stm);
+static void
+processDetailedDumpCmd(int argc, char * argv[])
+{
+	int i;
 
-		if (NULL == dumpTimeFormat) {
-			asctime_r(&stm, ctBuf);
-		} else {
-			if (0u == strftime(ctBuf, CTBUF_SZ,
-					dumpTimeFormat, &stm)) {
-				/* strftime() produced nothing, thus: */
-				ctBuf[0] = '\0';
-			}
-			strncat(ctBuf, "\n", CTBUF_SZ);
-		}
+	if (0 == argc || NULL != inputPath) {
+		forEachInput(dumpBlockDetailed);
+	}
 
-		printf("%s -> %s", argv[i], ctBuf);
+	for (i = 0; i < argc; ++i) {
+		dumpBlockDetailed(argv[i]);
 	}
 }
 
+/* blocks DCF77Continuity_Push() is handed at once */
+#define CHECK_BATCH	4096
+
+static DCF77Continuity_t continuity;
+static DCF77Block_t checkBatch[CHECK_BATCH];
+static size_t checkBatchQty = 0u;
+
 static void
-dumpBlockDetailed(const char * pBlock);
+printBreakRange(void * ctx, const DCF77ContinuityRange_t * pRange)
+{
+	char buf[96];
+	int len;
+
+	(void)ctx;
+	if (1u == pRange->qty) {
+		len = snprintf(buf, sizeof(buf), "# discontinuity at block %"
+		    PRIu64 ":", pRange->first);
+	} else {
+		len = snprintf(buf, sizeof(buf), "# discontinuity at blocks %"
+		    PRIu64 "-%" PRIu64 ":", pRange->first,
+		    pRange->first + pRange->qty - 1);
+	}
+	snprintf(&buf[len], sizeof(buf) - (size_t)len, "%s%s%s\n",
+	    (pRange->reasons & DCF77CONTINUITY_TIME) ? " time" : "",
+	    (pRange->reasons & DCF77CONTINUITY_ZONE) ? " Z1/Z2" : "",
+	    (pRange->reasons & DCF77CONTINUITY_A1) ? " A1" : "");
+	outPuts(buf);
+}
 
 static void
-processDetailedDumpCmd(int argc, char * argv[])
+checkContinuity(const char * textBlock)
+{
+	blockFromText(textBlock, &checkBatch[checkBatchQty]);
+
+	if (CHECK_BATCH == ++checkBatchQty) {
+		DCF77Continuity_Push(&continuity, checkBatch, checkBatchQty);
+		checkBatchQty = 0u;
+	}
+}
+
+/*
+ * Blocks are counted from 0 in the order read.  The hours are advanced
+ * through a DST table of the whole century blocks can tell, so that
+ * libc stays out of the way.  A block file is checked right where it is
+ * mapped.
+ */
+static void
+processCheckCmd(int argc, char * argv[])
 {
+	DCF77BlockFile_t file;
+	const DCF77Block_t * pBlock;
+	uint64_t qty, rangesQty;
+	char buf[80];
 	int i;
 
+	DCF77DSTTable_Build(&dstTable, 2000, 2099);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+	DCF77Continuity_Init(&continuity, printBreakRange, NULL);
+
+	if (NULL != inputPath && DCF77BlockFile_HasMagic(inputPath)) {
+		DCF77BlockFile_Open(&file, inputPath);
+		pBlock = selectFileBlocks(&file, &qty);
+		DCF77Continuity_Push(&continuity, pBlock, (size_t)qty);
+		DCF77BlockFile_Close(&file);
+	} else if (0 == argc || NULL != inputPath) {
+		forEachInput(checkContinuity);
+	}
+
 	for (i = 0; i < argc; ++i) {
-		printf("# %s\n", argv[i]);
-		dumpBlockDetailed(argv[i]);
+		checkContinuity(argv[i]);
 	}
+	DCF77Continuity_Push(&continuity, checkBatch, checkBatchQty);
+
+	rangesQty = DCF77Continuity_Finish(&continuity);
+	snprintf(buf, sizeof(buf), "# %" PRIu64 " blocks, %" PRIu64
+	    " discontinuities\n", continuity.seen, rangesQty);
+	outPuts(buf);
 }
 
-static void printFieldViews(const DCF77FieldViews_t * pFieldView);
+static void
+forEachInput(void (*processLine)(const char * line))
+{
+	if (0 != bitsScan) {
+		forEachBitsBlock(processLine);
+	} else if (NULL != pmSpec) {
+		forEachPMBlock(processLine);
+	} else if (NULL != inputPath && DCF77BlockFile_HasMagic(inputPath)) {
+		forEachFileBlock(processLine);
+	} else if (NULL != audioSpec || (NULL != inputPath &&
+	    DCF77Demod_HasWAVMagic(inputPath))) {
+		forEachAudioBlock(processLine);
+	} else {
+		forEachInputLine(processLine);
+	}
+}
+
+/*
+ * All the blocks of the file, or -n of them starting with the minute
+ * selected by -t and -s.
+ */
+static const DCF77Block_t *
+selectFileBlocks(const DCF77BlockFile_t * pFile, uint64_t * pQty)
+{
+	const DCF77Block_t * pBlock = pFile->blocks;
+	uint64_t qty = pFile->qty;
+
+	if (NULL != timeSpec || 0 != startOffset) {
+		struct tm stm;
+
+		parseTimeSpec(timeSpec, &stm);
+		advanceTimeByMinutes(&stm, startOffset);
+
+		pBlock = DCF77BlockFile_BlockAt(pFile, mktime(&stm));
+		qty = (NULL == pBlock) ? 0u : pFile->qty - (uint64_t)(pBlock -
+		    pFile->blocks);
+		if (createBlocks >= 0 && (uint64_t)createBlocks < qty) {
+			qty = (uint64_t)createBlocks;
+		}
+	}
+
+	*pQty = qty;
+	return pBlock;
+}
 
 static void
-dumpBlockDetailed(const char * pBlock)
+forEachFileBlock(void (*processLine)(const char * line))
 {
-	DCF77Block_t block;
-	const DCF77FieldViews_t * pFieldsViews = NULL;
-	size_t fieldsQty = 0u;
+	DCF77BlockFile_t file;
+	char textBlock[BLOCK_TEXT_SZ];
+	const DCF77Block_t * pBlock;
+	uint64_t qty, i;
+
+	DCF77BlockFile_Open(&file, inputPath);
+	pBlock = selectFileBlocks(&file, &qty);
+
+	for (i = 0; i < qty; ++i) {
+		DCF77Block_ToText(&pBlock[i], textBlock, BLOCK_TEXT_SZ);
+		processLine(textBlock);
+	}
+
+	DCF77BlockFile_Close(&file);
+}
 
-	DCF77Block_FromText(pBlock, &block);
+#define INBUF_SZ (1024 * 1024)
 
-	DCF77TimeCode_SplitInFields(&block, &pFieldsViews, &fieldsQty);
+static void
+processDemodMinute(void * ctx, const DCF77DemodMinute_t * pMinute)
+{
+	void (*processLine)(const char * line) = *(void (**)(const char *))ctx;
+	char textBlock[BLOCK_TEXT_SZ];
+	uint64_t missing = DCF77DEMOD_ALL_PULSES & ~pMinute->present;
 
-	if (NULL == pFieldsViews) {
+	if (0u != missing) {
+		outFlush();
+		warnx("minute mark at %.3f s: %d pulses missing, skipped",
+		    (double)pMinute->markMs / 1000.0,
+		    __builtin_popcountll(missing));
 		return;
 	}
 
-	for (size_t i = 0; i < fieldsQty; ++i) {
-		printFieldViews(&pFieldsViews[i]);
-		printf("\n");
+	DCF77Block_ToText(&pMinute->block, textBlock, BLOCK_TEXT_SZ);
+	processLine(textBlock);
+}
+
+/*
+ * Audio samples: a WAV file, or raw samples described by -a.  A block
+ * shows up once the minute mark after it is seen.
+ */
+static void
+forEachAudioBlock(void (*processLine)(const char * line))
+{
+	DCF77Demod_t demod;
+	DCF77DemodInput_t input;
+	const char * path = (NULL == inputPath) ? "stdin" : inputPath;
+	FILE * in = stdin;
+
+	if (NULL != inputPath && 0 != strcmp(inputPath, "-")) {
+		in = fopen(inputPath, "rb");
+		if (NULL == in) {
+			err(EX_NOINPUT, "%s", inputPath);
+			/* NOTREACHED */
+		}
+	}
+	(void)setvbuf(in, NULL, _IOFBF, INBUF_SZ);
+
+	if (NULL != audioSpec) {
+		DCF77SynthParams_t params;
+
+		DCF77Synth_DefaultParams(&params);
+		parseSynthParams(audioSpec, &params);
+		input.sampleRate = params.sampleRate;
+		input.channels = 1;
+		input.format = params.format;
+		if (params.wav) {
+			DCF77Demod_ReadWAVHeader(in, path, &input);
+		}
+	} else {
+		DCF77Demod_ReadWAVHeader(in, path, &input);
+	}
+
+	DCF77Demod_Init(&demod, input.sampleRate, processDemodMinute,
+	    &processLine);
+	DCF77Demod_ProcessStream(&demod, in, path, &input);
+
+	if (stdin != in) {
+		fclose(in);
+	}
+}
+
+/*
+ * Empty lines and lines starting with '#' (as in -D output) are skipped.
+ */
+static void
+forEachInputLine(void (*processLine)(const char * line))
+{
+	FILE * in = stdin;
+	char * line = NULL;
+	size_t lineSz = 0u;
+	ssize_t lineLen;
+
+	if (NULL != inputPath && 0 != strcmp(inputPath, "-")) {
+		in = fopen(inputPath, "r");
+		if (NULL == in) {
+			err(EX_NOINPUT, "%s", inputPath);
+			/* NOTREACHED */
+		}
+	}
+	(void)setvbuf(in, NULL, _IOFBF, INBUF_SZ);
+
+	while ((lineLen = getline(&line, &lineSz, in)) > 0) {
+		while (lineLen > 0 && ('\n' == line[lineLen - 1] ||
+		    '\r' == line[lineLen - 1])) {
+			line[--lineLen] = '\0';
+		}
+		if (0 == lineLen || '#' == line[0])
+			continue;
+
+		processLine(line);
+	}
+
+	if (ferror(in)) {
+		outFlush();
+		err(EX_IOERR, "%s", (NULL == inputPath) ? "stdin" : inputPath);
+		/* NOTREACHED */
+	}
+
+	free(line);
+	if (stdin != in) {
+		fclose(in);
+	}
+}
+
+static DCF77Bits_t capturedBits;
+
+static void
+appendBits(const char * line)
+{
+	DCF77Sync_AppendText(&capturedBits, line);
+}
+
+static void
+processSyncFrame(void * ctx, uint64_t second, const DCF77Block_t * pBlock)
+{
+	void (*processLine)(const char * line) = *(void (**)(const char *))ctx;
+	char textBlock[BLOCK_TEXT_SZ];
+	char posBuf[32];
+
+	snprintf(posBuf, sizeof(posBuf), "# second %" PRIu64 "\n", second);
+	outPuts(posBuf);
+
+	DCF77Block_ToText(pBlock, textBlock, BLOCK_TEXT_SZ);
+	processLine(textBlock);
+}
+
+/*
+ * Raw bits, a second each with no framing: the whole capture is read,
+ * then searched for valid minute frames, each preceded by a comment
+ * telling the second (counted from 0) it starts at.
+ */
+static void
+forEachBitsBlock(void (*processLine)(const char * line))
+{
+	uint64_t found;
+
+	DCF77Sync_InitBits(&capturedBits);
+	forEachInputLine(appendBits);
+
+	found = DCF77Sync_Scan(&capturedBits,
+	    (bitsScan > 1) ? 0u : DCF77SYNC_NEEDS_MARK,
+	    processSyncFrame, &processLine);
+	if (0u == found) {
+		outFlush();
+		warnx("no minute frame within %" PRIu64 " seconds",
+		    capturedBits.qty);
+	}
+
+	DCF77Sync_FreeBits(&capturedBits);
+}
+
+/* start of each second captured, in samples */
+static double * pmStarts;
+static size_t pmStartsCap;
+static unsigned pmRate;
+
+static void
+appendPMSecond(double start, int isPresent, unsigned bit)
+{
+	if (capturedBits.qty == pmStartsCap) {
+		pmStartsCap = (0u == pmStartsCap) ? 4096 : 2 * pmStartsCap;
+		pmStarts = realloc(pmStarts, pmStartsCap * sizeof(*pmStarts));
+		if (NULL == pmStarts) {
+			err(EX_OSERR, "no memory for %zu seconds", pmStartsCap);
+			/* NOTREACHED */
+		}
+	}
+	pmStarts[capturedBits.qty] = start;
+	DCF77Sync_AppendBit(&capturedBits, isPresent, (int)bit);
+}
+
+/*
+ * Seconds the receiver skipped while it searched for the signal are
+ * put back as missing, so that the capture stays a second per bit.
+ */
+static void
+processPMSecond(void * ctx, const DCF77PMRxSecond_t * pSecond)
+{
+	double last;
+
+	(void)ctx;
+	if (0u != capturedBits.qty) {
+		last = pmStarts[capturedBits.qty - 1];
+		while (pSecond->start - last > 1.5 * pmRate) {
+			last += pmRate;
+			appendPMSecond(last, 0, 0u);
+		}
+	}
+	appendPMSecond(pSecond->start, pSecond->isPresent, pSecond->bit);
+}
+
+static void
+processPMFrame(void * ctx, uint64_t second, const DCF77Block_t * pBlock)
+{
+	void (*processLine)(const char * line) = *(void (**)(const char *))ctx;
+	char textBlock[BLOCK_TEXT_SZ];
+	char posBuf[64];
+
+	snprintf(posBuf, sizeof(posBuf), "# second %" PRIu64 " at %.6f s\n",
+	    second, pmStarts[second] / pmRate);
+	outPuts(posBuf);
+
+	DCF77Block_ToText(pBlock, textBlock, BLOCK_TEXT_SZ);
+	processLine(textBlock);
+}
+
+#define PM_FRAMES_READ	4096
+
+/*
+ * Raw float samples of the carrier's phase (-p baseband) or I/Q pairs
+ * (-p iq): the bits the phase modulation carries are captured whole,
+ * then searched for minute frames as -bb does, each preceded by a
+ * comment telling the second it starts at and when, in seconds into
+ * the stream.
+ */
+static void
+forEachPMBlock(void (*processLine)(const char * line))
+{
+	char * const tokens[] = {
+		"baseband", "iq", NULL
+	};
+	char * spec = pmSpec, * value;
+	int kind = getsubopt(&spec, tokens, &value);
+	const char * path = (NULL == inputPath) ? "stdin" : inputPath;
+	FILE * in = stdin;
+	DCF77PMRx_t rx;
+	float * samples;
+	size_t frameSz, qty;
+	uint64_t found;
+
+	if (kind < 0 || '\0' != *spec) {
+		errx(EX_USAGE, "PM input is baseband[=<rate>] or iq[=<rate>]");
+		/* NOTREACHED */
+	}
+	kind = (0 == kind) ? PM_BASEBAND : PM_IQ;
+	pmRate = PM_BASEBAND_RATE;
+	if (NULL != value) {
+		pmRate = (unsigned)synthParamValue(tokens[kind - PM_BASEBAND],
+		    value, 1000, 1000000);
+	}
+
+	if (NULL != inputPath && 0 != strcmp(inputPath, "-")) {
+		in = fopen(inputPath, "rb");
+		if (NULL == in) {
+			err(EX_NOINPUT, "%s", inputPath);
+			/* NOTREACHED */
+		}
+	}
+	(void)setvbuf(in, NULL, _IOFBF, INBUF_SZ);
+
+	frameSz = (PM_IQ == kind) ? 2 * sizeof(float) : sizeof(float);
+	samples = malloc(PM_FRAMES_READ * frameSz);
+	if (NULL == samples) {
+		err(EX_OSERR, "no memory for PM samples");
+		/* NOTREACHED */
+	}
+
+	DCF77Sync_InitBits(&capturedBits);
+	DCF77PMRx_Init(&rx, pmRate, processPMSecond, NULL);
+	while ((qty = fread(samples, frameSz, PM_FRAMES_READ, in)) > 0) {
+		if (PM_IQ == kind) {
+			DCF77PMRx_PushIQ(&rx, samples, qty);
+		} else {
+			DCF77PMRx_Push(&rx, samples, qty);
+		}
+	}
+	if (ferror(in)) {
+		err(EX_IOERR, "%s", path);
+		/* NOTREACHED */
+	}
+	DCF77PMRx_Free(&rx);
+	free(samples);
+	if (stdin != in) {
+		fclose(in);
+	}
+
+	found = DCF77Sync_Scan(&capturedBits, 0u, processPMFrame,
+	    &processLine);
+	if (0u == found) {
+		outFlush();
+		warnx("no minute frame within %" PRIu64 " seconds",
+		    capturedBits.qty);
+	}
+
+	DCF77Sync_FreeBits(&capturedBits);
+	free(pmStarts);
+	pmStarts = NULL;
+	pmStartsCap = 0u;
+}
+
+static void
+blockFromText(const char * textBlock, DCF77Block_t * pBlock)
+{
+	if (DCF77BLOCK_TEXT_OK != DCF77Block_ParseText(textBlock, pBlock)) {
+		/* let preceding output out, then report and exit */
+		outFlush();
+		DCF77Block_FromText(textBlock, pBlock);
+	}
+}
+
+
+#define CTBUF_SZ 80
+
+static DCF77Block_t lastGoodBlock;
+static int haveLastGoodBlock = 0;
+
+/*
+ * Faulty blocks are left out with a comment line (as skipped on input);
+ * a repaired one is preceded by a comment naming the block received.
+ * Returns whether the block, maybe repaired, is fit to dump.
+ */
+static int
+checkBlock(const char * textBlock, DCF77Block_t * pBlock)
+{
+	char errBuf[CTBUF_SZ];
+	unsigned errors = DCF77TimeCode_Validate(pBlock);
+
+	if (0u != errors) {
+		if (DCF77TIMECODE_REPAIR_FIXED == DCF77TimeCode_Repair(
+		    haveLastGoodBlock ? &lastGoodBlock : NULL, pBlock)) {
+			outPuts("# ");
+			outPuts(textBlock);
+			outPuts(" repaired\n");
+		} else {
+			DCF77TimeCode_DescribeErrors(errors, errBuf,
+			    sizeof(errBuf));
+			outPuts("# ");
+			outPuts(textBlock);
+			outPuts(" invalid: ");
+			outPuts(errBuf);
+			outPuts("\n");
+			haveLastGoodBlock = 0;
+
+			return 0;
+		}
+	}
+
+	lastGoodBlock = *pBlock;
+	haveLastGoodBlock = 1;
+
+	return 1;
+}
+
+static DCF77Block_t weatherFrame[DCF77WEATHER_FRAME_BLOCKS];
+static size_t weatherFrameQty = 0;
+
+/*
+ * The last three blocks dumped; once they make a weather frame, its bits
+ * (as on air, deciphering is not ours to do) follow as a comment.
+ */
+static void
+dumpWeather(const DCF77Block_t * pBlock)
+{
+	char weatherBuf[32];
+
+	if (DCF77WEATHER_FRAME_BLOCKS == weatherFrameQty) {
+		memmove(&weatherFrame[0], &weatherFrame[1],
+		    (DCF77WEATHER_FRAME_BLOCKS - 1) * sizeof(weatherFrame[0]));
+		--weatherFrameQty;
+	}
+	weatherFrame[weatherFrameQty++] = *pBlock;
+
+	if (DCF77Weather_IsFrameAt(weatherFrame, weatherFrameQty)) {
+		snprintf(weatherBuf, sizeof(weatherBuf),
+		    "# weather %011" PRIx64 "\n",
+		    DCF77Weather_Get(weatherFrame, NULL));
+		outPuts(weatherBuf);
+		weatherFrameQty = 0;
+	}
+}
+
+static void
+dumpBlock(const char * textBlock)
+{
+	DCF77Block_t block;
+	struct tm stm;
+	char ctBuf[CTBUF_SZ];
+	char fixedText[BLOCK_TEXT_SZ];
+	size_t ctLen;
+
+	blockFromText(textBlock, &block);
+	if (validateBlocks) {
+		if (!checkBlock(textBlock, &block))
+			return;
+
+		DCF77Block_ToText(&block, fixedText, sizeof(fixedText));
+		textBlock = fixedText;
+	}
+	DCF77TimeCode_ConvertToStructTM(&block, &stm);
+
+	/* nothing rendered leaves the time empty */
+	ctLen = DCF77Format_Render(&dumpFormat, &stm, ctBuf, CTBUF_SZ - 1);
+
+	outPuts(textBlock);
+	outWrite(" -> ", 4);
+	outWrite(ctBuf, ctLen);
+	outWrite("\n", 1);
+
+	if (showWeather) {
+		dumpWeather(&block);
+	}
+}
+
+static void printFieldViews(const DCF77FieldViews_t * pFieldView);
+
+static void
+dumpBlockDetailed(const char * textBlock)
+{
+	DCF77Block_t block;
+	DCF77FieldSplit_t split;
+
+	blockFromText(textBlock, &block);
+
+	DCF77TimeCode_SplitInFieldsR(&block, &split,
+	    DCF77FIELDSPLIT_BINSTR | DCF77FIELDSPLIT_HEXSTR);
+
+	outPuts("# ");
+	outPuts(textBlock);
+	outPuts("\n");
+
+	for (size_t i = 0; i < DCF77FIELDSPLIT_ROWS_QTY; ++i) {
+		printFieldViews(&split.views[i]);
+		outPuts("\n");
 	}
 }
 
 static const char * safeStr(const char * str);
+static void outPadded(const char * str, int width);
 
 static void
 printFieldViews(const DCF77FieldViews_t * pFieldView)
 {
 	if (NULL == pFieldView) {
-		printf("<NULL>");
+		outPuts("<NULL>");
 		return;
 	}
 
-	printf("%14s : %4s : %-7s : %s",
-	    safeStr(pFieldView->asBinStr), safeStr(pFieldView->asHexStr),
-	    safeStr(pFieldView->name),     safeStr(pFieldView->nameDescr));
+	/* "%14s : %4s : %-7s : %s" */
+	outPadded(safeStr(pFieldView->asBinStr), 14);
+	outPuts(" : ");
+	outPadded(safeStr(pFieldView->asHexStr), 4);
+	outPuts(" : ");
+	outPadded(safeStr(pFieldView->name), -7);
+	outPuts(" : ");
+	outPuts(safeStr(pFieldView->nameDescr));
 }
 
 static const char *
@@ -413,3 +1472,228 @@ safeStr(const char * str)
 {
 	return ((NULL == str) ? "#" : str);
 }
+
+/*
+ * All the output goes through one large buffer written out in big chunks
+ * instead of a stdio call per line.
+ */
+#define OUTBUF_SZ (256 * 1024)
+static char outBuf[OUTBUF_SZ];
+static size_t outLen = 0u;
+
+static void
+outFlush(void)
+{
+	if (0u == outLen)
+		return;
+
+	if (fwrite(outBuf, 1, outLen, stdout) != outLen ||
+	    0 != fflush(stdout)) {
+		err(EX_IOERR, "stdout");
+		/* NOTREACHED */
+	}
+	outLen = 0u;
+}
+
+static void
+outWrite(const void * data, size_t sz)
+{
+	if (sz > OUTBUF_SZ - outLen) {
+		outFlush();
+
+		if (sz > OUTBUF_SZ) {
+			if (fwrite(data, 1, sz, stdout) != sz) {
+				err(EX_IOERR, "stdout");
+				/* NOTREACHED */
+			}
+			return;
+		}
+	}
+
+	memcpy(&outBuf[outLen], data, sz);
+	outLen += sz;
+}
+
+static void
+outPuts(const char * str)
+{
+	outWrite(str, strlen(str));
+}
+
+/*
+ * Pads to abs(width): on the left for positive widths, like printf(3).
+ */
+static void
+outPadded(const char * str, int width)
+{
+	static const char spaces[] = "                ";
+	int len = (int)strlen(str);
+	int pad = ((width < 0) ? -width : width) - len;
+
+	if (pad > (int)(sizeof(spaces) - 1)) {
+		pad = (int)(sizeof(spaces) - 1);
+	}
+	if (width > 0 && pad > 0) {
+		outWrite(spaces, (size_t)pad);
+	}
+	outWrite(str, (size_t)len);
+	if (width < 0 && pad > 0) {
+		outWrite(spaces, (size_t)pad);
+	}
+}
+
+static void printTxStats(const char * edge, const DCF77TxJitter_t * pJitter);
+
+/*
+ * Waits for the next minute, then transmits the block of the minute
+ * after it (DCF77 announces the time of the coming minute), -n times.
+ */
+static void
+processTransmitCmd(int argc, char * argv[])
+{
+	DCF77TxSink_t sink;
+	DCF77TxStats_t stats;
+	DCF77Shm_t shm = { NULL, NULL, 0 };
+	DCF77Block_t block, onAir;
+	struct tm stm;
+	time_t minuteStart = (time(NULL) / 60 + 1) * 60;
+	time_t nextMinute = minuteStart + 60;
+	int i;
+
+	(void)localtime_r(&nextMinute, &stm);
+	DCF77DSTTable_Build(&dstTable, stm.tm_year + 1900,
+	    stm.tm_year + 1900 + 1);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+	DCF77TimeCode_ConvertFromStructTM(&block, &stm);
+
+	if (NULL != inputPath) {
+		DCF77Shm_Attach(&shm, inputPath);
+	}
+	DCF77Transmit_OpenSink(&sink, outputPath);
+
+	for (i = 0; createBlocks <= 0 || i < createBlocks; ++i) {
+		onAir = block;
+		if (NULL != shm.pRegion &&
+		    !DCF77Shm_BlockAt(&shm, minuteStart + 60, &onAir)) {
+			warnx("%s: no block for the coming minute, "
+			    "sending own", inputPath);
+		}
+
+		DCF77Transmit_ResetStats(&stats);
+		DCF77Transmit_Minute(&sink, &onAir, minuteStart, &stats);
+
+		printTxStats("leading", &stats.leading);
+		printTxStats("trailing", &stats.trailing);
+
+		DCF77TimeCode_AdvanceByMinute(&block);
+		minuteStart += 60;
+	}
+
+	DCF77Transmit_CloseSink(&sink);
+	DCF77Shm_Close(&shm);
+}
+
+static void
+printTxStats(const char * edge, const DCF77TxJitter_t * pJitter)
+{
+	if (0 == pJitter->qty)
+		return;
+
+	fprintf(stderr, "# %s edges late by: min %.1f avg %.1f max %.1f us\n",
+	    edge, pJitter->minNs / 1e3, pJitter->sumNs / pJitter->qty / 1e3,
+	    pJitter->maxNs / 1e3);
+}
+
+#define SERVE_AHEAD_MINUTES (24 * 60)
+
+/*
+ * Protocol is described in DCF77Server.h.  A day is kept ahead unless
+ * -n tells otherwise.
+ */
+static void
+processServeCmd(int argc, char * argv[])
+{
+	size_t ahead = SERVE_AHEAD_MINUTES;
+	time_t now = time(NULL);
+	struct tm stm;
+
+	if (isCreateBlocksGiven) {
+		if (createBlocks < 1) {
+			errx(EX_USAGE, "-n for -S must be 1 or more minutes");
+			/* NOTREACHED */
+		}
+		ahead = (size_t)createBlocks;
+	}
+
+	(void)localtime_r(&now, &stm);
+	DCF77DSTTable_Build(&dstTable, stm.tm_year + 1900,
+	    stm.tm_year + 1900 + 1);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+
+	DCF77Server_Run(socketPath, ahead);
+}
+
+static volatile sig_atomic_t isPublishing = 1;
+
+static void
+onPublishStop(int sig)
+{
+	(void)sig;
+	isPublishing = 0;
+}
+
+/*
+ * Publishes the block on air and those of the following minutes right
+ * after every minute boundary, until SIGINT or SIGTERM.
+ */
+static void
+processPublishCmd(int argc, char * argv[])
+{
+	DCF77Block_t blocks[DCF77SHM_QTY];
+	struct sigaction sa;
+	struct timespec boundary;
+	struct tm stm;
+	DCF77Shm_t shm;
+	time_t now, onAir;
+	int i;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = onPublishStop;
+	sigemptyset(&sa.sa_mask);
+	(void)sigaction(SIGINT, &sa, NULL);
+	(void)sigaction(SIGTERM, &sa, NULL);
+
+	onAir = (time(NULL) / 60 + 1) * 60;
+	(void)localtime_r(&onAir, &stm);
+	DCF77DSTTable_Build(&dstTable, stm.tm_year + 1900,
+	    stm.tm_year + 1900 + 1);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+
+	DCF77Shm_Create(&shm, shmName);
+
+	boundary.tv_sec = time(NULL);
+	boundary.tv_nsec = 0;
+
+	while (isPublishing) {
+		/* time(2) may lag behind the boundary just waited for */
+		now = time(NULL);
+		onAir = ((now > boundary.tv_sec) ? now : boundary.tv_sec);
+		onAir = (onAir / 60 + 1) * 60;
+		(void)localtime_r(&onAir, &stm);
+		DCF77TimeCode_ConvertFromStructTM(&blocks[0], &stm);
+		for (i = 1; i < DCF77SHM_QTY; ++i) {
+			blocks[i] = blocks[i - 1];
+			DCF77TimeCode_AdvanceByMinute(&blocks[i]);
+		}
+		DCF77Shm_Publish(&shm, onAir, blocks);
+
+		boundary.tv_sec = (time(NULL) / 60 + 1) * 60;
+		boundary.tv_nsec = 0;
+		while (isPublishing && EINTR == clock_nanosleep(CLOCK_REALTIME,
+		    TIMER_ABSTIME, &boundary, NULL)) {
+			;
+		}
+	}
+
+	DCF77Shm_Close(&shm);
+}
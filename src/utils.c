@@ -11,3 +11,35 @@ normalizeStructTM(struct tm * pStm)
 	t = mktime(pStm);
 	(void)localtime_r(&t, pStm);
 }
+
+/*
+ * Days since 1970-01-01 in proleptic Gregorian calendar, no libc (and no
+ * timezone) involved.  Months are 1-12.
+ */
+long
+daysFromCivil(int year, int month, int day)
+{
+	long y   = (month <= 2) ? year - 1 : year;
+	long era = (y >= 0 ? y : y - 399) / 400;
+	long yoe = y - era * 400;
+	long doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+	return era * 146097 + doe - 719468;
+}
+
+void
+civilFromDays(long days, int * pYear, int * pMonth, int * pDay)
+{
+	long z   = days + 719468;
+	long era = (z >= 0 ? z : z - 146096) / 146097;
+	long doe = z - era * 146097;
+	long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	long mp  = (5 * doy + 2) / 153;
+	int month = (int)(mp < 10 ? mp + 3 : mp - 9);
+
+	*pDay   = (int)(doy - (153 * mp + 2) / 5 + 1);
+	*pMonth = month;
+	*pYear  = (int)(yoe + era * 400 + (month <= 2));
+}
@@ -3,5 +3,7 @@
 #include <time.h>
 
 void normalizeStructTM(struct tm * pStm);
+long daysFromCivil(int year, int month, int day);
+void civilFromDays(long days, int * pYear, int * pMonth, int * pDay);
 
 #endif /* #ifndef D_tils_h */
@@ -0,0 +1,68 @@
+#include "CppUTest/TestHarness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77BlockFile.h"
+};
+
+TEST_GROUP(ABlockFile)
+{
+	enum { QTY = 100, START = 1506433560 };
+	char path[32];
+	DCF77Block_t blocks[QTY];
+	DCF77BlockFile_t file;
+
+	void setup() override {
+		DCF77BlockFileWriter_t writer;
+
+		strcpy(path, "/tmp/blockfileXXXXXX");
+		close(mkstemp(path));
+
+		for (int i = 0; i < QTY; ++i) {
+			memset(&blocks[i], i, sizeof(blocks[i]));
+		}
+
+		DCF77BlockFile_Create(&writer, path, START);
+		DCF77BlockFile_Append(&writer, blocks, QTY / 2);
+		DCF77BlockFile_Append(&writer, &blocks[QTY / 2], QTY / 2);
+		DCF77BlockFile_Finish(&writer);
+
+		DCF77BlockFile_Open(&file, path);
+	}
+
+	void teardown() override {
+		DCF77BlockFile_Close(&file);
+		unlink(path);
+	}
+};
+
+TEST(ABlockFile, IsRecognizedByMagic) {
+	CHECK_TRUE(DCF77BlockFile_HasMagic(path));
+	CHECK_FALSE(DCF77BlockFile_HasMagic("/dev/null"));
+}
+
+TEST(ABlockFile, KeepsHeaderFields) {
+	LONGS_EQUAL(START, file.startTime);
+	LONGS_EQUAL(QTY, file.qty);
+}
+
+TEST(ABlockFile, MapsBlocksAsWritten) {
+	MEMCMP_EQUAL(blocks, file.blocks, sizeof(blocks));
+}
+
+TEST(ABlockFile, SeeksToMinute) {
+	POINTERS_EQUAL(&file.blocks[0], DCF77BlockFile_BlockAt(&file, START));
+	POINTERS_EQUAL(&file.blocks[0],
+	    DCF77BlockFile_BlockAt(&file, START + 59));
+	POINTERS_EQUAL(&file.blocks[1],
+	    DCF77BlockFile_BlockAt(&file, START + 60));
+	POINTERS_EQUAL(&file.blocks[QTY - 1],
+	    DCF77BlockFile_BlockAt(&file, START + 60 * QTY - 1));
+}
+
+TEST(ABlockFile, HasNoBlocksOutsideItsRange) {
+	POINTERS_EQUAL(NULL, DCF77BlockFile_BlockAt(&file, START - 1));
+	POINTERS_EQUAL(NULL, DCF77BlockFile_BlockAt(&file, START + 60 * QTY));
+}
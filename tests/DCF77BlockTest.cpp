@@ -0,0 +1,91 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+extern "C"
+{
+#include "DCF77Block.h"
+};
+
+TEST_GROUP(ABlockTextCodec)
+{
+	DCF77Block_t block;
+	char text[DCF77BLOCK_TEXT_LEN + 1];
+
+	void setup() override {
+		memset(&block, 0xA5, sizeof(block));
+	}
+
+	void SET_BLOCK(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3,
+	    uint8_t b4, uint8_t b5, uint8_t b6, uint8_t b7) {
+		block.data[0] = b0; block.data[1] = b1;
+		block.data[2] = b2; block.data[3] = b3;
+		block.data[4] = b4; block.data[5] = b5;
+		block.data[6] = b6; block.data[7] = b7;
+	}
+};
+
+TEST(ABlockTextCodec, ConvertsBlockToUppercaseHex) {
+	SET_BLOCK(0x00, 0x00, 0xD2, 0xB8, 0x6A, 0x2A, 0x5D, 0x00);
+
+	DCF77Block_ToText(&block, text, sizeof(text));
+
+	STRCMP_EQUAL("0000D2B86A2A5D00", text);
+}
+
+TEST(ABlockTextCodec, ParsesUpperAndLowercaseHex) {
+	LONGS_EQUAL(DCF77BLOCK_TEXT_OK,
+	    DCF77Block_ParseText("0123456789abcDEF", &block));
+
+	BYTES_EQUAL(0x01, block.data[0]);
+	BYTES_EQUAL(0x23, block.data[1]);
+	BYTES_EQUAL(0x45, block.data[2]);
+	BYTES_EQUAL(0x67, block.data[3]);
+	BYTES_EQUAL(0x89, block.data[4]);
+	BYTES_EQUAL(0xAB, block.data[5]);
+	BYTES_EQUAL(0xCD, block.data[6]);
+	BYTES_EQUAL(0xEF, block.data[7]);
+}
+
+TEST(ABlockTextCodec, RoundTripsEveryByteValueAtEveryPosition) {
+	DCF77Block_t parsed;
+
+	for (int v = 0; v < 256; ++v) {
+		for (int i = 0; i < DCF77BLOCK_SIZE; ++i) {
+			block.data[i] = (uint8_t)(v + 31 * i);
+		}
+		DCF77Block_ToText(&block, text, sizeof(text));
+
+		LONGS_EQUAL(DCF77BLOCK_TEXT_OK,
+		    DCF77Block_ParseText(text, &parsed));
+		MEMCMP_EQUAL(block.data, parsed.data, DCF77BLOCK_SIZE);
+	}
+}
+
+TEST(ABlockTextCodec, IgnoresTextPastBlock) {
+	LONGS_EQUAL(DCF77BLOCK_TEXT_OK,
+	    DCF77Block_ParseText("0000D2B86A2A5D00 -> trailer", &block));
+
+	BYTES_EQUAL(0x5D, block.data[6]);
+}
+
+TEST(ABlockTextCodec, ReportsShortText) {
+	LONGS_EQUAL(DCF77BLOCK_TEXT_TOO_SHORT,
+	    DCF77Block_ParseText("0000D2B86A2A5D0", &block));
+}
+
+TEST(ABlockTextCodec, ReportsInvalidDigitsAndKeepsBlock) {
+	const char valid[] = "0000D2B86A2A5D00";
+
+	for (int i = 0; i < DCF77BLOCK_TEXT_LEN; ++i) {
+		const char * bad = "gG/:@`\x7f\x80 ";
+
+		for (; *bad; ++bad) {
+			memcpy(text, valid, sizeof(valid));
+			text[i] = *bad;
+			memset(&block, 0xA5, sizeof(block));
+
+			LONGS_EQUAL(DCF77BLOCK_TEXT_BAD_DIGIT,
+			    DCF77Block_ParseText(text, &block));
+			BYTES_EQUAL(0xA5, block.data[i / 2]);
+		}
+	}
+}
@@ -0,0 +1,142 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <time.h>
+extern "C"
+{
+#include "DCF77Continuity.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+};
+
+enum { BLOCKS_QTY = 240 };
+
+#define RANGES_MAX 8
+static DCF77ContinuityRange_t ranges[RANGES_MAX];
+static unsigned rangesQty;
+
+static void
+collectRange(void * ctx, const DCF77ContinuityRange_t * pRange)
+{
+	(void)ctx;
+	if (rangesQty < RANGES_MAX)
+		ranges[rangesQty] = *pRange;
+	++rangesQty;
+}
+
+TEST_GROUP(AContinuityCheck)
+{
+	/* Sun Mar 26 00:00 2017 CET on, summer time from 03:00 CEST */
+	DCF77Block_t blocks[BLOCKS_QTY];
+	DCF77Continuity_t check;
+
+	void setup() override {
+		time_t t = 1490482800;
+		struct tm stm;
+
+		(void)localtime_r(&t, &stm);
+		DCF77TimeCode_ConvertFromStructTM(&blocks[0], &stm);
+		for (int i = 1; i < BLOCKS_QTY; ++i) {
+			blocks[i] = blocks[i - 1];
+			DCF77TimeCode_AdvanceByMinute(&blocks[i]);
+		}
+
+		rangesQty = 0;
+		memset(ranges, 0, sizeof(ranges));
+		DCF77Continuity_Init(&check, collectRange, NULL);
+	}
+
+	uint64_t run(size_t qty) {
+		DCF77Continuity_Push(&check, blocks, qty);
+		return DCF77Continuity_Finish(&check);
+	}
+
+	void flip(int i, uint64_t mask) {
+		DCF77TimeCode_StoreWord(DCF77TimeCode_LoadWord(&blocks[i]) ^ mask,
+		    &blocks[i]);
+	}
+
+	void CHECK_RANGE(unsigned n, uint64_t first, uint64_t qty,
+		unsigned reasons) {
+		LONGS_EQUAL(first, ranges[n].first);
+		LONGS_EQUAL(qty, ranges[n].qty);
+		LONGS_EQUAL(reasons, ranges[n].reasons);
+	}
+};
+
+TEST(AContinuityCheck, PassesMinutesOverDSTChange) {
+	LONGS_EQUAL(0, run(BLOCKS_QTY));
+	LONGS_EQUAL(0, rangesQty);
+	LONGS_EQUAL(BLOCKS_QTY, check.seen);
+}
+
+TEST(AContinuityCheck, IgnoresWeatherAndParities) {
+	for (int i = 0; i < BLOCKS_QTY; ++i) {
+		flip(i, DCF77TC_MASK(WEATHER) | DCF77TC_MASK(P1) |
+		    DCF77TC_MASK(R));
+	}
+
+	LONGS_EQUAL(0, run(BLOCKS_QTY));
+}
+
+TEST(AContinuityCheck, ReportsLostMinute) {
+	memmove(&blocks[30], &blocks[31], (BLOCKS_QTY - 31) *
+	    sizeof(blocks[0]));
+
+	LONGS_EQUAL(1, run(BLOCKS_QTY - 1));
+	CHECK_RANGE(0, 30, 1, DCF77CONTINUITY_TIME);
+}
+
+TEST(AContinuityCheck, ReportsBlockOffAsTwoBreaks) {
+	flip(45, UINT64_C(1) << DCF77TC_HOUR_SHIFT);
+
+	LONGS_EQUAL(1, run(BLOCKS_QTY));
+	CHECK_RANGE(0, 45, 2, DCF77CONTINUITY_TIME);
+}
+
+TEST(AContinuityCheck, ReportsZoneFlippedWithinHour) {
+	flip(20, DCF77TC_MASK(Z1) | DCF77TC_MASK(Z2));
+
+	LONGS_EQUAL(1, run(BLOCKS_QTY));
+	CHECK_RANGE(0, 20, 2, DCF77CONTINUITY_ZONE);
+}
+
+TEST(AContinuityCheck, ReportsZoneFlippedWithoutDSTChange) {
+	/* 01:00 CET on claiming to be CEST */
+	for (int i = 60; i < 120; ++i) {
+		flip(i, DCF77TC_MASK(Z1) | DCF77TC_MASK(Z2));
+	}
+
+	LONGS_EQUAL(1, run(120));
+	CHECK_RANGE(0, 60, 1, DCF77CONTINUITY_ZONE);
+}
+
+TEST(AContinuityCheck, ReportsA1MissingInHourBefore) {
+	/* 01:00 to 01:59 CET */
+	flip(77, DCF77TC_MASK(A1));
+
+	LONGS_EQUAL(1, run(BLOCKS_QTY));
+	CHECK_RANGE(0, 77, 2, DCF77CONTINUITY_A1);
+}
+
+TEST(AContinuityCheck, FollowsAcrossPushes) {
+	memmove(&blocks[100], &blocks[101], (BLOCKS_QTY - 101) *
+	    sizeof(blocks[0]));
+	flip(7, UINT64_C(1) << DCF77TC_DOM_SHIFT);
+
+	for (size_t i = 0; i < BLOCKS_QTY - 1; i += 7) {
+		size_t qty = (BLOCKS_QTY - 1 - i < 7) ? BLOCKS_QTY - 1 - i : 7;
+
+		DCF77Continuity_Push(&check, &blocks[i], qty);
+	}
+
+	LONGS_EQUAL(2, DCF77Continuity_Finish(&check));
+	CHECK_RANGE(0, 7, 2, DCF77CONTINUITY_TIME);
+	CHECK_RANGE(1, 100, 1, DCF77CONTINUITY_TIME);
+}
+
+TEST(AContinuityCheck, ReportsRangeOpenAtEnd) {
+	flip(BLOCKS_QTY - 1, UINT64_C(1) << DCF77TC_YEAR_SHIFT);
+
+	LONGS_EQUAL(1, run(BLOCKS_QTY));
+	CHECK_RANGE(0, BLOCKS_QTY - 1, 1, DCF77CONTINUITY_TIME);
+}
@@ -0,0 +1,86 @@
+#include "CppUTest/TestHarness.h"
+#include <time.h>
+extern "C"
+{
+#include "DCF77DSTTable.h"
+#include "utils.h"
+};
+
+/* XXX
+ * The following tests depend on CET/CEST being your local timezone.
+ */
+TEST_GROUP(ADSTTable)
+{
+	DCF77DSTTable_t table;
+
+	void setup() override {
+		DCF77DSTTable_Build(&table, 2017, 2018);
+	}
+
+	long WALL_MINUTE(int year, int mon, int day, int hour, int min) {
+		return (daysFromCivil(year, mon, day) * 24 + hour) * 60 + min;
+	}
+};
+
+TEST(ADSTTable, CoversRequestedYearsOnly) {
+	CHECK_FALSE(DCF77DSTTable_Covers(&table, 2016));
+	CHECK_TRUE(DCF77DSTTable_Covers(&table, 2017));
+	CHECK_TRUE(DCF77DSTTable_Covers(&table, 2018));
+	CHECK_FALSE(DCF77DSTTable_Covers(&table, 2019));
+}
+
+TEST(ADSTTable, FindsTwoTransitionsPerYear) {
+	LONGS_EQUAL(4, table.qty);
+}
+
+TEST(ADSTTable, PinsSummerTimeStart) {
+	const DCF77DSTTransition_t * pTr = &table.transitions[0];
+
+	LONGS_EQUAL(WALL_MINUTE(2017, 3, 26, 2, 0), pTr->wallMinute);
+	LONGS_EQUAL(60, pTr->shiftMinutes);
+	LONGS_EQUAL(0, pTr->isdstBefore);
+	LONGS_EQUAL(1, pTr->isdstAfter);
+}
+
+TEST(ADSTTable, PinsSummerTimeEnd) {
+	const DCF77DSTTransition_t * pTr = &table.transitions[1];
+
+	LONGS_EQUAL(WALL_MINUTE(2017, 10, 29, 3, 0), pTr->wallMinute);
+	LONGS_EQUAL(-60, pTr->shiftMinutes);
+	LONGS_EQUAL(1, pTr->isdstBefore);
+	LONGS_EQUAL(0, pTr->isdstAfter);
+}
+
+TEST(ADSTTable, AnnouncesChangeWithinHourBefore) {
+	CHECK_FALSE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 3, 26, 0, 59), 0));
+	CHECK_TRUE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 3, 26, 1, 0), 0));
+	CHECK_TRUE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 3, 26, 1, 59), 0));
+	CHECK_FALSE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 3, 26, 3, 0), 1));
+}
+
+TEST(ADSTTable, TellsRepeatedHourApartByDSTFlag) {
+	CHECK_TRUE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 10, 29, 2, 30), 1));
+	CHECK_FALSE(DCF77DSTTable_ChangeApproaching(&table,
+	    WALL_MINUTE(2017, 10, 29, 2, 30), 0));
+}
+
+TEST(ADSTTable, GivesUTCOffsetInEffect) {
+	LONGS_EQUAL(3600, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2017, 1, 1, 0, 0), 0));
+	LONGS_EQUAL(3600, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2017, 3, 26, 1, 59), 0));
+	LONGS_EQUAL(7200, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2017, 3, 26, 3, 0), 1));
+	/* the repeated hour, either way */
+	LONGS_EQUAL(7200, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2017, 10, 29, 2, 30), 1));
+	LONGS_EQUAL(3600, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2017, 10, 29, 2, 30), 0));
+	LONGS_EQUAL(3600, DCF77DSTTable_UTCOffset(&table,
+	    WALL_MINUTE(2018, 12, 31, 23, 59), 0));
+}
@@ -0,0 +1,172 @@
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77Demod.h"
+#include "DCF77Synth.h"
+#include "DCF77TimeCode.h"
+};
+
+enum { MAX_MINUTES = 8 };
+static DCF77DemodMinute_t minutes[MAX_MINUTES];
+static int qty;
+
+static void
+collect(void *, const DCF77DemodMinute_t * pMinute)
+{
+	if (qty < MAX_MINUTES)
+		minutes[qty++] = *pMinute;
+}
+
+TEST_GROUP(ADemod)
+{
+	enum { RATE = 8000 };
+	DCF77Demod_t demod;
+	DCF77Block_t blocks[3];
+
+	void setup() override {
+		qty = 0;
+		DCF77Block_FromText("0000D2B86A2A5D00", &blocks[0]);
+		DCF77Block_FromText("0000F2A86A2A5D00", &blocks[1]);
+		DCF77Block_FromText("000012A96A2A5D00", &blocks[2]);
+		DCF77Demod_Init(&demod, RATE, collect, NULL);
+	}
+
+	/* baseband envelope, the pulse of 'skip' second left out */
+	void pushMinute(const DCF77Block_t * pBlock, int skip) {
+		static float second[RATE];
+		int seconds = DCF77TimeCode_HasLeapSecond(pBlock) ? 61 : 60;
+
+		for (int s = 0; s < seconds; ++s) {
+			int bit = (s < 60) ? (pBlock->data[s / 8] >> (s % 8)) & 1 : 0;
+			int pulse = (seconds - 1 == s || skip == s) ?
+			    0 : (bit ? RATE / 5 : RATE / 10);
+
+			for (int n = 0; n < RATE; ++n)
+				second[n] = (n < pulse) ? 0.15f : 1.0f;
+			DCF77Demod_Push(&demod, second, RATE);
+		}
+	}
+
+	void synthesize(const char * path) {
+		DCF77SynthParams_t params;
+		DCF77Synth_t synth;
+
+		DCF77Synth_DefaultParams(&params);
+		params.sampleRate = RATE;
+		params.carrierHz = 1000;
+		params.format = DCF77SYNTH_F32;
+		DCF77Synth_Open(&synth, &params, path);
+		for (int i = 0; i < 3; ++i)
+			DCF77Synth_RenderMinute(&synth, &blocks[i]);
+		DCF77Synth_Close(&synth);
+	}
+};
+
+TEST(ADemod, AssemblesBlocksBetweenMinuteMarks) {
+	pushMinute(&blocks[0], -1);
+	pushMinute(&blocks[1], -1);
+	pushMinute(&blocks[2], -1);
+
+	/* first minute has no mark before it */
+	LONGS_EQUAL(1, qty);
+	MEMCMP_EQUAL(&blocks[1], &minutes[0].block, sizeof(DCF77Block_t));
+	CHECK(DCF77DEMOD_ALL_PULSES == minutes[0].present);
+	LONGS_EQUAL(120000, minutes[0].markMs);
+}
+
+TEST(ADemod, EmitsLastMinuteWhenFinished) {
+	pushMinute(&blocks[0], -1);
+	pushMinute(&blocks[1], -1);
+	DCF77Demod_Finish(&demod);
+
+	LONGS_EQUAL(1, qty);
+	MEMCMP_EQUAL(&blocks[1], &minutes[0].block, sizeof(DCF77Block_t));
+	LONGS_EQUAL(120000, minutes[0].markMs);
+}
+
+TEST(ADemod, LeavesHoleForLostPulse) {
+	pushMinute(&blocks[0], -1);
+	pushMinute(&blocks[1], 30);
+	pushMinute(&blocks[2], -1);
+
+	LONGS_EQUAL(1, qty);
+	CHECK((DCF77DEMOD_ALL_PULSES & ~(UINT64_C(1) << 30)) ==
+	    minutes[0].present);
+}
+
+TEST(ADemod, DoesNotTakeLostPulseAfterMarkForMark) {
+	pushMinute(&blocks[0], -1);
+	pushMinute(&blocks[1], 1);
+	pushMinute(&blocks[2], -1);
+
+	LONGS_EQUAL(1, qty);
+	LONGS_EQUAL(120000, minutes[0].markMs);
+}
+
+TEST(ADemod, TakesLeapSecondMinuteWhole) {
+	/* Sun Jan  1 00:59 to 01:01 2017 CET, the leap second announced */
+	DCF77Block_FromText("00003C0B103C5C04", &blocks[0]);
+	DCF77Block_FromText("00001C20183C5C04", &blocks[1]);
+	DCF77Block_FromText("00003430183C5C04", &blocks[2]);
+	pushMinute(&blocks[0], -1);
+	pushMinute(&blocks[1], -1);
+	pushMinute(&blocks[2], -1);
+
+	LONGS_EQUAL(1, qty);
+	MEMCMP_EQUAL(&blocks[1], &minutes[0].block, sizeof(DCF77Block_t));
+	CHECK(DCF77DEMOD_ALL_PULSES == minutes[0].present);
+	CHECK(minutes[0].hasLeapSecond);
+}
+
+TEST(ADemod, DecodesSynthesizedWAV) {
+	char path[32];
+	DCF77DemodInput_t input;
+	FILE * f;
+
+	strcpy(path, "/tmp/demodXXXXXX");
+	close(mkstemp(path));
+	synthesize(path);
+
+	f = fopen(path, "rb");
+	DCF77Demod_ReadWAVHeader(f, path, &input);
+	LONGS_EQUAL(RATE, input.sampleRate);
+	LONGS_EQUAL(1, input.channels);
+	LONGS_EQUAL(DCF77SYNTH_F32, input.format);
+
+	DCF77Demod_ProcessStream(&demod, f, path, &input);
+	fclose(f);
+	unlink(path);
+
+	LONGS_EQUAL(2, qty);
+	MEMCMP_EQUAL(&blocks[1], &minutes[0].block, sizeof(DCF77Block_t));
+	MEMCMP_EQUAL(&blocks[2], &minutes[1].block, sizeof(DCF77Block_t));
+}
+
+TEST(ADemod, ReadsWAVFromPipe) {
+	char path[32], cmd[48];
+	DCF77DemodInput_t input;
+	FILE * f;
+
+	strcpy(path, "/tmp/demodXXXXXX");
+	close(mkstemp(path));
+	synthesize(path);
+
+	/* cannot seek in a pipe, chunks have to be read past */
+	snprintf(cmd, sizeof(cmd), "cat %s", path);
+	f = popen(cmd, "r");
+	DCF77Demod_ReadWAVHeader(f, path, &input);
+	LONGS_EQUAL(RATE, input.sampleRate);
+	LONGS_EQUAL(DCF77SYNTH_F32, input.format);
+
+	DCF77Demod_ProcessStream(&demod, f, path, &input);
+	pclose(f);
+	unlink(path);
+
+	LONGS_EQUAL(2, qty);
+	MEMCMP_EQUAL(&blocks[1], &minutes[0].block, sizeof(DCF77Block_t));
+	MEMCMP_EQUAL(&blocks[2], &minutes[1].block, sizeof(DCF77Block_t));
+}
@@ -0,0 +1,112 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <time.h>
+extern "C"
+{
+#include "DCF77Format.h"
+};
+
+static const char * const nativeFormats[] = {
+	"%c (%Z)",
+	"%FT%T%z",
+	"%a %A %b %B %h %e %k %l %I %p %r",
+	"%D %R %x %X %y %C %w %u %j %n%t%%",
+	"no conversions",
+	"%Y%m%d%H%M%S"
+};
+
+static const char * const strftimeFormats[] = {
+	"%V %G",	/* week based */
+	"%-d.%m",	/* flags */
+	"%10Y",		/* widths */
+	"%Ey %OH",	/* modifiers */
+	"%s",
+	"trailing %"
+};
+
+TEST_GROUP(AFormat)
+{
+	DCF77Format_t format;
+	char expected[128];
+	char actual[128];
+
+	void checkLikeStrftime(const char * fmt) {
+		struct tm stm;
+		time_t t;
+		size_t len;
+
+		/* each hour and weekday, both sides of a DST change */
+		for (t = 1509148800; t < 1509148800 + 8 * 86400; t += 3599) {
+			(void)localtime_r(&t, &stm);
+			memset(expected, 0, sizeof(expected));
+			memset(actual, 0, sizeof(actual));
+
+			len = strftime(expected, sizeof(expected), fmt, &stm);
+			LONGS_EQUAL(len, DCF77Format_Render(&format, &stm,
+			    actual, sizeof(actual)));
+			STRCMP_EQUAL(expected, actual);
+		}
+	}
+};
+
+TEST(AFormat, RendersCLocaleConversionsNatively)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(nativeFormats) / sizeof(nativeFormats[0]);
+	    ++i) {
+		DCF77Format_Compile(&format, nativeFormats[i]);
+		CHECK_TRUE(format.isNative);
+		checkLikeStrftime(nativeFormats[i]);
+	}
+}
+
+TEST(AFormat, LeavesOtherFormatsToStrftime)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(strftimeFormats) / sizeof(strftimeFormats[0]);
+	    ++i) {
+		DCF77Format_Compile(&format, strftimeFormats[i]);
+		CHECK_FALSE(format.isNative);
+		checkLikeStrftime(strftimeFormats[i]);
+	}
+}
+
+TEST(AFormat, RendersNothingIntoShortBuffer)
+{
+	struct tm stm;
+	time_t t = 1506433560;
+
+	(void)localtime_r(&t, &stm);
+	DCF77Format_Compile(&format, "%F %T");
+
+	LONGS_EQUAL(0, DCF77Format_Render(&format, &stm, actual, 19));
+	LONGS_EQUAL(19, DCF77Format_Render(&format, &stm, actual, 20));
+	STRCMP_EQUAL("2017-09-26 15:46:00", actual);
+}
+
+TEST(AFormat, RendersNothingForEmptyFormat)
+{
+	struct tm stm;
+	time_t t = 1506433560;
+
+	(void)localtime_r(&t, &stm);
+	DCF77Format_Compile(&format, "");
+
+	LONGS_EQUAL(0, DCF77Format_Render(&format, &stm, actual,
+	    sizeof(actual)));
+}
+
+TEST(AFormat, LeavesTooLongFormatToStrftime)
+{
+	char fmt[3 * DCF77FORMAT_OPS_MAX + 1];
+	int i;
+
+	for (i = 0; i < DCF77FORMAT_OPS_MAX; ++i) {
+		strcpy(&fmt[3 * i], "%H-");
+	}
+	DCF77Format_Compile(&format, fmt);
+
+	CHECK_FALSE(format.isNative);
+}
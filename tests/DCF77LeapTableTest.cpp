@@ -0,0 +1,184 @@
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77LeapTable.h"
+#include "DCF77TimeCode.h"
+#include "DCF77TimeCodePrivate.h"
+};
+
+/* the last lines of leap-seconds.list, as of 2017 */
+static const char leapList[] =
+	"#\tUpdated through IERS Bulletin C\n"
+	"#$\t 3676924800\n"
+	"#@\t3912710400\n"
+	"#\n"
+	"3550089600\t35\t# 1 Jul 2012\n"
+	"3644697600\t36\t# 1 Jul 2015\n"
+	"3692217600\t37\t# 1 Jan 2017\n"
+	"#h\t16edd0f0 3666784f 37db6bdd e74ced87 59af48f1\n";
+
+static const time_t LEAP_2015 = 1435708800;	/* 2015-07-01 00:00 UTC */
+static const time_t LEAP_2017 = 1483228800;	/* 2017-01-01 00:00 UTC */
+
+struct LeapTableTestsBase : public Utest
+{
+	char path[32];
+	DCF77LeapTable_t table;
+
+	void setup() override {
+		FILE * f;
+
+		strcpy(path, "/tmp/leapXXXXXX");
+		f = fdopen(mkstemp(path), "w");
+		fputs(leapList, f);
+		fclose(f);
+
+		DCF77LeapTable_Load(&table, path);
+	}
+
+	void teardown() override {
+		unlink(path);
+	}
+};
+
+
+/* ====================================================================== */
+TEST_GROUP_BASE(ALeapTable, LeapTableTestsBase)
+{
+};
+
+TEST(ALeapTable, KeepsLeapsButNotFirstOffset) {
+	LONGS_EQUAL(2, table.qty);
+	CHECK(LEAP_2015 == table.leaps[0].at);
+	LONGS_EQUAL(36, table.leaps[0].taiOffset);
+	CHECK(LEAP_2017 == table.leaps[1].at);
+	LONGS_EQUAL(37, table.leaps[1].taiOffset);
+}
+
+TEST(ALeapTable, ReadsExpiry) {
+	CHECK((time_t)1703721600 == table.expires);	/* 2023-12-28 */
+}
+
+TEST(ALeapTable, FindsNextLeap) {
+	POINTERS_EQUAL(&table.leaps[0], DCF77LeapTable_NextLeap(&table, 0));
+	POINTERS_EQUAL(&table.leaps[0],
+	    DCF77LeapTable_NextLeap(&table, LEAP_2015));
+	POINTERS_EQUAL(&table.leaps[1],
+	    DCF77LeapTable_NextLeap(&table, LEAP_2015 + 1));
+	POINTERS_EQUAL(NULL, DCF77LeapTable_NextLeap(&table, LEAP_2017 + 1));
+	POINTERS_EQUAL(NULL, DCF77LeapTable_NextLeap(NULL, 0));
+}
+
+TEST(ALeapTable, AnnouncesDuringHourBefore) {
+	CHECK_FALSE(DCF77LeapTable_Announced(&table, LEAP_2017 - 3600));
+	CHECK_TRUE(DCF77LeapTable_Announced(&table, LEAP_2017 - 3540));
+	CHECK_TRUE(DCF77LeapTable_Announced(&table, LEAP_2017));
+	CHECK_FALSE(DCF77LeapTable_Announced(&table, LEAP_2017 + 60));
+}
+
+
+/* ====================================================================== */
+TEST_GROUP_BASE(ALeapSecondTimeCode, LeapTableTestsBase)
+{
+	DCF77Block_t block;
+
+	void setup() override {
+		LeapTableTestsBase::setup();
+		DCF77TimeCode_UseLeapTable(&table);
+	}
+
+	void teardown() override {
+		DCF77TimeCode_UseLeapTable(NULL);
+		LeapTableTestsBase::teardown();
+	}
+
+	void encode(time_t t, DCF77Block_t * pBlock) {
+		struct tm stm;
+
+		(void)localtime_r(&t, &stm);
+		DCF77TimeCode_ConvertFromStructTM(pBlock, &stm);
+	}
+
+	unsigned a2(const DCF77Block_t * pBlock) {
+		return DCF77TC_GET(DCF77TimeCode_LoadWord(pBlock), A2);
+	}
+};
+
+TEST(ALeapSecondTimeCode, SetsA2InHourBeforeLeap) {
+	encode(LEAP_2017 - 3600, &block);
+	LONGS_EQUAL(0, a2(&block));
+	encode(LEAP_2017 - 3540, &block);
+	LONGS_EQUAL(1, a2(&block));
+	encode(LEAP_2017, &block);
+	LONGS_EQUAL(1, a2(&block));
+	encode(LEAP_2017 + 60, &block);
+	LONGS_EQUAL(0, a2(&block));
+}
+
+TEST(ALeapSecondTimeCode, TellsMinuteWithLeapSecond) {
+	encode(LEAP_2017 - 60, &block);
+	CHECK_FALSE(DCF77TimeCode_HasLeapSecond(&block));
+	encode(LEAP_2017, &block);
+	CHECK_TRUE(DCF77TimeCode_HasLeapSecond(&block));
+}
+
+TEST(ALeapSecondTimeCode, AdvancesLikeConversion) {
+	DCF77Block_t expected;
+	time_t t;
+
+	encode(LEAP_2017 - 7200, &block);
+	for (t = LEAP_2017 - 7140; t <= LEAP_2017 + 3600; t += 60) {
+		DCF77TimeCode_AdvanceByMinute(&block);
+		encode(t, &expected);
+		MEMCMP_EQUAL(expected.data, block.data, DCF77BLOCK_SIZE);
+	}
+}
+
+TEST(ALeapSecondTimeCode, AdvancesLikeConversionWithDSTTable) {
+	DCF77DSTTable_t dstTable;
+	DCF77Block_t expected;
+	time_t t;
+
+	DCF77DSTTable_Build(&dstTable, 2016, 2017);
+	DCF77TimeCode_UseDSTTable(&dstTable);
+
+	encode(LEAP_2017 - 7200, &block);
+	for (t = LEAP_2017 - 7140; t <= LEAP_2017 + 3600; t += 60) {
+		DCF77TimeCode_AdvanceByMinute(&block);
+		encode(t, &expected);
+		MEMCMP_EQUAL(expected.data, block.data, DCF77BLOCK_SIZE);
+	}
+
+	DCF77TimeCode_UseDSTTable(NULL);
+}
+
+TEST(ALeapSecondTimeCode, FlagsLeapSecondInFields) {
+	DCF77Fields_t fields;
+	DCF77FieldSplit_t split;
+
+	encode(LEAP_2017, &block);
+	DCF77TimeCode_DecodeFields(&block, &fields);
+	LONGS_EQUAL(DCF77FIELDS_LEAP_ANNOUNCED | DCF77FIELDS_LEAP_SECOND,
+	    fields.flags);
+
+	DCF77TimeCode_SplitInFieldsR(&block, &split, 0);
+	STRCMP_EQUAL("Leap second: 0 here, no AM in second 60",
+	    split.views[DCF77FIELDSPLIT_ROWS_QTY - 1].nameDescr);
+
+	encode(LEAP_2017 - 60, &block);
+	DCF77TimeCode_SplitInFieldsR(&block, &split, 0);
+	STRCMP_EQUAL("Minute Mark (no AM)",
+	    split.views[DCF77FIELDSPLIT_ROWS_QTY - 1].nameDescr);
+}
+
+TEST(ALeapSecondTimeCode, LeavesA2ClearWithoutTable) {
+	DCF77TimeCode_UseLeapTable(NULL);
+	encode(LEAP_2017, &block);
+
+	LONGS_EQUAL(0, a2(&block));
+}
@@ -0,0 +1,226 @@
+#include "CppUTest/TestHarness.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+extern "C"
+{
+#include "DCF77PM.h"
+#include "DCF77PMRx.h"
+};
+
+enum {
+	RATE = 8000,
+	OVERSAMPLING = 16,
+	MAX_SECONDS = 64
+};
+
+static const double DEVIATION = 15.6 * M_PI / 180.0;
+
+static DCF77PMRxSecond_t seconds[MAX_SECONDS];
+static unsigned qty;
+
+static void
+collectSecond(void * ctx, const DCF77PMRxSecond_t * pSecond)
+{
+	(void)ctx;
+	if (qty < MAX_SECONDS) {
+		seconds[qty++] = *pSecond;
+	}
+}
+
+TEST_GROUP(APMReceiver)
+{
+	DCF77PMRx_t rx;
+	uint64_t chips[2][DCF77PM_CHIP_WORDS];
+	unsigned seed;
+
+	void setup() {
+		qty = 0;
+		seed = 12345u;
+		DCF77PM_SecondChips(0, chips[0]);
+		DCF77PM_SecondChips(1, chips[1]);
+		DCF77PMRx_Init(&rx, RATE, collectSecond, NULL);
+	}
+
+	void teardown() {
+		DCF77PMRx_Free(&rx);
+	}
+
+	/* bit of second N is bit N % 7 of 0x4B */
+	static unsigned bitOf(long second) {
+		return (0x4Bu >> (second % 7)) & 1u;
+	}
+
+	/* -1 .. +1 */
+	float noise() {
+		seed = seed * 1103515245u + 12345u;
+		return (float)((seed >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+	}
+
+	/* baseband at t seconds into a stream whose seconds start at 'at' */
+	double baseband(double t, double at) {
+		double inSecond = t - at;
+		long second = (long)floor(inSecond);
+		double cycles = (inSecond - (double)second) *
+		    DCF77PM_CARRIER_HZ - DCF77PM_CARRIER_HZ *
+		    DCF77PM_START_MS / 1000.0;
+		long chip = (long)floor(cycles / DCF77PM_CYCLES_PER_CHIP);
+		unsigned bit;
+
+		if (second < 0 || cycles < 0.0 || chip >= DCF77PM_CHIPS_QTY)
+			return 0.0;
+
+		bit = bitOf(second);
+		return ((chips[bit][chip / 64] >> (chip % 64)) & 1u) ?
+		    -1.0 : 1.0;
+	}
+
+	/*
+	 * Phase averaged around each sample, as a band-limited front end
+	 * gives it, rather than at its instant.
+	 */
+	void render(float * phase, size_t samples, double at,
+	    float noiseLevel) {
+		size_t n;
+		unsigned k;
+
+		for (n = 0; n < samples; ++n) {
+			double sum = 0.0;
+
+			for (k = 0; k < OVERSAMPLING; ++k) {
+				sum += baseband(((double)n + (k + 0.5) /
+				    OVERSAMPLING - 0.5) / RATE, at);
+			}
+			phase[n] = (float)(0.7 + DEVIATION * sum /
+			    OVERSAMPLING) + noiseLevel * noise();
+		}
+	}
+};
+
+TEST(APMReceiver, DecodesBitsAndTimesSecondsWithinSample)
+{
+	size_t samples = 20 * RATE;
+	float * phase = (float *)malloc(samples * sizeof(float));
+	double at = 0.3141;	/* s; 15 us is 0.12 samples */
+	unsigned i;
+
+	render(phase, samples, at, 0.5f);
+	DCF77PMRx_Push(&rx, phase, samples);
+
+	CHECK(qty >= 15);
+	for (i = 0; i < qty; ++i) {
+		double second = seconds[i].start / RATE - at;
+		long index = lround(second);
+
+		CHECK(seconds[i].isPresent);
+		DOUBLES_EQUAL(0.0, (second - index) * RATE, 0.25);
+		LONGS_EQUAL(bitOf(index), seconds[i].bit);
+	}
+
+	free(phase);
+}
+
+TEST(APMReceiver, TakesSamplesInPieces)
+{
+	size_t samples = 10 * RATE;
+	float * phase = (float *)malloc(samples * sizeof(float));
+	size_t n;
+	unsigned i;
+
+	/* chips of the first second tracked are due before the signal */
+	render(phase, samples, 0.9, 0.0f);
+	for (n = 0; n < samples; n += 999) {
+		DCF77PMRx_Push(&rx, &phase[n],
+		    (samples - n < 999) ? samples - n : 999);
+	}
+
+	CHECK(qty >= 5);
+	CHECK_FALSE(seconds[0].isPresent);
+	for (i = 1; i < qty; ++i) {
+		long index = lround(seconds[i].start / RATE - 0.9);
+
+		CHECK(seconds[i].isPresent);
+		LONGS_EQUAL(bitOf(index), seconds[i].bit);
+	}
+
+	free(phase);
+}
+
+TEST(APMReceiver, TakesPhaseOfIQPairs)
+{
+	size_t samples = 10 * RATE;
+	float * phase = (float *)malloc(samples * sizeof(float));
+	float * iq = (float *)malloc(2 * samples * sizeof(float));
+	size_t n;
+	unsigned i;
+
+	/* around pi, where the phase wraps */
+	render(phase, samples, 0.5, 0.0f);
+	for (n = 0; n < samples; ++n) {
+		iq[2 * n] = 0.3f * cosf(phase[n] + 2.5f);
+		iq[2 * n + 1] = 0.3f * sinf(phase[n] + 2.5f);
+	}
+	DCF77PMRx_PushIQ(&rx, iq, samples);
+
+	CHECK(qty >= 5);
+	for (i = 0; i < qty; ++i) {
+		long index = lround(seconds[i].start / RATE - 0.5);
+
+		CHECK(seconds[i].isPresent);
+		LONGS_EQUAL(bitOf(index), seconds[i].bit);
+	}
+
+	free(phase);
+	free(iq);
+}
+
+TEST(APMReceiver, FindsNoSecondsInNoise)
+{
+	size_t samples = 10 * RATE;
+	float * phase = (float *)malloc(samples * sizeof(float));
+	size_t n;
+	unsigned i;
+
+	for (n = 0; n < samples; ++n) {
+		phase[n] = noise();
+	}
+	DCF77PMRx_Push(&rx, phase, samples);
+
+	CHECK(qty > 0);
+	for (i = 0; i < qty; ++i) {
+		CHECK_FALSE(seconds[i].isPresent);
+	}
+
+	free(phase);
+}
+
+TEST(APMReceiver, SearchesAgainAfterSignalIsLost)
+{
+	size_t part = 20 * RATE;
+	float * phase = (float *)malloc(2 * part * sizeof(float));
+	unsigned i, lost = 0, found = 0;
+
+	render(phase, part, 0.25, 0.0f);
+	/* the second part has its seconds shifted by 0.5 s */
+	render(&phase[part], part, 0.75, 0.0f);
+	for (i = 0; i < RATE * 12; ++i) {
+		phase[part + i] = noise();
+	}
+	DCF77PMRx_Push(&rx, phase, 2 * part);
+
+	for (i = 0; i < qty; ++i) {
+		double second = seconds[i].start / RATE;
+
+		if (!seconds[i].isPresent) {
+			++lost;
+		} else if (second > 32.0) {
+			DOUBLES_EQUAL(0.0, (second - 0.75) - lround(second -
+			    0.75), 0.001);
+			++found;
+		}
+	}
+	CHECK(lost >= 8);
+	CHECK(found >= 3);
+
+	free(phase);
+}
@@ -0,0 +1,111 @@
+#include "CppUTest/TestHarness.h"
+#include <stdlib.h>
+#include <string.h>
+extern "C"
+{
+#include "DCF77PM.h"
+};
+
+TEST_GROUP(APhaseModulation)
+{
+	uint64_t chips[DCF77PM_CHIP_WORDS];
+
+	unsigned chipOf(unsigned k) {
+		return (chips[k / 64] >> (k % 64)) & 1u;
+	}
+};
+
+TEST(APhaseModulation, SendsShiftRegisterSequence)
+{
+	unsigned stages = 0x1FF;	/* stage 1 is bit 0 */
+	unsigned k;
+
+	DCF77PM_SecondChips(0, chips);
+
+	for (k = 0; k < DCF77PM_CHIPS_QTY - 1; ++k) {
+		unsigned out = (stages >> 8) & 1u;
+		unsigned feedback = out ^ ((stages >> 4) & 1u);
+
+		LONGS_EQUAL(out, chipOf(k));
+		stages = ((stages << 1) | feedback) & 0x1FF;
+	}
+	LONGS_EQUAL(0, chipOf(DCF77PM_CHIPS_QTY - 1));
+}
+
+TEST(APhaseModulation, HasBalancedSequence)
+{
+	unsigned k, ones = 0;
+
+	DCF77PM_SecondChips(0, chips);
+	for (k = 0; k < DCF77PM_CHIPS_QTY; ++k) {
+		ones += chipOf(k);
+	}
+
+	LONGS_EQUAL(DCF77PM_CHIPS_QTY / 2, ones);
+}
+
+TEST(APhaseModulation, InvertsSequenceForOne)
+{
+	uint64_t inverted[DCF77PM_CHIP_WORDS];
+	int i;
+
+	DCF77PM_SecondChips(0, chips);
+	DCF77PM_SecondChips(1, inverted);
+
+	for (i = 0; i < DCF77PM_CHIP_WORDS; ++i) {
+		CHECK(~chips[i] == inverted[i]);
+	}
+}
+
+TEST(APhaseModulation, TakesBitsOfBlockAndZeroInSecond59)
+{
+	uint64_t minute[60][DCF77PM_CHIP_WORDS];
+	DCF77Block_t block;
+	unsigned second;
+
+	DCF77Block_FromText("FFFFFFFFFFFFFFFF", &block);
+	DCF77PM_MinuteChips(&block, minute);
+
+	for (second = 0; second < 59; ++second) {
+		LONGS_EQUAL(1, DCF77PM_BitOfSecond(&block, second));
+		DCF77PM_SecondChips(1, chips);
+		MEMCMP_EQUAL(chips, minute[second], sizeof(chips));
+	}
+	LONGS_EQUAL(0, DCF77PM_BitOfSecond(&block, 59));
+	DCF77PM_SecondChips(0, chips);
+	MEMCMP_EQUAL(chips, minute[59], sizeof(chips));
+}
+
+TEST(APhaseModulation, PlacesChipsFrom200ms)
+{
+	/* 512 chips of 120 cycles at 77.5 kHz end 992.77 ms in */
+	LONGS_EQUAL(-1, DCF77PM_ChipAt(9599, 48000));
+	LONGS_EQUAL(0, DCF77PM_ChipAt(9600, 48000));
+	LONGS_EQUAL(0, DCF77PM_ChipAt(9674, 48000));
+	LONGS_EQUAL(1, DCF77PM_ChipAt(9675, 48000));
+	LONGS_EQUAL(511, DCF77PM_ChipAt(47653, 48000));
+	LONGS_EQUAL(-1, DCF77PM_ChipAt(47654, 48000));
+}
+
+TEST(APhaseModulation, RendersBaseband)
+{
+	enum { RATE = 48000 };
+	float * samples = (float *)malloc(RATE * sizeof(float));
+	unsigned n;
+
+	DCF77PM_RenderBaseband(1, RATE, samples);
+	DCF77PM_SecondChips(1, chips);
+
+	for (n = 0; n < RATE; ++n) {
+		int chip = DCF77PM_ChipAt(n, RATE);
+
+		if (chip < 0) {
+			CHECK(0.0f == samples[n]);
+		} else {
+			CHECK((chipOf((unsigned)chip) ? -1.0f : 1.0f) ==
+			    samples[n]);
+		}
+	}
+
+	free(samples);
+}
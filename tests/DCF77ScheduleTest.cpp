@@ -0,0 +1,108 @@
+#include "CppUTest/TestHarness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77Schedule.h"
+#include "DCF77TimeCode.h"
+};
+
+/* 2017-10-28 22:00 UTC: the day CEST ends, two 02:xx hours */
+static const time_t FIRST_MINUTE = 1509228000;
+
+TEST_GROUP(ASchedule)
+{
+	enum { QTY = 6 * 60 };
+	DCF77Schedule_t schedule;
+
+	void setup() override {
+		DCF77Schedule_Build(&schedule, FIRST_MINUTE + 31, QTY);
+	}
+
+	void teardown() override {
+		DCF77Schedule_Free(&schedule);
+	}
+
+	void checkLookups(const DCF77Schedule_t * pSchedule) {
+		const DCF77Block_t * pBlock;
+		DCF77Block_t expected;
+		struct tm stm;
+		time_t t, found;
+
+		for (t = FIRST_MINUTE; t < FIRST_MINUTE + 60 * QTY; t += 60) {
+			(void)localtime_r(&t, &stm);
+			DCF77TimeCode_ConvertFromStructTM(&expected, &stm);
+
+			pBlock = DCF77Schedule_BlockAt(pSchedule, t + 59);
+			CHECK(NULL != pBlock);
+			MEMCMP_EQUAL(&expected, pBlock, sizeof(expected));
+
+			CHECK_TRUE(DCF77Schedule_TimeOf(pSchedule, &expected,
+			    &found));
+			LONGS_EQUAL(t, found);
+		}
+	}
+};
+
+TEST(ASchedule, StartsAtTheMinute)
+{
+	LONGS_EQUAL(FIRST_MINUTE, schedule.firstMinute);
+	LONGS_EQUAL(QTY, schedule.qty);
+}
+
+TEST(ASchedule, LooksUpBothWays)
+{
+	checkLookups(&schedule);
+}
+
+TEST(ASchedule, HasNoBlocksOutsideOfRange)
+{
+	POINTERS_EQUAL(NULL, DCF77Schedule_BlockAt(&schedule,
+	    FIRST_MINUTE - 1));
+	POINTERS_EQUAL(NULL, DCF77Schedule_BlockAt(&schedule,
+	    FIRST_MINUTE + 60 * QTY));
+}
+
+TEST(ASchedule, DoesNotFindUnknownBlock)
+{
+	DCF77Block_t block = *DCF77Schedule_BlockAt(&schedule, FIRST_MINUTE);
+	time_t found = 0;
+
+	block.data[5] ^= 0x40;	/* month */
+
+	CHECK_FALSE(DCF77Schedule_TimeOf(&schedule, &block, &found));
+	LONGS_EQUAL(0, found);
+}
+
+TEST(ASchedule, IgnoresWeatherBits)
+{
+	DCF77Block_t block = *DCF77Schedule_BlockAt(&schedule,
+	    FIRST_MINUTE + 600);
+	time_t found;
+
+	block.data[0] |= 0xFE;
+	block.data[1] |= 0xFF;
+
+	CHECK_TRUE(DCF77Schedule_TimeOf(&schedule, &block, &found));
+	LONGS_EQUAL(FIRST_MINUTE + 600, found);
+}
+
+TEST(ASchedule, PersistsAsBlockFile)
+{
+	char path[32];
+	DCF77Schedule_t reopened;
+
+	strcpy(path, "/tmp/scheduleXXXXXX");
+	close(mkstemp(path));
+
+	DCF77Schedule_Save(&schedule, path);
+	DCF77Schedule_Open(&reopened, path);
+
+	LONGS_EQUAL(FIRST_MINUTE, reopened.firstMinute);
+	LONGS_EQUAL(QTY, reopened.qty);
+	checkLookups(&reopened);
+
+	DCF77Schedule_Free(&reopened);
+	unlink(path);
+}
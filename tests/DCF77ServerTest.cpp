@@ -0,0 +1,181 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <time.h>
+extern "C"
+{
+#include "DCF77Server.h"
+#include "DCF77TimeCode.h"
+};
+
+/* 2017-10-29 00:00 UTC, an hour before the switch back from CEST */
+static const time_t FIRST_MINUTE = 1509235200;
+
+static void
+expectedBlockAt(time_t minute, DCF77Block_t * pBlock)
+{
+	struct tm stm;
+
+	localtime_r(&minute, &stm);
+	DCF77TimeCode_ConvertFromStructTM(pBlock, &stm);
+}
+
+static void
+putRequest(uint8_t * request, unsigned op, uint32_t count, int64_t t)
+{
+	int i;
+
+	memset(request, 0, DCF77SERVER_REQUEST_SZ);
+	request[0] = (uint8_t)op;
+	for (i = 0; i < 4; ++i) {
+		request[4 + i] = (uint8_t)(count >> (8 * i));
+	}
+	for (i = 0; i < 8; ++i) {
+		request[8 + i] = (uint8_t)((uint64_t)t >> (8 * i));
+	}
+}
+
+TEST_GROUP(ABlockRing)
+{
+	enum { QTY = 180 };
+	DCF77BlockRing_t ring;
+
+	void setup() override {
+		DCF77Server_RingInit(&ring, FIRST_MINUTE + 17, QTY);
+	}
+
+	void teardown() override {
+		DCF77Server_RingFree(&ring);
+	}
+
+	void checkRingFrom(time_t first) {
+		DCF77Block_t actual, expected;
+		time_t t;
+
+		LONGS_EQUAL(first, ring.firstMinute);
+		for (t = first; t < first + 60 * QTY + 120; t += 60) {
+			DCF77Server_BlockAt(&ring, t, &actual);
+			expectedBlockAt(t, &expected);
+			MEMCMP_EQUAL(&expected, &actual, sizeof(expected));
+		}
+	}
+};
+
+TEST(ABlockRing, StartsAtTheMinute)
+{
+	checkRingFrom(FIRST_MINUTE);
+}
+
+TEST(ABlockRing, SlidesForward)
+{
+	DCF77Server_RingSlide(&ring, FIRST_MINUTE + 30 * 60);
+	checkRingFrom(FIRST_MINUTE + 30 * 60);
+	DCF77Server_RingSlide(&ring, FIRST_MINUTE + 100 * 60 + 59);
+	checkRingFrom(FIRST_MINUTE + 100 * 60);
+}
+
+TEST(ABlockRing, RebuildsOnJumps)
+{
+	DCF77Server_RingSlide(&ring, FIRST_MINUTE - 60);
+	checkRingFrom(FIRST_MINUTE - 60);
+	DCF77Server_RingSlide(&ring, FIRST_MINUTE + 86400);
+	checkRingFrom(FIRST_MINUTE + 86400);
+}
+
+TEST_GROUP(AServer)
+{
+	enum { RESPONSE_SZ = DCF77SERVER_HEADER_SZ +
+	    DCF77SERVER_MAX_COUNT * DCF77BLOCK_SIZE };
+	DCF77BlockRing_t ring;
+	uint8_t request[DCF77SERVER_REQUEST_SZ];
+	uint8_t response[RESPONSE_SZ];
+
+	void setup() override {
+		DCF77Server_RingInit(&ring, FIRST_MINUTE, 10);
+	}
+
+	void teardown() override {
+		DCF77Server_RingFree(&ring);
+	}
+
+	size_t answer() {
+		return DCF77Server_Answer(&ring, request, response,
+		    sizeof(response));
+	}
+
+	void checkHeader(unsigned status, unsigned op, uint32_t count,
+	    int64_t first) {
+		uint8_t expected[DCF77SERVER_HEADER_SZ];
+
+		putRequest(expected, op, count, first);
+		expected[0] = (uint8_t)status;
+		expected[1] = (uint8_t)op;
+		MEMCMP_EQUAL(expected, response, sizeof(expected));
+	}
+
+	void checkBlocks(uint32_t count, time_t first) {
+		DCF77Block_t expected;
+		uint32_t i;
+
+		for (i = 0; i < count; ++i) {
+			expectedBlockAt(first + 60 * (time_t)i, &expected);
+			MEMCMP_EQUAL(&expected, &response[
+			    DCF77SERVER_HEADER_SZ + i * DCF77BLOCK_SIZE],
+			    sizeof(expected));
+		}
+	}
+};
+
+TEST(AServer, AnswersNextWithUpcomingBlocks)
+{
+	putRequest(request, DCF77SERVER_OP_NEXT, 3, 0);
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ + 3 * DCF77BLOCK_SIZE, answer());
+	checkHeader(DCF77SERVER_STATUS_OK, DCF77SERVER_OP_NEXT, 3,
+	    FIRST_MINUTE);
+	checkBlocks(3, FIRST_MINUTE);
+}
+
+TEST(AServer, AnswersBlockAtBeyondTheRing)
+{
+	time_t t = FIRST_MINUTE + 86400 * 100 + 42;
+
+	putRequest(request, DCF77SERVER_OP_BLOCK_AT, 20, t);
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ + 20 * DCF77BLOCK_SIZE, answer());
+	checkHeader(DCF77SERVER_STATUS_OK, DCF77SERVER_OP_BLOCK_AT, 20,
+	    t - 42);
+	checkBlocks(20, t - 42);
+}
+
+TEST(AServer, AnswersSubscribeWithOneBlock)
+{
+	putRequest(request, DCF77SERVER_OP_SUBSCRIBE, 0, 0);
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ + DCF77BLOCK_SIZE, answer());
+	checkHeader(DCF77SERVER_STATUS_OK, DCF77SERVER_OP_SUBSCRIBE, 1,
+	    FIRST_MINUTE);
+	checkBlocks(1, FIRST_MINUTE);
+}
+
+TEST(AServer, RejectsUnknownOp)
+{
+	putRequest(request, DCF77SERVER_OP_PUSH, 1, 0);
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ, answer());
+	checkHeader(DCF77SERVER_STATUS_BAD_REQUEST, DCF77SERVER_OP_PUSH, 0,
+	    0);
+}
+
+TEST(AServer, RejectsTooManyBlocks)
+{
+	putRequest(request, DCF77SERVER_OP_NEXT,
+	    DCF77SERVER_MAX_COUNT + 1, 0);
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ, answer());
+	checkHeader(DCF77SERVER_STATUS_BAD_REQUEST, DCF77SERVER_OP_NEXT, 0,
+	    0);
+}
+
+TEST(AServer, RejectsNonZeroReserved)
+{
+	putRequest(request, DCF77SERVER_OP_NEXT, 1, 0);
+	request[2] = 1;
+	LONGS_EQUAL(DCF77SERVER_HEADER_SZ, answer());
+	checkHeader(DCF77SERVER_STATUS_BAD_REQUEST, DCF77SERVER_OP_NEXT, 0,
+	    0);
+}
@@ -0,0 +1,122 @@
+#include "CppUTest/TestHarness.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77Shm.h"
+};
+
+static const time_t FIRST_MINUTE = 1506440760;
+
+/* every block of a publication tells the minute it stands for */
+static void
+fillBlocks(DCF77Block_t blocks[DCF77SHM_QTY], time_t first)
+{
+	int i;
+
+	for (i = 0; i < DCF77SHM_QTY; ++i) {
+		int64_t minute = (int64_t)first + 60 * i;
+
+		memcpy(&blocks[i], &minute, sizeof(blocks[i]));
+	}
+}
+
+static int64_t
+minuteOfBlock(const DCF77Block_t * pBlock)
+{
+	int64_t minute;
+
+	memcpy(&minute, pBlock, sizeof(minute));
+
+	return minute;
+}
+
+static volatile int isWriting;
+
+static void *
+publishRepeatedly(void * arg)
+{
+	DCF77Shm_t * pShm = (DCF77Shm_t *)arg;
+	DCF77Block_t blocks[DCF77SHM_QTY];
+	int i = 0;
+
+	while (isWriting) {
+		time_t first = FIRST_MINUTE - 60 * (i++ % 8);
+
+		fillBlocks(blocks, first);
+		DCF77Shm_Publish(pShm, first, blocks);
+	}
+
+	return NULL;
+}
+
+TEST_GROUP(ASharedBlockRing)
+{
+	char name[32];
+	DCF77Shm_t writer;
+	DCF77Shm_t reader;
+	DCF77Block_t blocks[DCF77SHM_QTY];
+	DCF77Block_t block;
+
+	void setup() override {
+		snprintf(name, sizeof(name), "/dcf77test.%ld", (long)getpid());
+		DCF77Shm_Create(&writer, name);
+		DCF77Shm_Attach(&reader, name);
+	}
+
+	void teardown() override {
+		DCF77Shm_Close(&reader);
+		DCF77Shm_Close(&writer);
+	}
+};
+
+TEST(ASharedBlockRing, HoldsNothingBeforeFirstPublication)
+{
+	CHECK_FALSE(DCF77Shm_BlockAt(&reader, FIRST_MINUTE, &block));
+}
+
+TEST(ASharedBlockRing, GivesPublishedBlocks)
+{
+	int i;
+
+	fillBlocks(blocks, FIRST_MINUTE);
+	DCF77Shm_Publish(&writer, FIRST_MINUTE, blocks);
+
+	for (i = 0; i < DCF77SHM_QTY; ++i) {
+		CHECK_TRUE(DCF77Shm_BlockAt(&reader,
+		    FIRST_MINUTE + 60 * i + 59, &block));
+		LONGS_EQUAL(FIRST_MINUTE + 60 * i, minuteOfBlock(&block));
+	}
+}
+
+TEST(ASharedBlockRing, HoldsNoBlocksOutsideOfRing)
+{
+	fillBlocks(blocks, FIRST_MINUTE);
+	DCF77Shm_Publish(&writer, FIRST_MINUTE, blocks);
+
+	CHECK_FALSE(DCF77Shm_BlockAt(&reader, FIRST_MINUTE - 1, &block));
+	CHECK_FALSE(DCF77Shm_BlockAt(&reader,
+	    FIRST_MINUTE + 60 * DCF77SHM_QTY, &block));
+}
+
+TEST(ASharedBlockRing, NeverGivesTornBlocks)
+{
+	pthread_t thread;
+	int i, found = 0;
+
+	isWriting = 1;
+	pthread_create(&thread, NULL, publishRepeatedly, &writer);
+
+	for (i = 0; i < 200000; ++i) {
+		if (DCF77Shm_BlockAt(&reader, FIRST_MINUTE, &block)) {
+			LONGS_EQUAL(FIRST_MINUTE, minuteOfBlock(&block));
+			++found;
+		}
+	}
+
+	isWriting = 0;
+	pthread_join(thread, NULL);
+	CHECK_TRUE(found > 0);
+}
@@ -0,0 +1,146 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+extern "C"
+{
+#include "DCF77Sync.h"
+#include "DCF77TimeCode.h"
+};
+
+/* consecutive minutes, Tue Sep 26 15:46-15:48 2017 */
+static const char * const blockTexts[] = {
+	"0000D2B86A2A5D00", "0000F2A86A2A5D00", "000012A96A2A5D00"
+};
+
+#define FOUND_MAX 16
+static uint64_t foundSeconds[FOUND_MAX];
+static DCF77Block_t foundBlocks[FOUND_MAX];
+static unsigned foundQty;
+
+static void
+collectFrame(void * ctx, uint64_t second, const DCF77Block_t * pBlock)
+{
+	(void)ctx;
+	if (foundQty < FOUND_MAX) {
+		foundSeconds[foundQty] = second;
+		foundBlocks[foundQty] = *pBlock;
+	}
+	++foundQty;
+}
+
+/* appends the 59 pulses of a block, second 0 first */
+static char *
+appendPulses(char * text, const char * textBlock)
+{
+	DCF77Block_t block;
+	size_t len = strlen(text);
+	unsigned k;
+
+	DCF77Block_FromText(textBlock, &block);
+	for (k = 0; k < 59; ++k) {
+		text[len++] = ((block.data[k / 8] >> (k % 8)) & 1) ? '1' : '0';
+	}
+	text[len] = '\0';
+
+	return text;
+}
+
+TEST_GROUP(ASyncScan)
+{
+	DCF77Bits_t bits;
+	char text[512];
+
+	void setup() override {
+		DCF77Sync_InitBits(&bits);
+		foundQty = 0;
+		text[0] = '\0';
+	}
+
+	void teardown() override {
+		DCF77Sync_FreeBits(&bits);
+	}
+
+	uint64_t scan(unsigned flags) {
+		DCF77Sync_AppendText(&bits, text);
+		return DCF77Sync_Scan(&bits, flags, collectFrame, NULL);
+	}
+
+	void checkFound(unsigned i, uint64_t second, const char * textBlock) {
+		DCF77Block_t expected;
+
+		DCF77Block_FromText(textBlock, &expected);
+		LONGS_EQUAL(second, foundSeconds[i]);
+		MEMCMP_EQUAL(&expected, &foundBlocks[i], sizeof(expected));
+	}
+};
+
+TEST(ASyncScan, ReadsCharactersAsBitplanes)
+{
+	DCF77Sync_AppendText(&bits, "01 -x\n1");
+	LONGS_EQUAL(5, bits.qty);
+	LONGS_EQUAL(0x13, bits.present[0]);
+	LONGS_EQUAL(0x12, bits.value[0]);
+}
+
+TEST(ASyncScan, FindsFramesAfterNoise)
+{
+	strcpy(text, "1101-0");
+	strcat(appendPulses(text, blockTexts[0]), "-");
+	strcat(appendPulses(text, blockTexts[1]), "-");
+
+	LONGS_EQUAL(2, scan(DCF77SYNC_NEEDS_MARK));
+	checkFound(0, 6, blockTexts[0]);
+	checkFound(1, 66, blockTexts[1]);
+}
+
+TEST(ASyncScan, FindsFramesAtAnyOffset)
+{
+	char noise[160] = "";
+	unsigned offset;
+
+	for (offset = 0; offset < 130; ++offset) {
+		DCF77Sync_FreeBits(&bits);
+		foundQty = 0;
+
+		strcat(strcpy(text, noise), "-");
+		strcat(appendPulses(text, blockTexts[2]), "-");
+		LONGS_EQUAL(1, scan(DCF77SYNC_NEEDS_MARK));
+		checkFound(0, offset + 1, blockTexts[2]);
+		strcat(noise, (offset % 3) ? "-" : "1");
+	}
+}
+
+TEST(ASyncScan, SkipsFramesWithLostPulse)
+{
+	strcpy(text, "-");
+	strcat(appendPulses(text, blockTexts[0]), "-");
+	strcat(appendPulses(text, blockTexts[1]), "-");
+	text[1 + 60 + 30] = '-';
+
+	LONGS_EQUAL(1, scan(DCF77SYNC_NEEDS_MARK));
+	checkFound(0, 1, blockTexts[0]);
+}
+
+TEST(ASyncScan, SkipsFramesWithBadParity)
+{
+	strcat(appendPulses(text, blockTexts[0]), "-");
+	text[40] = ('0' == text[40]) ? '1' : '0';
+
+	LONGS_EQUAL(0, scan(DCF77SYNC_NEEDS_MARK));
+}
+
+TEST(ASyncScan, NeedsMarkOnlyWhenAsked)
+{
+	strcat(appendPulses(text, blockTexts[0]), "1");
+
+	LONGS_EQUAL(0, scan(DCF77SYNC_NEEDS_MARK));
+	LONGS_EQUAL(1, DCF77Sync_Scan(&bits, 0, collectFrame, NULL));
+	checkFound(0, 0, blockTexts[0]);
+}
+
+TEST(ASyncScan, FindsNothingInShortCapture)
+{
+	appendPulses(text, blockTexts[0]);
+
+	LONGS_EQUAL(0, scan(DCF77SYNC_NEEDS_MARK));
+	LONGS_EQUAL(1, DCF77Sync_Scan(&bits, 0, collectFrame, NULL));
+}
@@ -0,0 +1,153 @@
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+extern "C"
+{
+#include "DCF77Synth.h"
+};
+
+TEST_GROUP(ASynth)
+{
+	enum { RATE = 8000, CARRIER = 1000 };
+	char path[32];
+	DCF77SynthParams_t params;
+	DCF77Synth_t synth;
+	DCF77Block_t block;
+	unsigned char *data;
+	long dataSz;
+
+	void setup() override {
+		strcpy(path, "/tmp/synthXXXXXX");
+		close(mkstemp(path));
+
+		DCF77Synth_DefaultParams(&params);
+		params.sampleRate = RATE;
+		params.carrierHz = CARRIER;
+		/* every other bit set */
+		memset(&block, 0xAA, sizeof(block));
+		data = NULL;
+	}
+
+	void teardown() override {
+		free(data);
+		unlink(path);
+	}
+
+	void render() {
+		FILE *f;
+
+		DCF77Synth_Open(&synth, &params, path);
+		DCF77Synth_RenderMinute(&synth, &block);
+		DCF77Synth_Close(&synth);
+
+		f = fopen(path, "rb");
+		fseek(f, 0L, SEEK_END);
+		dataSz = ftell(f);
+		rewind(f);
+		data = (unsigned char *)malloc(dataSz);
+		fread(data, 1, dataSz, f);
+		fclose(f);
+	}
+
+	long le(long offset, int sz) {
+		long v = 0;
+
+		for (int i = sz - 1; i >= 0; --i)
+			v = (v << 8) | data[offset + i];
+		return v;
+	}
+
+	int peakS16(long first, long qty) {
+		int peak = 0;
+
+		for (long n = first; n < first + qty; ++n) {
+			int s = (short)le(44 + 2 * n, 2);
+			if (abs(s) > peak)
+				peak = abs(s);
+		}
+		return peak;
+	}
+
+	/* length of the reduced carrier at the start of a second, in ms */
+	long pulseMs(int second) {
+		long n, first = (long)second * RATE;
+		int high = peakS16(first + RATE / 2, RATE / 4);
+
+		/* peak over one carrier period must reach full level */
+		for (n = 0; n < RATE; n += RATE / CARRIER) {
+			if (peakS16(first + n, RATE / CARRIER) > high / 2)
+				break;
+		}
+		return n * 1000 / RATE;
+	}
+};
+
+TEST(ASynth, WritesWAVHeaderWithFinalSizes) {
+	render();
+
+	LONGS_EQUAL(44 + 60 * RATE * 2, dataSz);
+	MEMCMP_EQUAL("RIFF", data, 4);
+	LONGS_EQUAL(dataSz - 8, le(4, 4));
+	MEMCMP_EQUAL("WAVEfmt ", data + 8, 8);
+	LONGS_EQUAL(1, le(20, 2));
+	LONGS_EQUAL(1, le(22, 2));
+	LONGS_EQUAL(RATE, le(24, 4));
+	LONGS_EQUAL(16, le(34, 2));
+	MEMCMP_EQUAL("data", data + 36, 4);
+	LONGS_EQUAL(60 * RATE * 2, le(40, 4));
+}
+
+TEST(ASynth, WritesBareSamplesWhenRaw) {
+	params.wav = 0;
+	params.format = DCF77SYNTH_F32;
+	render();
+
+	LONGS_EQUAL(60 * RATE * 4, dataSz);
+}
+
+TEST(ASynth, EncodesBitsAsPulseLengths) {
+	render();
+
+	LONGS_EQUAL(100, pulseMs(0));
+	LONGS_EQUAL(200, pulseMs(1));
+	LONGS_EQUAL(100, pulseMs(56));
+	LONGS_EQUAL(200, pulseMs(57));
+	LONGS_EQUAL(100, pulseMs(58));
+}
+
+TEST(ASynth, LeavesSecond59WithoutPulse) {
+	render();
+
+	LONGS_EQUAL(0, pulseMs(59));
+}
+
+TEST(ASynth, ReducesCarrierByDepth) {
+	render();
+
+	int high = peakS16(RATE / 2, RATE / 4);
+	int low = peakS16(0, RATE / 20);
+
+	DOUBLES_EQUAL(params.level * 32767, high, 2);
+	DOUBLES_EQUAL((1 - params.depth) * high, low, 2);
+}
+
+TEST(ASynth, AddsSecond60InLeapSecondMinute) {
+	/* Sun Jan  1 01:00 2017 CET, A2 set */
+	DCF77Block_FromText("00001C20183C5C04", &block);
+	render();
+
+	LONGS_EQUAL(44 + 61 * RATE * 2, dataSz);
+	LONGS_EQUAL(100, pulseMs(59));
+	LONGS_EQUAL(0, pulseMs(60));
+}
+
+TEST(ASynth, SendsZeroInSecond59EvenWithMinuteMarkBitSet) {
+	DCF77Block_FromText("00001C20183C5C04", &block);
+	block.data[7] |= 0x08u;	/* bit 59 */
+	render();
+
+	LONGS_EQUAL(100, pulseMs(59));
+	LONGS_EQUAL(0, pulseMs(60));
+}
@@ -233,3 +233,501 @@ TEST(AStructTMToTimeCodeConversion, PropagatesDeassertedDST) {
 	LONGS_EQUAL(0, tcc.dcfTc.Z1);
 	LONGS_EQUAL(1, tcc.dcfTc.Z2);
 }
+
+
+/* ====================================================================== */
+TEST_GROUP_BASE(ATimeCodeAdvance, TimeCodeConversionTestsBase)
+{
+	struct tm stm;
+
+	void setup() override {
+		memset((void*)&stm, 0, sizeof(stm));
+	}
+
+	/* a winter timestamp keeps libc DST lookups out of the way */
+	void SET_WINTER_TIMESTAMP(int year, int mon, int day,
+	    int hour, int min) {
+		memset((void*)&stm, 0, sizeof(stm));
+		stm.tm_year = year - 1900;
+		stm.tm_mon  = mon - 1;
+		stm.tm_mday = day;
+		stm.tm_hour = hour;
+		stm.tm_min  = min;
+		stm.tm_isdst = 0;
+		stm.tm_wday = dayOfWeek(year, mon, day);
+		DCF77TimeCode_ConvertFromStructTM(&tcc.block, &stm);
+	}
+
+	int dayOfWeek(int y, int m, int d) {
+		static const int t[] = { 0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4 };
+
+		y -= (m < 3);
+		return (y + y / 4 - y / 100 + y / 400 + t[m - 1] + d) % 7;
+	}
+
+	void CHECK_ADVANCE(int y0, int mo0, int d0, int h0, int mi0,
+	    int y1, int mo1, int d1, int h1, int mi1) {
+		DCF77Block_t advanced;
+
+		SET_WINTER_TIMESTAMP(y0, mo0, d0, h0, mi0);
+		DCF77TimeCode_AdvanceByMinute(&tcc.block);
+		advanced = tcc.block;
+
+		SET_WINTER_TIMESTAMP(y1, mo1, d1, h1, mi1);
+		MEMCMP_EQUAL(tcc.block.data, advanced.data, DCF77BLOCK_SIZE);
+	}
+};
+
+TEST(ATimeCodeAdvance, IncrementsMinutes) {
+	CHECK_ADVANCE(2017, 1, 10, 12,  8,  2017, 1, 10, 12,  9);
+	CHECK_ADVANCE(2017, 1, 10, 12,  9,  2017, 1, 10, 12, 10);
+	CHECK_ADVANCE(2017, 1, 10, 12, 39,  2017, 1, 10, 12, 40);
+}
+
+TEST(ATimeCodeAdvance, CarriesIntoHours) {
+	CHECK_ADVANCE(2017, 1, 10,  9, 59,  2017, 1, 10, 10,  0);
+	CHECK_ADVANCE(2017, 1, 10, 19, 59,  2017, 1, 10, 20,  0);
+}
+
+TEST(ATimeCodeAdvance, CarriesIntoDaysAndWeekdays) {
+	CHECK_ADVANCE(2017, 1,  8, 23, 59,  2017, 1,  9,  0,  0);
+	CHECK_ADVANCE(2017, 1, 19, 23, 59,  2017, 1, 20,  0,  0);
+}
+
+TEST(ATimeCodeAdvance, CarriesIntoMonths) {
+	CHECK_ADVANCE(2017, 1, 31, 23, 59,  2017, 2,  1,  0,  0);
+	CHECK_ADVANCE(2017, 2, 28, 23, 59,  2017, 3,  1,  0,  0);
+	CHECK_ADVANCE(2017, 11, 30, 23, 59, 2017, 12, 1,  0,  0);
+}
+
+TEST(ATimeCodeAdvance, KnowsLeapYears) {
+	CHECK_ADVANCE(2016, 2, 28, 23, 59,  2016, 2, 29,  0,  0);
+	CHECK_ADVANCE(2016, 2, 29, 23, 59,  2016, 3,  1,  0,  0);
+	CHECK_ADVANCE(2000, 2, 28, 23, 59,  2000, 2, 29,  0,  0);
+}
+
+TEST(ATimeCodeAdvance, CarriesIntoYears) {
+	CHECK_ADVANCE(2019, 12, 31, 23, 59,  2020, 1, 1,  0,  0);
+	CHECK_ADVANCE(2099, 12, 31, 23, 59,  2100, 1, 1,  0,  0);
+}
+
+/* XXX
+ * The following test depends on CET/CEST being your local timezone.
+ */
+TEST(ATimeCodeAdvance, RepeatsHourWhenSummerTimeEnds) {
+	stm.tm_year = 118;	/* Sun Oct 28 02:59:00 2018 (CEST) */
+	stm.tm_mon  = 9;
+	stm.tm_mday = 28;
+	stm.tm_hour = 2;
+	stm.tm_min  = 59;
+	stm.tm_wday = 0;
+	stm.tm_isdst = 1;
+	DCF77TimeCode_ConvertFromStructTM(&tcc.block, &stm);
+	LONGS_EQUAL(1, tcc.dcfTc.A1);
+
+	DCF77TimeCode_AdvanceByMinute(&tcc.block);
+	DCF77TimeCode_ConvertToStructTM(&tcc.block, &stm);
+
+	LONGS_EQUAL(2, stm.tm_hour);
+	LONGS_EQUAL(0, stm.tm_min);
+	LONGS_EQUAL(0, stm.tm_isdst);
+	LONGS_EQUAL(0, tcc.dcfTc.A1);
+}
+
+TEST(ATimeCodeAdvance, SkipsHourWhenSummerTimeStartsUsingDSTTable) {
+	DCF77DSTTable_t table;
+
+	DCF77DSTTable_Build(&table, 2018, 2018);
+	DCF77TimeCode_UseDSTTable(&table);
+
+	stm.tm_year = 118;	/* Sun Mar 25 01:59:00 2018 (CET) */
+	stm.tm_mon  = 2;
+	stm.tm_mday = 25;
+	stm.tm_hour = 1;
+	stm.tm_min  = 59;
+	stm.tm_wday = 0;
+	stm.tm_isdst = 0;
+	DCF77TimeCode_ConvertFromStructTM(&tcc.block, &stm);
+	LONGS_EQUAL(1, tcc.dcfTc.A1);
+
+	DCF77TimeCode_AdvanceByMinute(&tcc.block);
+	DCF77TimeCode_ConvertToStructTM(&tcc.block, &stm);
+	DCF77TimeCode_UseDSTTable(NULL);
+
+	LONGS_EQUAL(3, stm.tm_hour);
+	LONGS_EQUAL(0, stm.tm_min);
+	LONGS_EQUAL(1, stm.tm_isdst);
+	LONGS_EQUAL(0, tcc.dcfTc.A1);
+}
+
+
+/* ====================================================================== */
+TEST_GROUP(ATimeCodeBatchConversion)
+{
+	enum { QTY = 24 };
+	DCF77Block_t blocks[QTY];
+	struct tm stms[QTY];
+
+	void setup() override {
+		memset((void*)stms, 0, sizeof(stms));
+
+		for (int i = 0; i < QTY; ++i) {
+			stms[i].tm_year = 100 + 4 * i;
+			stms[i].tm_mon  = i % 12;
+			stms[i].tm_mday = 1 + i;
+			stms[i].tm_hour = i;
+			stms[i].tm_min  = 59 - 2 * i;
+			stms[i].tm_wday = i % 7;
+			stms[i].tm_isdst = i % 2;
+		}
+		DCF77TimeCode_ConvertFromStructTMBatch(blocks, stms, QTY);
+	}
+};
+
+TEST(ATimeCodeBatchConversion, EncodesLikeSingleBlockConversion) {
+	DCF77Block_t single;
+
+	for (int i = 0; i < QTY; ++i) {
+		DCF77TimeCode_ConvertFromStructTM(&single, &stms[i]);
+		MEMCMP_EQUAL(single.data, blocks[i].data, DCF77BLOCK_SIZE);
+	}
+}
+
+TEST(ATimeCodeBatchConversion, DecodesLikeSingleBlockConversion) {
+	struct tm decoded[QTY], single;
+
+	DCF77TimeCode_ConvertToStructTMBatch(blocks, decoded, QTY);
+
+	for (int i = 0; i < QTY; ++i) {
+		DCF77TimeCode_ConvertToStructTM(&blocks[i], &single);
+		MEMCMP_EQUAL(&single, &decoded[i], sizeof(single));
+	}
+}
+
+TEST(ATimeCodeBatchConversion, DecodesFieldsInBinary) {
+	DCF77Fields_t fields[QTY];
+
+	DCF77TimeCode_DecodeFieldsBatch(blocks, fields, QTY);
+
+	for (int i = 0; i < QTY; ++i) {
+		LONGS_EQUAL(stms[i].tm_min,  fields[i].minute);
+		LONGS_EQUAL(stms[i].tm_hour, fields[i].hour);
+		LONGS_EQUAL(stms[i].tm_mday, fields[i].dayOfMonth);
+		LONGS_EQUAL(stms[i].tm_mon + 1, fields[i].month);
+		LONGS_EQUAL(stms[i].tm_year % 100, fields[i].year);
+		LONGS_EQUAL(stms[i].tm_wday ? stms[i].tm_wday : 7,
+		    fields[i].dayOfWeek);
+		LONGS_EQUAL(stms[i].tm_isdst, fields[i].isdst);
+	}
+}
+
+TEST(ATimeCodeBatchConversion, SetsA1LikeSingleBlockConversion) {
+	/* 00:00 to 02:59 on the days of the changes in 2017 */
+	static const time_t starts[] = { 1490482800, 1509228000 };
+	enum { MINUTES = 180 };
+	DCF77Block_t run[MINUTES], single;
+	struct tm runStms[MINUTES];
+	int a1;
+
+	for (int k = 0; k < 2; ++k) {
+		for (int i = 0; i < MINUTES; ++i) {
+			time_t t = starts[k] + 60 * i;
+
+			(void)localtime_r(&t, &runStms[i]);
+		}
+		DCF77TimeCode_ConvertFromStructTMBatch(run, runStms, MINUTES);
+
+		a1 = 0;
+		for (int i = 0; i < MINUTES; ++i) {
+			DCF77TimeCode_ConvertFromStructTM(&single, &runStms[i]);
+			MEMCMP_EQUAL(single.data, run[i].data, DCF77BLOCK_SIZE);
+			a1 += (int)DCF77TC_GET(DCF77TimeCode_LoadWord(&run[i]),
+			    A1);
+		}
+		LONGS_EQUAL(60, a1);
+	}
+}
+
+
+/* ====================================================================== */
+TEST_GROUP(ATimeCodeFieldSplit)
+{
+	DCF77Block_t block;
+	DCF77FieldSplit_t split;
+
+	void setup() override {
+		/* Tue Sep 26 15:46:00 2017 (CEST) */
+		DCF77Block_ParseText("0000D2B86A2A5D00", &block);
+	}
+};
+
+TEST(ATimeCodeFieldSplit, ExtractsFieldValues) {
+	DCF77TimeCode_SplitInFieldsR(&block, &split, 0);
+
+	LONGS_EQUAL(0x46, split.value[8]);	/* min */
+	LONGS_EQUAL(0x15, split.value[10]);	/* hour */
+	LONGS_EQUAL(0x26, split.value[12]);	/* dom */
+	LONGS_EQUAL(2,    split.value[13]);	/* dow */
+	LONGS_EQUAL(0x09, split.value[14]);	/* month */
+	LONGS_EQUAL(0x17, split.value[15]);	/* year */
+	LONGS_EQUAL(1,    split.value[4]);	/* Z1 */
+}
+
+TEST(ATimeCodeFieldSplit, BuildsStringsOnlyWhenAsked) {
+	DCF77TimeCode_SplitInFieldsR(&block, &split, DCF77FIELDSPLIT_HEXSTR);
+
+	POINTERS_EQUAL(NULL, split.views[8].asBinStr);
+	STRCMP_EQUAL("46", split.views[8].asHexStr);
+	STRCMP_EQUAL("min", split.views[8].name);
+}
+
+TEST(ATimeCodeFieldSplit, PutsLeastSignificantBitFirst) {
+	DCF77TimeCode_SplitInFieldsR(&block, &split, DCF77FIELDSPLIT_BINSTR);
+
+	STRCMP_EQUAL("0110001", split.views[8].asBinStr);
+	STRCMP_EQUAL("11101000", split.views[15].asBinStr);
+	STRCMP_EQUAL("00000000000000", split.views[1].asBinStr);
+}
+
+TEST(ATimeCodeFieldSplit, KeepsSharedVariantWorking) {
+	const DCF77FieldViews_t * pViews = NULL;
+	size_t qty = 0u;
+
+	DCF77TimeCode_SplitInFields(&block, &pViews, &qty);
+
+	LONGS_EQUAL(DCF77FIELDSPLIT_ROWS_QTY, qty);
+	STRCMP_EQUAL("101010", pViews[10].asBinStr);
+	STRCMP_EQUAL("15", pViews[10].asHexStr);
+}
+
+TEST_GROUP(ATimeCodeValidation)
+{
+	DCF77Block_t block;
+	DCF77Block_t next;
+
+	void setup() override {
+		DCF77Block_FromText("0000D2B86A2A5D00", &block);
+		DCF77Block_FromText("0000F2A86A2A5D00", &next);
+	}
+
+	void flip(DCF77Block_t * pBlock, unsigned bit) {
+		pBlock->data[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+	}
+};
+
+TEST(ATimeCodeValidation, AcceptsEncodedBlocks) {
+	struct tm stm;
+	time_t t = 1506433560;
+
+	for (int i = 0; i < 1440; ++i, t += 3 * 60 + 7 * 3600) {
+		(void)localtime_r(&t, &stm);
+		DCF77TimeCode_ConvertFromStructTM(&block, &stm);
+		LONGS_EQUAL(0, DCF77TimeCode_Validate(&block));
+	}
+}
+
+TEST(ATimeCodeValidation, ReportsFramingBits) {
+	flip(&block, 0);
+	flip(&block, 20);
+	flip(&block, 18);
+
+	LONGS_EQUAL(DCF77TIMECODE_ERR_M | DCF77TIMECODE_ERR_S |
+	    DCF77TIMECODE_ERR_Z, DCF77TimeCode_Validate(&block));
+}
+
+TEST(ATimeCodeValidation, ReportsParityOfEachGroup) {
+	flip(&block, 28);
+	LONGS_EQUAL(DCF77TIMECODE_ERR_P1, DCF77TimeCode_Validate(&block));
+	flip(&block, 28);
+	flip(&block, 35);
+	LONGS_EQUAL(DCF77TIMECODE_ERR_P2, DCF77TimeCode_Validate(&block));
+	flip(&block, 35);
+	flip(&block, 58);
+	LONGS_EQUAL(DCF77TIMECODE_ERR_P3, DCF77TimeCode_Validate(&block));
+}
+
+TEST(ATimeCodeValidation, ReportsBCDOutOfRange) {
+	/* minute 46 -> 4E: bad units digit, fixed parity */
+	flip(&block, 24);
+	flip(&block, 28);
+
+	LONGS_EQUAL(DCF77TIMECODE_ERR_MINUTE, DCF77TimeCode_Validate(&block));
+}
+
+TEST(ATimeCodeValidation, ReportsBitsPastMinuteMark) {
+	flip(&block, 59);
+
+	LONGS_EQUAL(DCF77TIMECODE_ERR_TAIL, DCF77TimeCode_Validate(&block));
+}
+
+TEST(ATimeCodeValidation, CountsFaultyBlocksInBatch) {
+	DCF77Block_t blocks[3] = { block, block, next };
+	unsigned errors[3];
+
+	flip(&blocks[1], 30);
+
+	LONGS_EQUAL(1, DCF77TimeCode_ValidateBatch(blocks, errors, 3));
+	LONGS_EQUAL(0, errors[0]);
+	LONGS_EQUAL(DCF77TIMECODE_ERR_P2, errors[1]);
+	LONGS_EQUAL(0, errors[2]);
+}
+
+TEST(ATimeCodeValidation, NamesErrors) {
+	char buf[32];
+
+	DCF77TimeCode_DescribeErrors(DCF77TIMECODE_ERR_P1 |
+	    DCF77TIMECODE_ERR_YEAR, buf, sizeof(buf));
+	STRCMP_EQUAL("P1,year", buf);
+	DCF77TimeCode_DescribeErrors(0, buf, sizeof(buf));
+	STRCMP_EQUAL("", buf);
+}
+
+TEST(ATimeCodeValidation, LeavesValidBlockIntact) {
+	DCF77Block_t received = next;
+
+	LONGS_EQUAL(DCF77TIMECODE_REPAIR_INTACT,
+	    DCF77TimeCode_Repair(&block, &received));
+	MEMCMP_EQUAL(&next, &received, sizeof(received));
+}
+
+TEST(ATimeCodeValidation, RepairsAnySingleCheckedBit) {
+	const unsigned checked[] = { 0, 17, 18, 20, 21, 27, 28, 33, 35,
+	    36, 44, 49, 57, 58 };
+
+	for (unsigned bit : checked) {
+		DCF77Block_t received = next;
+
+		flip(&received, bit);
+		LONGS_EQUAL(DCF77TIMECODE_REPAIR_FIXED,
+		    DCF77TimeCode_Repair(&block, &received));
+		MEMCMP_EQUAL(&next, &received, sizeof(received));
+	}
+}
+
+TEST(ATimeCodeValidation, GivesUpOnDoubleErrors) {
+	DCF77Block_t received = next;
+
+	flip(&received, 0);
+	flip(&received, 20);
+
+	LONGS_EQUAL(DCF77TIMECODE_REPAIR_FAILED,
+	    DCF77TimeCode_Repair(&block, &received));
+}
+
+TEST(ATimeCodeValidation, ClearsTailWithoutBlockBefore) {
+	DCF77Block_t received, expected;
+
+	/* Sun Oct 29 01:04 2017 CEST, bit 59 set */
+	DCF77Block_ParseText("00009230981E5E0C", &received);
+	DCF77Block_ParseText("00009230981E5E04", &expected);
+
+	LONGS_EQUAL(DCF77TIMECODE_REPAIR_FIXED,
+	    DCF77TimeCode_Repair(NULL, &received));
+	MEMCMP_EQUAL(&expected, &received, sizeof(received));
+}
+
+TEST(ATimeCodeValidation, RepairsSingleBitWithTailSet) {
+	DCF77Block_t received = next;
+
+	flip(&received, 20);
+	flip(&received, 59);
+	flip(&received, 63);
+
+	LONGS_EQUAL(DCF77TIMECODE_REPAIR_FIXED,
+	    DCF77TimeCode_Repair(&block, &received));
+	MEMCMP_EQUAL(&next, &received, sizeof(received));
+
+	flip(&received, 20);
+	flip(&received, 59);
+	LONGS_EQUAL(DCF77TIMECODE_REPAIR_FAILED,
+	    DCF77TimeCode_Repair(NULL, &received));
+}
+
+/*
+ * The explicit codec must lay bits out exactly as the bitfield struct
+ * does with this compiler.
+ */
+TEST_GROUP(ATimeCodeWordCodec)
+{
+	union TimeCodeConversion_t tcc;
+	DCF77Block_t block;
+
+	void setup() override {
+		memset(&tcc, 0, sizeof(tcc));
+	}
+
+	void checkSameBytes(uint64_t w) {
+		DCF77TimeCode_StoreWord(w, &block);
+		MEMCMP_EQUAL(&tcc.block, &block, sizeof(block));
+	}
+};
+
+TEST(ATimeCodeWordCodec, PlacesEveryFieldLikeBitfields) {
+	tcc.dcfTc.M = 1;          checkSameBytes(DCF77TC_MASK(M));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.weather = 0x3FFF; checkSameBytes(DCF77TC_MASK(WEATHER));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.R = 1;          checkSameBytes(DCF77TC_MASK(R));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.A1 = 1;         checkSameBytes(DCF77TC_MASK(A1));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.Z1 = 1;         checkSameBytes(DCF77TC_MASK(Z1));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.Z2 = 1;         checkSameBytes(DCF77TC_MASK(Z2));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.A2 = 1;         checkSameBytes(DCF77TC_MASK(A2));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.S = 1;          checkSameBytes(DCF77TC_MASK(S));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.minute = 0x7F;  checkSameBytes(DCF77TC_MASK(MIN));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.P1 = 1;         checkSameBytes(DCF77TC_MASK(P1));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.hour = 0x3F;    checkSameBytes(DCF77TC_MASK(HOUR));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.P2 = 1;         checkSameBytes(DCF77TC_MASK(P2));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.dayOfMonth = 0x3F; checkSameBytes(DCF77TC_MASK(DOM));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.dayOfWeek = 0x7; checkSameBytes(DCF77TC_MASK(DOW));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.month = 0x1F;   checkSameBytes(DCF77TC_MASK(MONTH));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.year = 0xFF;    checkSameBytes(DCF77TC_MASK(YEAR));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.P3 = 1;         checkSameBytes(DCF77TC_MASK(P3));
+	memset(&tcc, 0, sizeof(tcc));
+	tcc.dcfTc.MM = 1;         checkSameBytes(DCF77TC_MASK(MM));
+}
+
+TEST(ATimeCodeWordCodec, ReadsFieldsLikeBitfields) {
+	uint64_t x = UINT64_C(0x9E3779B97F4A7C15);
+
+	for (int i = 0; i < 1000; ++i) {
+		x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+		uint64_t w = x & ((UINT64_C(1) << DCF77TIMECODE_BITS_QTY) - 1);
+
+		DCF77TimeCode_StoreWord(w, &tcc.block);
+		CHECK(w == DCF77TimeCode_LoadWord(&tcc.block));
+		LONGS_EQUAL(tcc.dcfTc.weather,    DCF77TC_GET(w, WEATHER));
+		LONGS_EQUAL(tcc.dcfTc.A1,         DCF77TC_GET(w, A1));
+		LONGS_EQUAL(tcc.dcfTc.Z2,         DCF77TC_GET(w, Z2));
+		LONGS_EQUAL(tcc.dcfTc.minute,     DCF77TC_GET(w, MIN));
+		LONGS_EQUAL(tcc.dcfTc.P1,         DCF77TC_GET(w, P1));
+		LONGS_EQUAL(tcc.dcfTc.hour,       DCF77TC_GET(w, HOUR));
+		LONGS_EQUAL(tcc.dcfTc.dayOfMonth, DCF77TC_GET(w, DOM));
+		LONGS_EQUAL(tcc.dcfTc.dayOfWeek,  DCF77TC_GET(w, DOW));
+		LONGS_EQUAL(tcc.dcfTc.month,      DCF77TC_GET(w, MONTH));
+		LONGS_EQUAL(tcc.dcfTc.year,       DCF77TC_GET(w, YEAR));
+		LONGS_EQUAL(tcc.dcfTc.P3,         DCF77TC_GET(w, P3));
+	}
+}
+
+TEST(ATimeCodeWordCodec, ReplacesOnlyTheFieldPut) {
+	uint64_t w = ~UINT64_C(0);
+
+	w = DCF77TC_PUT(w, HOUR, 0x15);
+
+	LONGS_EQUAL(0x15, DCF77TC_GET(w, HOUR));
+	CHECK((w | DCF77TC_MASK(HOUR)) == ~UINT64_C(0));
+}
@@ -0,0 +1,107 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include <time.h>
+extern "C"
+{
+#include "DCF77TimeCode.h"
+#include "DCF77Transmit.h"
+};
+
+enum { MAX_EDGES = 64 };
+
+/* edges seen by the recording sink, in order */
+static unsigned startSeconds[MAX_EDGES], startBits[MAX_EDGES];
+static unsigned endSeconds[MAX_EDGES];
+static unsigned startsQty, endsQty;
+
+static void
+recordPulseStart(DCF77TxSink_t *, unsigned second, unsigned bit)
+{
+	if (startsQty < MAX_EDGES) {
+		startSeconds[startsQty] = second;
+		startBits[startsQty] = bit;
+	}
+	++startsQty;
+}
+
+static void
+recordPulseEnd(DCF77TxSink_t *, unsigned second)
+{
+	if (endsQty < MAX_EDGES)
+		endSeconds[endsQty] = second;
+	++endsQty;
+}
+
+TEST_GROUP(ATransmitter)
+{
+	DCF77TxSink_t sink;
+	DCF77TxStats_t stats;
+	DCF77Block_t block;
+	time_t minuteStart;
+
+	void setup() override {
+		startsQty = endsQty = 0;
+		memset(&sink, 0, sizeof(sink));
+		sink.fd = -1;
+		sink.pulseStart = recordPulseStart;
+		sink.pulseEnd = recordPulseEnd;
+		DCF77Transmit_ResetStats(&stats);
+
+		/* long gone, so that no edge is waited for */
+		minuteStart = time(NULL) - 3600;
+		DCF77Block_FromText("0000D2B86A2A5D00", &block);
+	}
+
+	unsigned bitOf(unsigned second) {
+		return (block.data[second / 8] >> (second % 8)) & 1u;
+	}
+
+	void CHECK_JITTER(const DCF77TxJitter_t * pJitter, unsigned qty) {
+		LONGS_EQUAL(qty, pJitter->qty);
+		CHECK(pJitter->minNs <= pJitter->maxNs);
+		CHECK(pJitter->minNs >= 0);
+	}
+};
+
+TEST(ATransmitter, SendsBitsInSeconds0To58) {
+	DCF77Transmit_Minute(&sink, &block, minuteStart, &stats);
+
+	LONGS_EQUAL(59, startsQty);
+	LONGS_EQUAL(59, endsQty);
+	for (unsigned s = 0; s < 59; ++s) {
+		LONGS_EQUAL(s, startSeconds[s]);
+		LONGS_EQUAL(bitOf(s), startBits[s]);
+		LONGS_EQUAL(s, endSeconds[s]);
+	}
+}
+
+TEST(ATransmitter, SendsZeroInSecond59OfLeapSecondMinute) {
+	/* Sun Jan  1 01:00 2017 CET, A2 set; minute mark bit set too */
+	DCF77Block_FromText("00001C20183C5C04", &block);
+	block.data[7] |= 0x08u;
+	CHECK(DCF77TimeCode_HasLeapSecond(&block));
+
+	DCF77Transmit_Minute(&sink, &block, minuteStart, &stats);
+
+	/* no pulse in second 60 */
+	LONGS_EQUAL(60, startsQty);
+	LONGS_EQUAL(60, endsQty);
+	LONGS_EQUAL(59, startSeconds[59]);
+	LONGS_EQUAL(0, startBits[59]);
+	LONGS_EQUAL(59, endSeconds[59]);
+}
+
+TEST(ATransmitter, AccountsLatenessOfEveryEdge) {
+	DCF77Transmit_Minute(&sink, &block, minuteStart, &stats);
+
+	CHECK_JITTER(&stats.leading, 59);
+	CHECK_JITTER(&stats.trailing, 59);
+}
+
+TEST(ATransmitter, AccountsLatenessOfLeapSecondMinute) {
+	DCF77Block_FromText("00001C20183C5C04", &block);
+	DCF77Transmit_Minute(&sink, &block, minuteStart, &stats);
+
+	CHECK_JITTER(&stats.leading, 60);
+	CHECK_JITTER(&stats.trailing, 60);
+}
@@ -0,0 +1,168 @@
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+extern "C"
+{
+#include "DCF77TimeCode.h"
+#include "DCF77Weather.h"
+};
+
+enum { BLOCKS_QTY = 60 };
+
+#define FOUND_MAX 32
+static size_t foundFirst[FOUND_MAX];
+static uint64_t foundPayloads[FOUND_MAX];
+static unsigned foundQty;
+
+static void
+collectPayload(void * ctx, size_t first, uint64_t payload)
+{
+	(void)ctx;
+	if (foundQty < FOUND_MAX) {
+		foundFirst[foundQty] = first;
+		foundPayloads[foundQty] = payload;
+	}
+	++foundQty;
+}
+
+/* a stand-in for the real cipher: the key spread over the bits, XORed */
+static uint64_t lastKey;
+
+static uint64_t
+xorCipher(void * ctx, uint64_t bits, uint64_t key)
+{
+	(void)ctx;
+	lastKey = key;
+	return bits ^ ((key * UINT64_C(0x9E3779B97F4A7C15)) >> 22);
+}
+
+static unsigned
+weatherOf(const DCF77Block_t * pBlock)
+{
+	DCF77FieldSplit_t split;
+
+	DCF77TimeCode_SplitInFieldsR(pBlock, &split, 0);
+	return split.value[1];
+}
+
+TEST_GROUP(AWeatherFrame)
+{
+	/* Tue Sep 26 15:46 2017 on */
+	DCF77Block_t blocks[BLOCKS_QTY];
+	uint64_t payloads[BLOCKS_QTY / 3];
+
+	void setup() {
+		int i;
+
+		foundQty = 0;
+		DCF77Block_FromText("0000D2B86A2A5D00", &blocks[0]);
+		for (i = 1; i < BLOCKS_QTY; ++i) {
+			blocks[i] = blocks[i - 1];
+			DCF77TimeCode_AdvanceByMinute(&blocks[i]);
+		}
+		for (i = 0; i < BLOCKS_QTY / 3; ++i) {
+			payloads[i] = (UINT64_C(0x2A5A5A5A5A5) + i * 12345) &
+			    DCF77WEATHER_PAYLOAD_MASK;
+		}
+	}
+};
+
+TEST(AWeatherFrame, StartsAtMinuteMultipleOfThree)
+{
+	CHECK_FALSE(DCF77Weather_IsFrameAt(&blocks[0], 3));	/* :46 */
+	CHECK_FALSE(DCF77Weather_IsFrameAt(&blocks[1], 3));	/* :47 */
+	CHECK(DCF77Weather_IsFrameAt(&blocks[2], 3));		/* :48 */
+	CHECK_FALSE(DCF77Weather_IsFrameAt(&blocks[2], 2));
+	CHECK(DCF77Weather_IsFrameAt(&blocks[14], 3));		/* 16:00 */
+	CHECK(DCF77Weather_IsFrameAt(&blocks[11], 3));		/* :57 */
+}
+
+TEST(AWeatherFrame, NeedsConsecutiveMinutes)
+{
+	DCF77Block_t frame[3] = { blocks[23], blocks[24], blocks[26] };
+
+	CHECK(DCF77Weather_IsFrameAt(&blocks[23], 3));		/* 16:09 */
+	CHECK_FALSE(DCF77Weather_IsFrameAt(frame, 3));
+}
+
+TEST(AWeatherFrame, SpreadsBitsOverThreeBlocks)
+{
+	DCF77Weather_Put(&blocks[2], UINT64_C(0x123456789AB), NULL);
+
+	LONGS_EQUAL(0x09AB, weatherOf(&blocks[2]));
+	LONGS_EQUAL(0x159E, weatherOf(&blocks[3]));
+	LONGS_EQUAL(0x1234, weatherOf(&blocks[4]));
+	CHECK(UINT64_C(0x123456789AB) == DCF77Weather_Get(&blocks[2], NULL));
+}
+
+TEST(AWeatherFrame, LeavesTimeIntact)
+{
+	struct tm before, after;
+
+	DCF77TimeCode_ConvertToStructTM(&blocks[3], &before);
+	DCF77Weather_Put(&blocks[2], DCF77WEATHER_PAYLOAD_MASK, NULL);
+	DCF77TimeCode_ConvertToStructTM(&blocks[3], &after);
+
+	LONGS_EQUAL(0, DCF77TimeCode_Validate(&blocks[3]));
+	LONGS_EQUAL(before.tm_min, after.tm_min);
+	LONGS_EQUAL(before.tm_hour, after.tm_hour);
+	LONGS_EQUAL(before.tm_mday, after.tm_mday);
+}
+
+TEST(AWeatherFrame, KeysWithTimeOfFirstBlock)
+{
+	/* min 48, hour 15, dom 26, dow 2, month 9, year 17 */
+	uint64_t key = 0x48u | (UINT64_C(0x15) << 8) |
+	    (UINT64_C(0x26) << 15) | (UINT64_C(2) << 21) |
+	    (UINT64_C(0x09) << 24) | (UINT64_C(0x17) << 29);
+
+	CHECK(key == DCF77Weather_KeyOf(&blocks[2]));
+}
+
+TEST(AWeatherFrame, PacksAndUnpacksPayloads)
+{
+	size_t qty = DCF77Weather_Pack(blocks, BLOCKS_QTY, payloads,
+	    BLOCKS_QTY / 3, NULL);
+	unsigned i;
+
+	/* 15:48 to 16:42 */
+	LONGS_EQUAL(19, qty);
+	LONGS_EQUAL(0, weatherOf(&blocks[0]));
+	LONGS_EQUAL(0, weatherOf(&blocks[59]));
+
+	LONGS_EQUAL(19, DCF77Weather_Unpack(blocks, BLOCKS_QTY, NULL,
+	    collectPayload, NULL));
+	for (i = 0; i < 19; ++i) {
+		LONGS_EQUAL(2 + 3 * i, foundFirst[i]);
+		CHECK(payloads[i] == foundPayloads[i]);
+	}
+}
+
+TEST(AWeatherFrame, CiphersWithCallerCipher)
+{
+	DCF77WeatherCipher_t cipher = { xorCipher, xorCipher, NULL };
+	uint64_t onAir;
+
+	DCF77Weather_Pack(blocks, BLOCKS_QTY, payloads, 1, &cipher);
+	CHECK(DCF77Weather_KeyOf(&blocks[2]) == lastKey);
+
+	onAir = DCF77Weather_Get(&blocks[2], NULL);
+	CHECK(payloads[0] != onAir);
+	CHECK(payloads[0] == DCF77Weather_Get(&blocks[2], &cipher));
+
+	DCF77Weather_Unpack(blocks, BLOCKS_QTY, &cipher, collectPayload,
+	    NULL);
+	CHECK(payloads[0] == foundPayloads[0]);
+}
+
+TEST(AWeatherFrame, SkipsFramesWithBlocksLost)
+{
+	DCF77Weather_Pack(blocks, BLOCKS_QTY, payloads, BLOCKS_QTY / 3, NULL);
+	/* 15:52 is lost */
+	memmove(&blocks[6], &blocks[7], (BLOCKS_QTY - 7) * sizeof(blocks[0]));
+
+	LONGS_EQUAL(18, DCF77Weather_Unpack(blocks, BLOCKS_QTY - 1, NULL,
+	    collectPayload, NULL));
+	CHECK(payloads[0] == foundPayloads[0]);
+	LONGS_EQUAL(7, foundFirst[1]);
+	CHECK(payloads[2] == foundPayloads[1]);
+}
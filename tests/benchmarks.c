@@ -0,0 +1,603 @@
+/*
+ * Microbenchmarks of the encode/decode/dump hot paths.
+ *
+ * Every benchmark is warmed up, calibrated to run for at least the
+ * minimal time, then repeated; a JSON object per benchmark goes to
+ * stdout, one per line.
+ */
+#include <err.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "DCF77Block.h"
+#include "DCF77Continuity.h"
+#include "DCF77Demod.h"
+#include "DCF77DSTTable.h"
+#include "DCF77Format.h"
+#include "DCF77PM.h"
+#include "DCF77PMRx.h"
+#include "DCF77Schedule.h"
+#include "DCF77Sync.h"
+#include "DCF77TimeCode.h"
+#include "DCF77Weather.h"
+#include "utils.h"
+
+#define SAMPLE_QTY	1440	/* a day worth of minutes */
+#define REPEATS_MAX	100
+
+static DCF77Block_t	sampleBlocks[SAMPLE_QTY];
+static char		sampleTexts[SAMPLE_QTY][DCF77BLOCK_TEXT_LEN + 1];
+static struct tm	sampleStms[SAMPLE_QTY];
+static DCF77DSTTable_t	dstTable;
+
+#define DEMOD_RATE	48000	/* a ms of such samples is one op */
+static float		sampleAudio[SAMPLE_QTY * DEMOD_RATE / 1000];
+
+#define DUMP_FORMAT	"%c (%Z)"	/* default of dcfcode -d */
+static DCF77Format_t	dumpFormat;
+static DCF77Schedule_t	sampleSchedule;	/* a year from the samples on */
+static DCF77Bits_t	sampleBits;	/* a minute of capture is one op */
+/* a second of PM baseband over and over, a ms of it is one op */
+#define PM_OP_SAMPLES	(SAMPLE_QTY * DEMOD_RATE / 1000)
+static float		samplePhase[DEMOD_RATE + PM_OP_SAMPLES];
+
+static volatile unsigned sink;
+
+typedef struct {
+	const char	*name;
+	void		(*run)(size_t iters);	/* SAMPLE_QTY ops each */
+} Benchmark_t;
+
+static void
+benchFromText(size_t iters)
+{
+	DCF77Block_t block;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77Block_FromText(sampleTexts[j], &block);
+			sink += block.data[3];
+		}
+	}
+}
+
+static void
+benchToText(size_t iters)
+{
+	char text[DCF77BLOCK_TEXT_LEN + 1];
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77Block_ToText(&sampleBlocks[j], text, sizeof(text));
+			sink += (unsigned)text[5];
+		}
+	}
+}
+
+static void
+benchConvertFromStructTM(size_t iters)
+{
+	DCF77Block_t block;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77TimeCode_ConvertFromStructTM(&block,
+			    &sampleStms[j]);
+			sink += block.data[4];
+		}
+	}
+}
+
+static void
+benchConvertFromStructTMWithDSTTable(size_t iters)
+{
+	DCF77TimeCode_UseDSTTable(&dstTable);
+	benchConvertFromStructTM(iters);
+	DCF77TimeCode_UseDSTTable(NULL);
+}
+
+static void
+benchConvertFromStructTMBatch(size_t iters)
+{
+	static DCF77Block_t blocks[SAMPLE_QTY];
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		DCF77TimeCode_ConvertFromStructTMBatch(blocks, sampleStms,
+		    SAMPLE_QTY);
+		sink += blocks[i % SAMPLE_QTY].data[4];
+	}
+}
+
+static void
+benchConvertToStructTMBatch(size_t iters)
+{
+	static struct tm stms[SAMPLE_QTY];
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		DCF77TimeCode_ConvertToStructTMBatch(sampleBlocks, stms,
+		    SAMPLE_QTY);
+		sink += (unsigned)stms[i % SAMPLE_QTY].tm_min;
+	}
+}
+
+static void
+benchConvertToStructTM(size_t iters)
+{
+	struct tm stm;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77TimeCode_ConvertToStructTM(&sampleBlocks[j], &stm);
+			sink += (unsigned)stm.tm_min;
+		}
+	}
+}
+
+static void
+benchConvertToStructTMMktime(size_t iters)
+{
+	struct tm stm;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77TimeCode_ConvertToStructTM(&sampleBlocks[j], &stm);
+			sink += (unsigned)mktime(&stm);
+		}
+	}
+}
+
+static void
+benchScheduleTimeOf(size_t iters)
+{
+	time_t t = 0;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			(void)DCF77Schedule_TimeOf(&sampleSchedule,
+			    &sampleBlocks[j], &t);
+			sink += (unsigned)t;
+		}
+	}
+}
+
+static void
+benchStrftime(size_t iters)
+{
+	char buf[80];
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			sink += (unsigned)strftime(buf, sizeof(buf),
+			    DUMP_FORMAT, &sampleStms[j]);
+		}
+	}
+}
+
+static void
+benchFormatRender(size_t iters)
+{
+	char buf[80];
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			sink += (unsigned)DCF77Format_Render(&dumpFormat,
+			    &sampleStms[j], buf, sizeof(buf));
+		}
+	}
+}
+
+static void
+benchDecodeFieldsBatch(size_t iters)
+{
+	static DCF77Fields_t fields[SAMPLE_QTY];
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		DCF77TimeCode_DecodeFieldsBatch(sampleBlocks, fields,
+		    SAMPLE_QTY);
+		sink += fields[i % SAMPLE_QTY].minute;
+	}
+}
+
+static void
+benchValidateBatch(size_t iters)
+{
+	static unsigned errors[SAMPLE_QTY];
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		sink += (unsigned)DCF77TimeCode_ValidateBatch(sampleBlocks,
+		    errors, SAMPLE_QTY);
+	}
+}
+
+static void
+benchAdvanceByMinute(size_t iters)
+{
+	DCF77Block_t block;
+	size_t i, j;
+
+	DCF77TimeCode_UseDSTTable(&dstTable);
+	for (i = 0; i < iters; ++i) {
+		block = sampleBlocks[0];
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77TimeCode_AdvanceByMinute(&block);
+		}
+		sink += block.data[3];
+	}
+	DCF77TimeCode_UseDSTTable(NULL);
+}
+
+static void
+benchSplitInFields(size_t iters)
+{
+	const DCF77FieldViews_t * pViews;
+	size_t i, j, qty;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77TimeCode_SplitInFields(&sampleBlocks[j],
+			    &pViews, &qty);
+			sink += (unsigned)pViews[8].asHexStr[0];
+		}
+	}
+}
+
+static void
+benchNormalizeStructTM(size_t iters)
+{
+	struct tm stm;
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			stm = sampleStms[j];
+			stm.tm_min += 1;
+			normalizeStructTM(&stm);
+			sink += (unsigned)stm.tm_min;
+		}
+	}
+}
+
+static void
+ignoreMinute(void * ctx, const DCF77DemodMinute_t * pMinute)
+{
+	(void)ctx;
+	sink += pMinute->block.data[3];
+}
+
+static void
+benchDemodPush(size_t iters)
+{
+	static DCF77Demod_t demod;
+	size_t i;
+
+	DCF77Demod_Init(&demod, DEMOD_RATE, ignoreMinute, NULL);
+	for (i = 0; i < iters; ++i) {
+		DCF77Demod_Push(&demod, sampleAudio,
+		    sizeof(sampleAudio) / sizeof(sampleAudio[0]));
+	}
+	sink += (unsigned)demod.msQty;
+}
+
+static void
+countFrame(void * ctx, uint64_t second, const DCF77Block_t * pBlock)
+{
+	(void)ctx;
+	sink += (unsigned)second + pBlock->data[3];
+}
+
+static void
+benchSyncScan(size_t iters)
+{
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		sink += (unsigned)DCF77Sync_Scan(&sampleBits,
+		    DCF77SYNC_NEEDS_MARK, countFrame, NULL);
+	}
+}
+
+static void
+benchPMMinuteChips(size_t iters)
+{
+	static uint64_t chips[60][DCF77PM_CHIP_WORDS];
+	size_t i, j;
+
+	for (i = 0; i < iters; ++i) {
+		for (j = 0; j < SAMPLE_QTY; ++j) {
+			DCF77PM_MinuteChips(&sampleBlocks[j], chips);
+			sink += (unsigned)chips[17][0];
+		}
+	}
+}
+
+static void
+ignoreSecond(void * ctx, const DCF77PMRxSecond_t * pSecond)
+{
+	(void)ctx;
+	sink += pSecond->bit;
+}
+
+static void
+benchPMRxPush(size_t iters)
+{
+	static DCF77PMRx_t rx;
+	static size_t at;
+	size_t i;
+
+	if (0u == rx.sampleRate) {
+		DCF77PMRx_Init(&rx, DEMOD_RATE, ignoreSecond, NULL);
+	}
+	for (i = 0; i < iters; ++i) {
+		DCF77PMRx_Push(&rx, &samplePhase[at], PM_OP_SAMPLES);
+		at = (at + PM_OP_SAMPLES) % DEMOD_RATE;
+	}
+}
+
+static void
+countPayload(void * ctx, size_t first, uint64_t payload)
+{
+	(void)ctx;
+	sink += (unsigned)(first + payload);
+}
+
+static void
+benchWeatherUnpack(size_t iters)
+{
+	size_t i;
+
+	for (i = 0; i < iters; ++i) {
+		sink += (unsigned)DCF77Weather_Unpack(sampleBlocks, SAMPLE_QTY,
+		    NULL, countPayload, NULL);
+	}
+}
+
+static void
+countRange(void * ctx, const DCF77ContinuityRange_t * pRange)
+{
+	(void)ctx;
+	sink += (unsigned)pRange->qty;
+}
+
+/* the day of samples, pushed as one stream */
+static void
+benchContinuityPush(size_t iters)
+{
+	DCF77Continuity_t check;
+	size_t i;
+
+	DCF77Continuity_Init(&check, countRange, NULL);
+	for (i = 0; i < iters; ++i) {
+		DCF77Continuity_Push(&check, sampleBlocks, SAMPLE_QTY);
+	}
+	sink += (unsigned)DCF77Continuity_Finish(&check);
+}
+
+static void
+benchContinuityPushWithDSTTable(size_t iters)
+{
+	DCF77TimeCode_UseDSTTable(&dstTable);
+	benchContinuityPush(iters);
+	DCF77TimeCode_UseDSTTable(NULL);
+}
+
+static const Benchmark_t benchmarks[] = {
+	{ "DCF77Block_FromText",		benchFromText },
+	{ "DCF77Block_ToText",			benchToText },
+	{ "DCF77TimeCode_ConvertFromStructTM",	benchConvertFromStructTM },
+	{ "DCF77TimeCode_ConvertFromStructTM+DSTTable",
+					benchConvertFromStructTMWithDSTTable },
+	{ "DCF77TimeCode_ConvertFromStructTMBatch",
+	    benchConvertFromStructTMBatch },
+	{ "DCF77TimeCode_ConvertToStructTM",	benchConvertToStructTM },
+	{ "DCF77TimeCode_ConvertToStructTMBatch",
+	    benchConvertToStructTMBatch },
+	{ "DCF77TimeCode_ConvertToStructTM+mktime",
+					benchConvertToStructTMMktime },
+	{ "DCF77Schedule_TimeOf",		benchScheduleTimeOf },
+	{ "strftime(" DUMP_FORMAT ")",		benchStrftime },
+	{ "DCF77Format_Render(" DUMP_FORMAT ")",	benchFormatRender },
+	{ "DCF77TimeCode_DecodeFieldsBatch",	benchDecodeFieldsBatch },
+	{ "DCF77TimeCode_ValidateBatch",	benchValidateBatch },
+	{ "DCF77TimeCode_AdvanceByMinute",	benchAdvanceByMinute },
+	{ "DCF77TimeCode_SplitInFields",	benchSplitInFields },
+	{ "normalizeStructTM",			benchNormalizeStructTM },
+	{ "DCF77Demod_Push(1ms@48kHz)",		benchDemodPush },
+	{ "DCF77Sync_Scan(1min)",		benchSyncScan },
+	{ "DCF77PM_MinuteChips",		benchPMMinuteChips },
+	{ "DCF77PMRx_Push(1ms@48kHz)",		benchPMRxPush },
+	{ "DCF77Weather_Unpack",		benchWeatherUnpack },
+	{ "DCF77Continuity_Push",		benchContinuityPush },
+	{ "DCF77Continuity_Push+DSTTable",	benchContinuityPushWithDSTTable },
+};
+
+static void
+prepareSamples(void)
+{
+	struct tm stm;
+	time_t t = 1506433560;	/* Tue Sep 26 13:46:00 2017 UTC */
+	size_t i;
+
+	tzset();
+	(void)localtime_r(&t, &stm);
+	DCF77DSTTable_Build(&dstTable, stm.tm_year + 1900,
+	    stm.tm_year + 1900 + 1);
+
+	for (i = 0; i < SAMPLE_QTY; ++i, t += 60) {
+		(void)localtime_r(&t, &sampleStms[i]);
+		DCF77TimeCode_ConvertFromStructTM(&sampleBlocks[i],
+		    &sampleStms[i]);
+		DCF77Block_ToText(&sampleBlocks[i], sampleTexts[i],
+		    sizeof(sampleTexts[i]));
+	}
+
+	DCF77Format_Compile(&dumpFormat, DUMP_FORMAT);
+	DCF77Schedule_Build(&sampleSchedule, 1506433560, 365 * 24 * 60);
+
+	DCF77Sync_InitBits(&sampleBits);
+	for (i = 0; i < SAMPLE_QTY * 60; ++i) {
+		const DCF77Block_t * pBlock = &sampleBlocks[i / 60];
+		unsigned k = (unsigned)(i % 60);
+
+		DCF77Sync_AppendBit(&sampleBits, 59 != k,
+		    (pBlock->data[k / 8] >> (k % 8)) & 1);
+	}
+
+	/* 15.5 kHz carrier, reduced by the pulse during first 100 ms */
+	for (i = 0; i < sizeof(sampleAudio) / sizeof(sampleAudio[0]); ++i) {
+		float level = (i % DEMOD_RATE < DEMOD_RATE / 10) ? 0.15f : 1.0f;
+
+		sampleAudio[i] = level * (float)sin(2 * M_PI * 15500.0 *
+		    (double)(i % DEMOD_RATE) / DEMOD_RATE);
+	}
+
+	DCF77PM_RenderBaseband(0, DEMOD_RATE, samplePhase);
+	for (i = DEMOD_RATE; i < sizeof(samplePhase) / sizeof(samplePhase[0]);
+	    ++i) {
+		samplePhase[i] = samplePhase[i - DEMOD_RATE];
+	}
+}
+
+static double
+nowNs(void)
+{
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double
+timeRun(const Benchmark_t * pBench, size_t iters)
+{
+	double start = nowNs();
+
+	pBench->run(iters);
+
+	return nowNs() - start;
+}
+
+static int
+compareDoubles(const void * a, const void * b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void
+runBenchmark(const Benchmark_t * pBench, int repeats, double minRunNs)
+{
+	double nsPerOp[REPEATS_MAX];
+	double sum = 0.0, sumSq = 0.0, mean, stddev;
+	size_t iters = 1;
+	int i;
+
+	/* warm up caches and calibrate */
+	(void)timeRun(pBench, 1);
+	while (timeRun(pBench, iters) < minRunNs) {
+		iters *= 2;
+	}
+
+	for (i = 0; i < repeats; ++i) {
+		nsPerOp[i] = timeRun(pBench, iters) /
+		    ((double)iters * SAMPLE_QTY);
+		sum += nsPerOp[i];
+		sumSq += nsPerOp[i] * nsPerOp[i];
+	}
+	mean = sum / repeats;
+	stddev = sqrt(fmax(0.0, sumSq / repeats - mean * mean));
+	qsort(nsPerOp, (size_t)repeats, sizeof(nsPerOp[0]), compareDoubles);
+
+	printf("{\"bench\":\"%s\",\"ops\":%zu,\"repeats\":%d,"
+	    "\"ns_per_op_min\":%.3f,\"ns_per_op_median\":%.3f,"
+	    "\"ns_per_op_mean\":%.3f,\"ns_per_op_max\":%.3f,"
+	    "\"ns_per_op_stddev\":%.3f,\"blocks_per_s\":%.0f}\n",
+	    pBench->name, iters * SAMPLE_QTY, repeats,
+	    nsPerOp[0], nsPerOp[repeats / 2], mean, nsPerOp[repeats - 1],
+	    stddev, 1e9 / nsPerOp[repeats / 2]);
+	fflush(stdout);
+}
+
+static void
+printUsage(void)
+{
+	fprintf(stderr,
+	    "usage: bench [-r <repeats>] [-m <min_ms_per_repeat>] [<name>...]\n"
+	    "  Runs the benchmarks whose names start with any of <name>\n"
+	    "  (all by default), prints a JSON object per benchmark.\n");
+	exit(EX_USAGE);
+}
+
+static int
+isSelected(const char * name, int argc, char * argv[])
+{
+	int i;
+
+	if (0 == argc)
+		return 1;
+
+	for (i = 0; i < argc; ++i) {
+		if (0 == strncmp(name, argv[i], strlen(argv[i])))
+			return 1;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char * argv[])
+{
+	int repeats = 10;
+	double minRunMs = 20.0;
+	size_t i;
+	int ch;
+
+	while ((ch = getopt(argc, argv, "m:r:")) != -1) {
+		switch (ch) {
+		case 'm':
+			minRunMs = strtod(optarg, NULL);
+			break;
+		case 'r':
+			repeats = (int)strtol(optarg, NULL, 10);
+			break;
+		default:
+			printUsage();
+			/* NOTREACHED */
+		}
+	}
+	argc -= optind;
+	argv += optind;
+
+	if (repeats < 1 || repeats > REPEATS_MAX) {
+		errx(EX_USAGE, "repeats must be within 1-%d", REPEATS_MAX);
+		/* NOTREACHED */
+	}
+
+	prepareSamples();
+
+	for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i) {
+		if (isSelected(benchmarks[i].name, argc, argv)) {
+			runBenchmark(&benchmarks[i], repeats, minRunMs * 1e6);
+		}
+	}
+
+	return 0;
+}
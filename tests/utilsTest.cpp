@@ -129,3 +129,27 @@ TEST(AStructTMNormalizer, DeassertsDSTForWinterTime) {
 
 	CHECK_DST( DST_DEASSERTED );
 }
+
+TEST_GROUP(ACivilDaysCounter)
+{
+};
+
+TEST(ACivilDaysCounter, StartsAtUnixEpoch) {
+	LONGS_EQUAL(0, daysFromCivil(1970, 1, 1));
+	LONGS_EQUAL(10957, daysFromCivil(2000, 1, 1));
+	LONGS_EQUAL(11016, daysFromCivil(2000, 2, 29));
+}
+
+TEST(ACivilDaysCounter, ConvertsBackAndForth) {
+	int y, m, d;
+
+	for (long days = 10957; days < 10957 + 36525; ++days) {
+		civilFromDays(days, &y, &m, &d);
+		LONGS_EQUAL(days, daysFromCivil(y, m, d));
+	}
+
+	civilFromDays(11016, &y, &m, &d);
+	LONGS_EQUAL(2000, y);
+	LONGS_EQUAL(2, m);
+	LONGS_EQUAL(29, d);
+}